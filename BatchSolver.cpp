@@ -0,0 +1,256 @@
+#include "BatchSolver.h"
+#include "ParallelSearch.h"
+#include "Multiversion.h"
+
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <array>
+
+/**
+ * @brief Search a board, within a budget if there is one.
+ * @tparam Listener Listener policy (see NullSolveListener).
+ * @param board Board to solve.
+ * @param assigned Assignment flags of the search.
+ * @param listener Receives the search events.
+ * @param budget Limits of the search, or nullptr for none.
+ * @return Outcome of the search.
+ */
+template <class Listener>
+static SolveStatus searchWith(SudokuBoard& board, bool assigned[81], Listener& listener, const SolveBudget* budget) {
+    if (budget != nullptr)
+        return board.solveWithin(*budget, assigned, listener);
+    return board.dfsSolve(assigned, listener) ? SOLVE_SOLVED : SOLVE_NO_SOLUTION;
+}
+
+/**
+ * @brief Batch search with statistics only, multiversioned (see SUDOKU_MULTIVERSIONED).
+ * @param board Board to solve.
+ * @param assigned Assignment flags of the search.
+ * @param listener Counts the assignments and simplifications.
+ * @param budget Limits of the search, or nullptr for none.
+ * @return Outcome of the search.
+ */
+SUDOKU_MULTIVERSIONED static SolveStatus search(SudokuBoard& board, bool assigned[81], StatsListener& listener, const SolveBudget* budget) {
+    return searchWith(board, assigned, listener, budget);
+}
+
+/**
+ * @brief Batch search with search counters, multiversioned like the one with statistics only.
+ * @param board Board to solve.
+ * @param assigned Assignment flags of the search.
+ * @param listener Counts the search events.
+ * @param budget Limits of the search, or nullptr for none.
+ * @return Outcome of the search.
+ */
+SUDOKU_MULTIVERSIONED static SolveStatus search(SudokuBoard& board, bool assigned[81], CounterListener& listener, const SolveBudget* budget) {
+    return searchWith(board, assigned, listener, budget);
+}
+
+/**
+ * @brief Search a puzzle with ExactCoverSolver, within a budget if there is one.
+ * @param board Board of the puzzle; receives the solution.
+ * @param data Candidate bits of the puzzle.
+ * @param stats Receives the assignments.
+ * @param budget Limits of the search, or nullptr for none.
+ * @return Outcome of the search.
+ */
+static SolveStatus searchExactCover(SudokuBoard& board, const std::array<ulli, 12>& data, SolveStats& stats, const SolveBudget* budget) {
+    ExactCoverSolver cover(data);
+    SolveStatus status;
+    if (budget != nullptr)
+        status = cover.solveWithin(*budget, stats);
+    else
+        status = cover.dfsSolve(stats) ? SOLVE_SOLVED : SOLVE_NO_SOLUTION;
+    if (status == SOLVE_SOLVED)
+        board = SudokuBoard(cover.copyData());
+    return status;
+}
+
+BatchSolver::BatchSolver(WorkStealingPool& pool, ui splitDepth, RuleTier rules, BranchStrategy branching)
+    : pool(pool), splitDepth(splitDepth), rules(rules), branching(branching), cache(nullptr), lanes(true), budget(), table(nullptr),
+      engine(ENGINE_BITSET) {}
+
+void BatchSolver::setCache(SolutionCache* cache) {
+    this->cache = cache;
+}
+
+void BatchSolver::setLanes(bool enable) {
+    lanes = enable;
+}
+
+void BatchSolver::setBudget(ulli maxNodes, ulli maxMicros) {
+    budget = { maxNodes, maxMicros, nullptr };
+}
+
+void BatchSolver::setTranspositionTable(TranspositionTable* table) {
+    this->table = table;
+}
+
+void BatchSolver::setEngine(SolverEngine engine) {
+    this->engine = engine;
+    portfolios.clear();
+    if (engine == ENGINE_PORTFOLIO) {
+        for (ui i = 0; i < pool.getThreadCount(); i++)
+            portfolios.push_back(std::make_unique<PortfolioSolver>());
+    }
+}
+
+void BatchSolver::enableCounters(bool enable) {
+    counters.assign(enable ? pool.getThreadCount() : 0, SolveCounters());
+}
+
+SolveCounters BatchSolver::getCounters() const {
+    SolveCounters total = SolveCounters();
+    for (const SolveCounters& c : counters)
+        mergeSolveCounters(total, c);
+    return total;
+}
+
+SolveStatus BatchSolver::solveOne(const std::array<ulli, 12>& data, char* out, SolveStats& stats,
+                                  RuleTier rules, BranchStrategy branching, SolutionCache* cache, SolveCounters* counters,
+                                  const SolveBudget* budget, TranspositionTable* table, SolverEngine engine, PortfolioSolver* portfolio) {
+    SudokuBoard board(data);
+    board.setRuleTier(rules);
+    board.setBranchStrategy(branching);
+    board.setTranspositionTable(table);
+    bool assigned[81] = {};
+    StatsListener listener(stats);
+
+    auto start = std::chrono::steady_clock::now();
+    SolveStatus status;
+    char canonical[81], solution[81];
+    GridTransform transform;
+    bool hit = false;
+    if (cache != nullptr) {
+        // Nothing is propagated yet, so the board still holds just the givens
+        board.writeValues(solution);
+        transform = GridTransform::canonicalize(solution, canonical);
+        hit = cache->lookup(canonical, solution);
+    }
+    if (hit) {
+        stats.cacheHits++;
+        status = solution[0] != '.' ? SOLVE_SOLVED : SOLVE_NO_SOLUTION;
+        if (status == SOLVE_SOLVED)
+            transform.invert(solution, out);
+    } else {
+        if (engine != ENGINE_BITSET) {
+            ulli begin = counters != nullptr ? readTicks() : 0;
+            status = engine == ENGINE_PORTFOLIO ? portfolio->race(board, data, stats, budget) : searchExactCover(board, data, stats, budget);
+            if (counters != nullptr) {
+                counters->searchTicks += readTicks() - begin;
+                counters->puzzles++;
+            }
+        } else if (counters != nullptr) {
+            CounterListener counting(stats, *counters);
+            ulli begin = readTicks();
+            status = search(board, assigned, counting, budget);
+            counters->searchTicks += readTicks() - begin;
+            counters->puzzles++;
+        } else {
+            status = search(board, assigned, listener, budget);
+        }
+        if (status == SOLVE_SOLVED)
+            board.writeValues(out);
+        // A stopped search says nothing about the puzzle, so it is not cached
+        if (cache != nullptr && status != SOLVE_BUDGET_EXCEEDED && status != SOLVE_CANCELLED) {
+            stats.cacheMisses++;
+            if (status == SOLVE_SOLVED)
+                transform.apply(out, solution);
+            cache->insert(canonical, status == SOLVE_SOLVED ? solution : nullptr);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    ulli micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    stats.micros += micros;
+    if (counters != nullptr)
+        recordLatency(*counters, micros);
+
+    if (status == SOLVE_SOLVED) {
+        stats.solved++;
+    } else if (status == SOLVE_NO_SOLUTION) {
+        std::fill(out, out + 81, '.');
+    } else {
+        std::fill(out, out + 81, '?');
+        stats.overBudget++;
+    }
+    out[81] = '\n';
+    stats.puzzles++;
+    return status;
+}
+
+SolveStats BatchSolver::solve(const std::vector<std::array<ulli, 12>>& puzzles, char* out, SolveStats* records) {
+    if (splitDepth != 0) {
+        // One puzzle at a time, its search tree spread over the whole pool
+        SolveStats total = SolveStats();
+        ParallelSearch search(pool, splitDepth, rules, branching);
+        for (size_t i = 0; i < puzzles.size(); i++) {
+            char* line = out + i * LINE_SIZE;
+            auto start = std::chrono::steady_clock::now();
+            ParallelSearchResult result = search.search(puzzles[i], 1);
+            auto end = std::chrono::steady_clock::now();
+            result.stats.micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            if (result.solutions > 0)
+                SudokuBoard(result.solution).writeValues(line);
+            else
+                std::fill(line, line + 81, '.');
+            line[81] = '\n';
+            if (records != nullptr)
+                records[i] = result.stats;
+            mergeSolveStats(total, result.stats);
+        }
+        return total;
+    }
+
+    std::vector<WorkerStats> perWorker(pool.getThreadCount());
+    for (WorkerStats& w : perWorker)
+        w.stats = SolveStats();
+
+    // Small groups of consecutive puzzles; idle workers steal whole groups
+    for (size_t first = 0; first < puzzles.size(); first += TASK_SIZE) {
+        size_t last = std::min(first + TASK_SIZE, puzzles.size());
+        pool.submit([this, &puzzles, &perWorker, out, records, first, last](ui worker) {
+            SolveStats& stats = perWorker[worker].stats;
+            SolveCounters* counting = counters.empty() ? nullptr : &counters[worker];
+            PortfolioSolver* racing = portfolios.empty() ? nullptr : portfolios[worker].get();
+            const SolveBudget* limits = budget.maxNodes != 0 || budget.maxMicros != 0 ? &budget : nullptr;
+            unsigned solved = 0;
+            ui rounds[LaneSolver::LANES];
+            if (lanes && cache == nullptr && counting == nullptr) {
+                auto start = std::chrono::steady_clock::now();
+                solved = LaneSolver::solveSingles(&puzzles[first], last - first, out + first * LINE_SIZE, LINE_SIZE, rounds);
+                auto end = std::chrono::steady_clock::now();
+                stats.micros += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            }
+            for (size_t i = first; i < last; i++) {
+                if (solved >> (i - first) & 1) {
+                    out[i * LINE_SIZE + 81] = '\n';
+                    stats.simplifications += rounds[i - first];
+                    stats.solved++;
+                    stats.puzzles++;
+                    if (records != nullptr) {
+                        records[i] = SolveStats();
+                        records[i].puzzles = records[i].solved = 1;
+                        records[i].simplifications = rounds[i - first];
+                    }
+                    continue;
+                }
+                if (records == nullptr) {
+                    solveOne(puzzles[i], out + i * LINE_SIZE, stats, rules, branching, cache, counting, limits, table, engine, racing);
+                    continue;
+                }
+                records[i] = SolveStats();
+                solveOne(puzzles[i], out + i * LINE_SIZE, records[i], rules, branching, cache, counting, limits, table, engine, racing);
+                mergeSolveStats(stats, records[i]);
+            }
+        });
+    }
+    pool.wait();
+
+    SolveStats total = SolveStats();
+    for (const WorkerStats& w : perWorker)
+        mergeSolveStats(total, w.stats);
+    return total;
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "SudokuBoardN.h"
+#include "SolveStats.h"
+#include "SolutionCache.h"
+#include "SolveCounters.h"
+#include "LaneSolver.h"
+#include "PortfolioSolver.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <array>
+
+/**
+ * @class BatchSolver
+ * @brief Solves a batch of puzzles in parallel on a WorkStealingPool.
+ *
+ * Every puzzle gets its own SudokuBoard, so no solver state is shared between threads.
+ * Puzzles are handed out in small groups of TASK_SIZE; together with work stealing this
+ * keeps all cores busy even when a few puzzles of the batch are much harder than the rest.
+ * Each worker keeps its own SolveStats, which are merged after the batch.
+ * An optional SolutionCache answers repeated and symmetric puzzles without a search, and
+ * optional per-worker SolveCounters profile the searches. Without either, each group is first
+ * propagated together by LaneSolver, and only the puzzles singles do not solve are searched,
+ * by the bitset search, the exact cover search or a race of both (see SolverEngine).
+ * For a few very hard puzzles, an intra-puzzle split (ParallelSearch) can be used instead.
+ */
+class BatchSolver {
+public:
+    /** Number of puzzles solved by one task: one LaneSolver group. */
+    static const size_t TASK_SIZE = LaneSolver::LANES;
+
+    /** Bytes written per puzzle: 81 cells and a newline. */
+    static const size_t LINE_SIZE = 82;
+
+private:
+    /**
+     * @struct WorkerStats
+     * @brief Per-worker statistics, padded to a cache line to avoid false sharing.
+     */
+    struct alignas(64) WorkerStats {
+        SolveStats stats;  /**< Counters of the puzzles this worker solved */
+    };
+
+    WorkStealingPool& pool;  /**< Pool running the tasks */
+    ui splitDepth;           /**< If non-zero, each puzzle is searched with ParallelSearch */
+    RuleTier rules;          /**< Strongest propagation rules of every board */
+    BranchStrategy branching;  /**< Branching strategy of every board */
+    SolutionCache* cache;      /**< Cache consulted before solving, or nullptr */
+    std::vector<SolveCounters> counters;  /**< Search counters of each worker, empty if disabled */
+    bool lanes;                /**< Whether LaneSolver tries each group first */
+    SolveBudget budget;        /**< Limits of every search; all zero for none */
+    TranspositionTable* table;  /**< Explored states shared by all searches, or nullptr */
+    SolverEngine engine;       /**< Engine searching the puzzles */
+    std::vector<std::unique_ptr<PortfolioSolver>> portfolios;  /**< Race of each worker, empty unless ENGINE_PORTFOLIO */
+
+public:
+    /**
+     * @brief Constructor.
+     * @param pool Pool to run on; must outlive the solver.
+     * @param splitDepth 0 to solve many puzzles side by side (one thread per puzzle);
+     *                   otherwise puzzles are solved one after another, each split across
+     *                   the pool by ParallelSearch down to this many tree levels.
+     * @param rules Strongest propagation rules to solve with.
+     * @param branching Branching strategy to solve with (ParallelSearch splits on MRV cells and searches the subtrees with it).
+     */
+    BatchSolver(WorkStealingPool& pool, ui splitDepth = 0, RuleTier rules = RULES_SINGLES, BranchStrategy branching = BRANCH_MRV);
+
+    /**
+     * @brief Consult a solution cache before solving each puzzle (side-by-side mode only).
+     * @param cache Cache shared by all workers, or nullptr to always solve; must outlive the solver.
+     */
+    void setCache(SolutionCache* cache);
+
+    /**
+     * @brief Try every group with LaneSolver before searching it (on by default; side-by-side
+     *        mode without cache or counters only).
+     *
+     * The output is the same either way; lanes only change the speed and the simplification count.
+     *
+     * @param enable false to search every puzzle on its own.
+     */
+    void setLanes(bool enable);
+
+    /**
+     * @brief Stop the search of any puzzle that takes too long (side-by-side mode only).
+     *
+     * Such a puzzle gets a line of 81 '?' and is counted in SolveStats::overBudget, so the
+     * caller can retry it elsewhere with a larger budget; it is not stored in the cache.
+     *
+     * @param maxNodes Search nodes allowed per puzzle, 0 for no limit.
+     * @param maxMicros Microseconds allowed per puzzle, 0 for no limit.
+     */
+    void setBudget(ulli maxNodes, ulli maxMicros);
+
+    /**
+     * @brief Share explored states between all searches (side-by-side mode only; see
+     *        SudokuBoard::setTranspositionTable()).
+     * @param table Table shared by all workers, or nullptr; must outlive the solver.
+     */
+    void setTranspositionTable(TranspositionTable* table);
+
+    /**
+     * @brief Search with another engine than the bitset search (side-by-side mode only).
+     *
+     * ENGINE_PORTFOLIO starts one helper thread per worker, which races the exact cover search
+     * against each worker's bitset search. Counters and the transposition table only see the
+     * bitset search; with ENGINE_EXACT_COVER they count just puzzles, time and latency.
+     *
+     * @param engine Engine to search with.
+     */
+    void setEngine(SolverEngine engine);
+
+    /**
+     * @brief Count nodes, backtracks, eliminations, time and latency of every search (side-by-side mode only).
+     * @param enable true to count from now on (counters start at zero), false to stop.
+     */
+    void enableCounters(bool enable);
+
+    /**
+     * @brief Search counters of all batches since enableCounters(true).
+     * @return Counters merged over all workers; all zero if counting is disabled.
+     */
+    SolveCounters getCounters() const;
+
+    /**
+     * @brief Solve one puzzle and write its output line.
+     *
+     * With a cache, the puzzle is canonicalized first (see GridTransform::canonicalize()); a
+     * cached solution is mapped back through the inverse transform, and a solved miss is
+     * stored in canonical form. Hits and misses are counted in stats.
+     *
+     * @param data Candidate bits of the puzzle (see SudokuBoard::parseData()).
+     * @param out Receives LINE_SIZE bytes: the 81-character solution, 81 '.' if the
+     *            puzzle has no solution, or 81 '?' if the budget ran out, followed by '\n'.
+     * @param stats Counters updated for this puzzle.
+     * @param rules Strongest propagation rules to solve with.
+     * @param branching Branching strategy to solve with.
+     * @param cache Cache to consult and fill, or nullptr.
+     * @param counters Counters of the calling thread to profile the search with, or nullptr.
+     * @param budget Limits of the search (see SudokuBoard::solveWithin()), or nullptr for none.
+     * @param table Transposition table of the search, or nullptr.
+     * @param engine Engine to search with.
+     * @param portfolio Race of the calling thread; must be set for ENGINE_PORTFOLIO.
+     * @return Outcome of the puzzle; SOLVE_SOLVED if it was solved.
+     */
+    static SolveStatus solveOne(const std::array<ulli, 12>& data, char* out, SolveStats& stats,
+                                RuleTier rules = RULES_SINGLES, BranchStrategy branching = BRANCH_MRV,
+                                SolutionCache* cache = nullptr, SolveCounters* counters = nullptr,
+                                const SolveBudget* budget = nullptr, TranspositionTable* table = nullptr,
+                                SolverEngine engine = ENGINE_BITSET, PortfolioSolver* portfolio = nullptr);
+
+    /**
+     * @brief Solve all puzzles and write their lines in input order.
+     *
+     * Blocks until the whole batch is done.
+     *
+     * @param puzzles Candidate bits of each puzzle.
+     * @param out Buffer of at least puzzles.size() * LINE_SIZE bytes; line i belongs to puzzles[i].
+     * @param records If not nullptr, array of puzzles.size() records; record i receives the
+     *                counters of puzzles[i] alone (see PackedPuzzleFile.h).
+     * @return Statistics of the batch, merged over all workers.
+     */
+    SolveStats solve(const std::vector<std::array<ulli, 12>>& puzzles, char* out, SolveStats* records = nullptr);
+
+    /**
+     * @brief Solve a batch of BOX^2 x BOX^2 puzzles with SudokuBoardN and write their lines in input order.
+     *
+     * Puzzles are handed out like in solve(); rules, branching and split depth do not apply.
+     *
+     * @tparam BOX Chunk side length of the puzzles (4 for 16x16, 5 for 25x25).
+     * @param puzzles Puzzles in text form, SudokuBoardN<BOX>::CELLS characters each.
+     * @param out Buffer of at least puzzles.size() * (CELLS + 1) bytes; line i belongs to
+     *            puzzles[i]: the solution, or CELLS '.' if there is none, followed by '\n'.
+     * @return Statistics of the batch, merged over all workers.
+     */
+    template <ui BOX>
+    SolveStats solveLarge(const std::vector<std::string>& puzzles, char* out);
+};
+
+template <ui BOX>
+SolveStats BatchSolver::solveLarge(const std::vector<std::string>& puzzles, char* out) {
+    constexpr ui CELLS = SudokuBoardN<BOX>::CELLS;
+    std::vector<WorkerStats> perWorker(pool.getThreadCount());
+    for (WorkerStats& w : perWorker)
+        w.stats = SolveStats();
+
+    for (size_t first = 0; first < puzzles.size(); first += TASK_SIZE) {
+        size_t last = std::min(first + TASK_SIZE, puzzles.size());
+        pool.submit([&puzzles, &perWorker, out, first, last](ui worker) {
+            SolveStats& stats = perWorker[worker].stats;
+            for (size_t i = first; i < last; i++) {
+                char* line = out + i * (CELLS + 1);
+                SudokuBoardN<BOX> board(puzzles[i].c_str());
+                auto start = std::chrono::steady_clock::now();
+                bool solved = board.dfsSolve(stats);
+                auto end = std::chrono::steady_clock::now();
+                stats.micros += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+                if (solved) {
+                    board.writeValues(line);
+                    stats.solved++;
+                } else {
+                    std::fill(line, line + CELLS, '.');
+                }
+                line[CELLS] = '\n';
+                stats.puzzles++;
+            }
+        });
+    }
+    pool.wait();
+
+    SolveStats total = SolveStats();
+    for (const WorkerStats& w : perWorker)
+        mergeSolveStats(total, w.stats);
+    return total;
+}
@@ -0,0 +1,439 @@
+#include "SudokuBoard.h"
+#include "SudokuBoardN.h"
+#include "PuzzleReader.h"
+#include "PortfolioSolver.h"
+#include "Multiversion.h"
+#include "SolveStats.h"
+#include "Version.h"
+
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+
+/**
+ * @file
+ * @brief Benchmark harness: solves fixed puzzle corpora and reports throughput, latency and effort.
+ *
+ * Each corpus file is read with PuzzleReader. After one untimed warm-up pass, every puzzle is
+ * solved --repeat times with SudokuBoard::dfsSolve and a StatsListener, and every solve is timed
+ * on its own, so the figures contain neither I/O nor trace output. Per corpus it prints
+ * puzzles/sec, p50/p90/p99/max latency, and assignments and simplifications per puzzle.
+ *
+ * --json writes the results as JSON (one corpus per line). --baseline reads such a file from an
+ * earlier run, e.g. of v1.1.4, and compares against it. A throughput drop of more than
+ * --threshold percent (default 5) is reported as a regression, with exit code 2.
+ * --rules picks the propagation rule tier (see RuleTier), e.g. to measure the search nodes
+ * a tier saves, and --branch the branching strategy (see BranchStrategy). --engine dlx
+ * benchmarks ExactCoverSolver instead, and --engine portfolio races both (see PortfolioSolver).
+ * --box 4 or --box 5 benchmarks 16x16 or 25x25 corpora (one puzzle per line) with SudokuBoardN
+ * instead; rules, branching and engine do not apply there.
+ *
+ * Usage: SudokuBenchmark [--repeat N] [--rules TIER] [--branch STRATEGY] [--engine ENGINE] [--box B] [--json FILE] [--baseline FILE] [--threshold PCT] [corpus...]
+ * Without corpus arguments, example.txt, benchmarks/hardest.txt and benchmarks/17clue.txt are used,
+ * or benchmarks/16x16.txt or benchmarks/25x25.txt with --box.
+ */
+
+/**
+ * @struct CorpusResult
+ * @brief Benchmark figures of one corpus.
+ */
+struct CorpusResult {
+    std::string name;                 /**< Corpus file name without directory and extension */
+    ulli puzzles;                     /**< Puzzles in the corpus */
+    ulli solved;                      /**< Puzzles with a solution */
+    double puzzlesPerSec;             /**< Solves per second over all repetitions */
+    double p50, p90, p99, max;        /**< Latency percentiles of a single solve, in microseconds */
+    double assignmentsPerPuzzle;      /**< Tentative assignments per solve */
+    double simplificationsPerPuzzle;  /**< Propagation rounds per solve */
+};
+
+/**
+ * @brief Get the name of a corpus from its path ("benchmarks/17clue.txt" -> "17clue").
+ * @param path Path of the corpus file.
+ * @return File name without directory and extension.
+ */
+static std::string corpusName(const std::string& path) {
+    size_t begin = path.find_last_of("/\\");
+    begin = begin == std::string::npos ? 0 : begin + 1;
+    size_t end = path.find_last_of('.');
+    if (end == std::string::npos || end < begin)
+        end = path.size();
+    return path.substr(begin, end - begin);
+}
+
+/**
+ * @brief Get a latency percentile by nearest rank.
+ * @param sorted Latencies in ascending order (not empty).
+ * @param percent Percentile (0..100).
+ * @return Latency at that rank.
+ */
+static double percentile(const std::vector<double>& sorted, double percent) {
+    size_t rank = (size_t)(percent / 100.0 * (double)sorted.size() + 0.5);
+    rank = std::clamp(rank, (size_t)1, sorted.size());
+    return sorted[rank - 1];
+}
+
+/**
+ * @brief Solve a board with the bitset search, multiversioned like the library's search
+ *        entry points (see SUDOKU_MULTIVERSIONED).
+ * @param board Board to solve.
+ * @param stats Receives the assignments and simplifications.
+ * @return true if the board was solved.
+ */
+SUDOKU_MULTIVERSIONED static bool solveBitset(SudokuBoard& board, SolveStats& stats) {
+    bool assigned[81] = {};
+    StatsListener listener(stats);
+    return board.dfsSolve(assigned, listener);
+}
+
+/**
+ * @brief Solve one puzzle with the chosen engine.
+ * @param puzzle Candidate bits of the puzzle.
+ * @param rules Propagation rule tier of the board.
+ * @param branching Branching strategy of the board.
+ * @param engine Search engine.
+ * @param portfolio Race of both engines, used for ENGINE_PORTFOLIO.
+ * @param stats Receives the assignments and simplifications.
+ * @return true if the puzzle was solved.
+ */
+static bool solvePuzzle(const std::array<ulli, 12>& puzzle, RuleTier rules, BranchStrategy branching, SolverEngine engine,
+                        PortfolioSolver* portfolio, SolveStats& stats) {
+    if (engine == ENGINE_EXACT_COVER) {
+        ExactCoverSolver cover(puzzle);
+        return cover.dfsSolve(stats);
+    }
+    SudokuBoard board(puzzle);
+    board.setRuleTier(rules);
+    board.setBranchStrategy(branching);
+    if (engine == ENGINE_PORTFOLIO)
+        return portfolio->race(board, puzzle, stats, nullptr) == SOLVE_SOLVED;
+    return solveBitset(board, stats);
+}
+
+/**
+ * @brief Solve every puzzle of a corpus repeat times and measure it.
+ * @param name Corpus name.
+ * @param puzzles Puzzles of the corpus.
+ * @param repeat Number of timed passes over the corpus.
+ * @param rules Propagation rule tier of the boards.
+ * @param branching Branching strategy of the boards.
+ * @param engine Search engine.
+ * @return Figures of the corpus.
+ */
+static CorpusResult benchmarkCorpus(const std::string& name, const std::vector<std::array<ulli, 12>>& puzzles, ui repeat,
+                                    RuleTier rules, BranchStrategy branching, SolverEngine engine) {
+    CorpusResult result = CorpusResult();
+    result.name = name;
+    result.puzzles = puzzles.size();
+    std::unique_ptr<PortfolioSolver> portfolio;
+    if (engine == ENGINE_PORTFOLIO)
+        portfolio = std::make_unique<PortfolioSolver>();
+
+    // Warm-up pass: caches, branch predictors and the CPU clock settle
+    SolveStats stats = SolveStats();
+    for (const auto& p : puzzles)
+        result.solved += solvePuzzle(p, rules, branching, engine, portfolio.get(), stats);
+
+    std::vector<double> latencies;
+    latencies.reserve(puzzles.size() * repeat);
+    stats = SolveStats();
+    double totalMicros = 0;
+    for (ui r = 0; r < repeat; r++) {
+        for (const auto& p : puzzles) {
+            auto start = std::chrono::steady_clock::now();
+            solvePuzzle(p, rules, branching, engine, portfolio.get(), stats);
+            auto end = std::chrono::steady_clock::now();
+            double micros = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000.0;
+            latencies.push_back(micros);
+            totalMicros += micros;
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double runs = (double)latencies.size();
+    result.puzzlesPerSec = totalMicros > 0 ? runs / (totalMicros / 1'000'000.0) : 0;
+    result.p50 = percentile(latencies, 50);
+    result.p90 = percentile(latencies, 90);
+    result.p99 = percentile(latencies, 99);
+    result.max = latencies.back();
+    result.assignmentsPerPuzzle = stats.assignments / runs;
+    result.simplificationsPerPuzzle = stats.simplifications / runs;
+    return result;
+}
+
+/**
+ * @brief Solve every puzzle of a BOX^2 x BOX^2 corpus repeat times with SudokuBoardN and measure it.
+ * @tparam BOX Chunk side length of the puzzles.
+ * @param name Corpus name.
+ * @param puzzles Puzzles in text form, SudokuBoardN<BOX>::CELLS characters each.
+ * @param repeat Number of timed passes over the corpus.
+ * @return Figures of the corpus.
+ */
+template <ui BOX>
+static CorpusResult benchmarkCorpusLarge(const std::string& name, const std::vector<std::string>& puzzles, ui repeat) {
+    CorpusResult result = CorpusResult();
+    result.name = name;
+    result.puzzles = puzzles.size();
+
+    SolveStats stats = SolveStats();
+    for (const std::string& p : puzzles) {
+        SudokuBoardN<BOX> board(p.c_str());
+        result.solved += board.dfsSolve(stats);
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(puzzles.size() * repeat);
+    stats = SolveStats();
+    double totalMicros = 0;
+    for (ui r = 0; r < repeat; r++) {
+        for (const std::string& p : puzzles) {
+            auto start = std::chrono::steady_clock::now();
+            SudokuBoardN<BOX> board(p.c_str());
+            board.dfsSolve(stats);
+            auto end = std::chrono::steady_clock::now();
+            double micros = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000.0;
+            latencies.push_back(micros);
+            totalMicros += micros;
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double runs = (double)latencies.size();
+    result.puzzlesPerSec = totalMicros > 0 ? runs / (totalMicros / 1'000'000.0) : 0;
+    result.p50 = percentile(latencies, 50);
+    result.p90 = percentile(latencies, 90);
+    result.p99 = percentile(latencies, 99);
+    result.max = latencies.back();
+    result.assignmentsPerPuzzle = stats.assignments / runs;
+    result.simplificationsPerPuzzle = stats.simplifications / runs;
+    return result;
+}
+
+/**
+ * @brief Write the results as JSON, one corpus object per line.
+ * @param path Output file.
+ * @param results Figures of every corpus.
+ * @param repeat Number of timed passes used.
+ * @param rules Propagation rule tier used.
+ * @param branching Branching strategy used.
+ * @param engine Search engine used.
+ * @param box Chunk side length of the corpora.
+ * @return true on success.
+ */
+static bool writeJson(const char* path, const std::vector<CorpusResult>& results, ui repeat, RuleTier rules, BranchStrategy branching, SolverEngine engine, ui box) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out.precision(10);
+    out << "{\n  \"version\": \"" << PROGRAM_VERSION << "\",\n  \"repeat\": " << repeat
+        << ",\n  \"rules\": \"" << ruleTierName(rules)
+        << "\",\n  \"branch\": \"" << branchStrategyName(branching)
+        << "\",\n  \"engine\": \"" << solverEngineName(engine) << "\",\n  \"box\": " << box << ",\n  \"corpora\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const CorpusResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"puzzles\": " << r.puzzles << ", \"solved\": " << r.solved
+            << ", \"puzzles_per_sec\": " << r.puzzlesPerSec
+            << ", \"p50_us\": " << r.p50 << ", \"p90_us\": " << r.p90 << ", \"p99_us\": " << r.p99 << ", \"max_us\": " << r.max
+            << ", \"assignments_per_puzzle\": " << r.assignmentsPerPuzzle
+            << ", \"simplifications_per_puzzle\": " << r.simplificationsPerPuzzle << '}'
+            << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+/**
+ * @brief Print the figures of one corpus as one line.
+ * @param r Figures of the corpus.
+ */
+static void printResult(const CorpusResult& r) {
+    std::cout << "  " << r.name << ": " << r.solved << '/' << r.puzzles << " solved, "
+        << r.puzzlesPerSec << " puzzles/s, p50 " << r.p50 << " us, p90 " << r.p90 << " us, p99 " << r.p99
+        << " us, max " << r.max << " us, " << r.assignmentsPerPuzzle << " assignments/puzzle, "
+        << r.simplificationsPerPuzzle << " simplifications/puzzle" << std::endl;
+}
+
+/**
+ * @brief Read a numeric field of a corpus line written by writeJson().
+ * @param line One line of the JSON file.
+ * @param key Field name.
+ * @param value Receives the number.
+ * @return true if the field was found.
+ */
+static bool jsonNumber(const std::string& line, const char* key, double& value) {
+    std::string pattern = std::string("\"") + key + "\": ";
+    size_t at = line.find(pattern);
+    if (at == std::string::npos)
+        return false;
+    value = std::strtod(line.c_str() + at + pattern.size(), nullptr);
+    return true;
+}
+
+/**
+ * @brief Read the results of an earlier run from a file written by writeJson().
+ * @param path Baseline file.
+ * @param results Receives the corpus figures found (name, puzzles/sec and effort only).
+ * @param version Receives the version that produced the file.
+ * @return true if the file could be read.
+ */
+static bool readJson(const char* path, std::vector<CorpusResult>& results, std::string& version) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t at = line.find("\"version\": \"");
+        if (at != std::string::npos) {
+            at += std::strlen("\"version\": \"");
+            version = line.substr(at, line.find('"', at) - at);
+            continue;
+        }
+        at = line.find("\"name\": \"");
+        if (at == std::string::npos)
+            continue;
+        at += std::strlen("\"name\": \"");
+        CorpusResult r = CorpusResult();
+        r.name = line.substr(at, line.find('"', at) - at);
+        jsonNumber(line, "puzzles_per_sec", r.puzzlesPerSec);
+        jsonNumber(line, "assignments_per_puzzle", r.assignmentsPerPuzzle);
+        jsonNumber(line, "simplifications_per_puzzle", r.simplificationsPerPuzzle);
+        results.push_back(r);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    ui repeat = 200;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double threshold = 5.0;
+    RuleTier rules = RULES_SINGLES;
+    BranchStrategy branching = BRANCH_MRV;
+    SolverEngine engine = ENGINE_BITSET;
+    ui box = 3;
+    std::vector<std::string> corpora;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = (ui)std::strtoul(argv[++i], nullptr, 10);
+            if (repeat == 0) repeat = 1;
+        } else if (std::strcmp(argv[i], "--rules") == 0 && i + 1 < argc && parseRuleTier(argv[i + 1], rules)) {
+            i++;
+        } else if (std::strcmp(argv[i], "--branch") == 0 && i + 1 < argc && parseBranchStrategy(argv[i + 1], branching)) {
+            i++;
+        } else if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc && parseSolverEngine(argv[i + 1], engine)) {
+            i++;
+        } else if (std::strcmp(argv[i], "--box") == 0 && i + 1 < argc) {
+            box = (ui)std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::strtod(argv[++i], nullptr);
+        } else if (argv[i][0] == '-') {
+            std::cerr << "{error} unknown argument: " << argv[i] << std::endl;
+            std::cerr << "usage: SudokuBenchmark [--repeat N] [--rules TIER] [--branch STRATEGY] [--engine ENGINE] [--box B] [--json FILE] [--baseline FILE] [--threshold PCT] [corpus...]" << std::endl;
+            return 1;
+        } else {
+            corpora.push_back(argv[i]);
+        }
+    }
+    if (box < 3 || box > 5) {
+        std::cerr << "{error} --box must be 3, 4 or 5" << std::endl;
+        return 1;
+    }
+    if (corpora.empty() && box == 3)
+        corpora = { "example.txt", "benchmarks/hardest.txt", "benchmarks/17clue.txt" };
+    else if (corpora.empty())
+        corpora = { box == 4 ? "benchmarks/16x16.txt" : "benchmarks/25x25.txt" };
+
+    std::cout << PROGRAM_VERSION << " benchmark, " << repeat << " repetitions, rules " << ruleTierName(rules)
+              << ", branch " << branchStrategyName(branching) << ", engine " << solverEngineName(engine) << std::endl;
+    std::vector<CorpusResult> results;
+    for (const std::string& path : corpora) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "{error} cannot open corpus: " << path << std::endl;
+            return 1;
+        }
+        if (box != 3) {
+            // One puzzle per line: the first CELLS characters of every line that long
+            ui cells = box * box * box * box;
+            std::vector<std::string> puzzles;
+            std::string line;
+            while (std::getline(file, line)) {
+                if (line.size() >= cells && line[0] != '#')
+                    puzzles.push_back(line.substr(0, cells));
+            }
+            if (puzzles.empty()) {
+                std::cerr << "{error} no puzzles in " << path << std::endl;
+                return 1;
+            }
+            results.push_back(box == 4 ? benchmarkCorpusLarge<4>(corpusName(path), puzzles, repeat)
+                                       : benchmarkCorpusLarge<5>(corpusName(path), puzzles, repeat));
+            printResult(results.back());
+            continue;
+        }
+        std::vector<std::array<ulli, 12>> puzzles;
+        try {
+            PuzzleReader reader(file);
+            std::array<ulli, 12> data;
+            while (reader.next(data))
+                puzzles.push_back(data);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "{error} input-format-error: " << e.what() << " (" << path << ")" << std::endl;
+            return 1;
+        }
+        if (puzzles.empty()) {
+            std::cerr << "{error} no puzzles in " << path << std::endl;
+            return 1;
+        }
+
+        results.push_back(benchmarkCorpus(corpusName(path), puzzles, repeat, rules, branching, engine));
+        printResult(results.back());
+    }
+
+    if (jsonPath != nullptr && !writeJson(jsonPath, results, repeat, rules, branching, engine, box)) {
+        std::cerr << "{error} cannot write " << jsonPath << std::endl;
+        return 1;
+    }
+
+    if (baselinePath == nullptr)
+        return 0;
+    std::vector<CorpusResult> baseline;
+    std::string baselineVersion;
+    if (!readJson(baselinePath, baseline, baselineVersion)) {
+        std::cerr << "{error} cannot read baseline " << baselinePath << std::endl;
+        return 1;
+    }
+    std::cout << "Compared with " << baselineVersion << " (" << baselinePath << "):" << std::endl;
+    bool regressed = false;
+    for (const CorpusResult& r : results) {
+        auto old = std::find_if(baseline.begin(), baseline.end(), [&r](const CorpusResult& b) { return b.name == r.name; });
+        if (old == baseline.end() || old->puzzlesPerSec <= 0) {
+            std::cout << "  " << r.name << ": not in baseline" << std::endl;
+            continue;
+        }
+        double change = (r.puzzlesPerSec / old->puzzlesPerSec - 1.0) * 100.0;
+        bool slower = change < -threshold;
+        regressed |= slower;
+        std::cout << "  " << r.name << ": " << old->puzzlesPerSec << " -> " << r.puzzlesPerSec << " puzzles/s ("
+            << (change >= 0 ? "+" : "") << change << "%)" << (slower ? " REGRESSION" : "");
+        // The counts are deterministic, so any difference beyond rounding means the search changed
+        bool sameEffort = std::abs(old->assignmentsPerPuzzle - r.assignmentsPerPuzzle) <= 1e-6 * (1 + r.assignmentsPerPuzzle)
+            && std::abs(old->simplificationsPerPuzzle - r.simplificationsPerPuzzle) <= 1e-6 * (1 + r.simplificationsPerPuzzle);
+        if (!sameEffort)
+            std::cout << ", search effort changed: " << old->assignmentsPerPuzzle << " -> " << r.assignmentsPerPuzzle
+                << " assignments/puzzle";
+        std::cout << std::endl;
+    }
+    return regressed ? 2 : 0;
+}
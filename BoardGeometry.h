@@ -0,0 +1,84 @@
+#pragma once
+
+#include <type_traits>
+#include <array>
+
+/**
+ * @file
+ * @brief Compile-time geometry tables (houses, peers) shared by the boards and the kernels.
+ *
+ * Cells are numbered row-major. Houses are numbered rows first, then columns, then chunks
+ * (chunks row-major, and the cells of a chunk row-major too), so for 9x9 the houses are
+ * 0..8 rows, 9..17 columns and 18..26 chunks. The peers of a cell are listed row first, then
+ * column, then the rest of the chunk, each in ascending cell order, so a loop over them
+ * visits the houses in the same order as the eliminations are reported.
+ *
+ * Every table is computed by a constexpr function and stored in boardGeometry<BOX>, so
+ * lookups are constant loads. Plain C types are used so this header depends on nothing else.
+ */
+
+/**
+ * @struct BoardGeometry
+ * @brief Compile-time sizes and lookup tables of a board with BOX x BOX chunks.
+ * @tparam BOX Chunk side length (3 for classic Sudoku).
+ */
+template <unsigned BOX>
+struct BoardGeometry {
+    static constexpr unsigned SIZE = BOX * BOX;                /**< Values, and cells per house */
+    static constexpr unsigned CELLS = SIZE * SIZE;             /**< Cells of the board */
+    static constexpr unsigned HOUSES = 3 * SIZE;               /**< Rows, then columns, then chunks */
+    static constexpr unsigned PEERS = 3 * SIZE - 2 * BOX - 1;  /**< Other cells sharing a house with a cell */
+    static constexpr unsigned ROW_PEERS = SIZE - 1;            /**< Peers in the cell's row (listed first) */
+    static constexpr unsigned LINE_PEERS = 2 * (SIZE - 1);     /**< Peers in the cell's row or column (listed first) */
+    static constexpr unsigned CELL_WORDS = (CELLS + 63) / 64;  /**< 64-bit words of a cell bitset */
+
+    /** Candidate mask type: bit v-1 set if v is possible. */
+    typedef std::conditional_t<(SIZE <= 16), unsigned short, unsigned> Mask;
+
+    /** Mask with every value possible. */
+    static constexpr Mask ALL = (Mask)((1ULL << SIZE) - 1);
+
+    std::array<std::array<unsigned short, SIZE>, HOUSES> houseCells;         /**< Row-major cell of the k-th cell of a house */
+    std::array<std::array<unsigned char, 3>, CELLS> cellHouses;              /**< Row, column and chunk house of a cell */
+    std::array<std::array<unsigned short, PEERS>, CELLS> peers;              /**< Peers of a cell: row, column, rest of chunk */
+    std::array<std::array<unsigned long long, CELL_WORDS>, CELLS> peerBits;  /**< Peers of a cell as a bitset (bit i = cell i) */
+
+    /**
+     * @brief Compute all tables.
+     * @return Tables of this geometry; meant for constant initialization only.
+     */
+    static constexpr BoardGeometry build() {
+        BoardGeometry g = {};
+        for (unsigned cell = 0; cell < CELLS; cell++) {
+            unsigned x = cell % SIZE, y = cell / SIZE;
+            unsigned chunk = x / BOX + BOX * (y / BOX);
+            g.cellHouses[cell] = { (unsigned char)y, (unsigned char)(SIZE + x), (unsigned char)(2 * SIZE + chunk) };
+            g.houseCells[y][x] = (unsigned short)cell;
+            g.houseCells[SIZE + x][y] = (unsigned short)cell;
+            g.houseCells[2 * SIZE + chunk][x % BOX + BOX * (y % BOX)] = (unsigned short)cell;
+
+            // O(SIZE) per cell rather than a scan of all cells keeps compile time low
+            unsigned count = 0;
+            for (unsigned k = 0; k < SIZE; k++) {
+                if (k != x)
+                    g.peers[cell][count++] = (unsigned short)(k + SIZE * y);
+            }
+            for (unsigned k = 0; k < SIZE; k++) {
+                if (k != y)
+                    g.peers[cell][count++] = (unsigned short)(x + SIZE * k);
+            }
+            for (unsigned k = 0; k < SIZE; k++) {
+                unsigned cx = x / BOX * BOX + k % BOX, cy = y / BOX * BOX + k / BOX;
+                if (cx != x && cy != y)
+                    g.peers[cell][count++] = (unsigned short)(cx + SIZE * cy);
+            }
+            for (unsigned short peer : g.peers[cell])
+                g.peerBits[cell][peer / 64] |= 1ULL << (peer % 64);
+        }
+        return g;
+    }
+};
+
+/** The tables of each box size, computed once at compile time. */
+template <unsigned BOX>
+inline constexpr BoardGeometry<BOX> boardGeometry = BoardGeometry<BOX>::build();
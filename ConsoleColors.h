@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * @file
+ * @brief ANSI escape sequences of the console output, empty unless colors are compiled in.
+ */
+
+#define IS_ANSI_ESCAPE_COLORED_VERSION 0
+
+#if IS_ANSI_ESCAPE_COLORED_VERSION
+  #define ANSI_ESCAPE_RESET    "\033[0m"
+  #define ANSI_ESCAPE_GRAY     "\033[90m"
+  #define ANSI_ESCAPE_RED      "\033[91m"
+  #define ANSI_ESCAPE_GREEN    "\033[92m"
+  #define ANSI_ESCAPE_YELLOW   "\033[93m"
+  #define ANSI_ESCAPE_MAGENTA  "\033[95m"
+#else
+  #define ANSI_ESCAPE_RESET    ""
+  #define ANSI_ESCAPE_GRAY     ""
+  #define ANSI_ESCAPE_RED      ""
+  #define ANSI_ESCAPE_GREEN    ""
+  #define ANSI_ESCAPE_YELLOW   ""
+  #define ANSI_ESCAPE_MAGENTA  ""
+#endif
@@ -0,0 +1,240 @@
+#include "ExactCoverSolver.h"
+#include "BoardGeometry.h"
+
+#include <chrono>
+#include <array>
+#include <bit>
+
+ExactCoverSolver::ExactCoverSolver(const std::array<ulli, 12>& data) {
+    load(data);
+}
+
+void ExactCoverSolver::load(const std::array<ulli, 12>& data) {
+    // Unpack 9 bits per cell like SudokuBoard(data); a cell's bits may straddle two words
+    for (ui i = 0; i < 81; i++) {
+        ui bit_index = i * 9u;
+        ui bsci = bit_index / 64;
+        ui bsii = bit_index % 64;
+        ulli bits = data[bsci] >> bsii;
+        if (bsii > 64 - 9)
+            bits |= data[bsci + 1] << (64 - bsii);
+        cells[i] = (us)(bits & 0x1FF);
+    }
+    build();
+}
+
+void ExactCoverSolver::build() {
+    // Root and headers form one circular list, every header an empty column
+    for (ui h = 0; h <= COLUMNS; h++) {
+        nodes[h] = { (us)(h == 0 ? COLUMNS : h - 1), (us)(h == COLUMNS ? 0 : h + 1), (us)h, (us)h, (us)h, 0 };
+        sizes[h] = 0;
+    }
+
+    const auto& geometry = boardGeometry<3>;
+    ui next = 1 + COLUMNS;
+    for (ui cell = 0; cell < 81; cell++) {
+        for (us mask = cells[cell]; mask != 0; mask &= mask - 1) {
+            ui value = (ui)std::countr_zero(mask);
+            ui headers[4] = {
+                1 + cell,
+                1 + 81 + 9 * geometry.cellHouses[cell][0] + value,
+                1 + 81 + 9 * geometry.cellHouses[cell][1] + value,
+                1 + 81 + 9 * geometry.cellHouses[cell][2] + value
+            };
+            // Append the row's four nodes at the bottom of their columns, linked in a ring
+            for (ui k = 0; k < 4; k++) {
+                ui node = next + k, header = headers[k];
+                nodes[node] = { (us)(next + (k + 3) % 4), (us)(next + (k + 1) % 4), nodes[header].up, (us)header,
+                                (us)header, (us)(9 * cell + value) };
+                nodes[nodes[header].up].down = (us)node;
+                nodes[header].up = (us)node;
+                sizes[header]++;
+            }
+            next += 4;
+        }
+    }
+}
+
+void ExactCoverSolver::cover(ui column) {
+    nodes[nodes[column].left].right = nodes[column].right;
+    nodes[nodes[column].right].left = nodes[column].left;
+    for (ui i = nodes[column].down; i != column; i = nodes[i].down) {
+        for (ui j = nodes[i].right; j != i; j = nodes[j].right) {
+            nodes[nodes[j].up].down = nodes[j].down;
+            nodes[nodes[j].down].up = nodes[j].up;
+            sizes[nodes[j].column]--;
+        }
+    }
+}
+
+void ExactCoverSolver::uncover(ui column) {
+    for (ui i = nodes[column].up; i != column; i = nodes[i].up) {
+        for (ui j = nodes[i].left; j != i; j = nodes[j].left) {
+            sizes[nodes[j].column]++;
+            nodes[nodes[j].up].down = (us)j;
+            nodes[nodes[j].down].up = (us)j;
+        }
+    }
+    nodes[nodes[column].left].right = (us)column;
+    nodes[nodes[column].right].left = (us)column;
+}
+
+void ExactCoverSolver::coverRow(ui row) {
+    for (ui j = nodes[row].right; j != row; j = nodes[j].right)
+        cover(nodes[j].column);
+}
+
+void ExactCoverSolver::uncoverRow(ui row) {
+    for (ui j = nodes[row].left; j != row; j = nodes[j].left)
+        uncover(nodes[j].column);
+}
+
+ui ExactCoverSolver::chooseColumn() const {
+    ui best = 0, bestSize = ~0u;
+    for (ui c = nodes[0].right; c != 0; c = nodes[c].right) {
+        if (sizes[c] < bestSize) {
+            best = c;
+            bestSize = sizes[c];
+            // Nothing beats a forced or a dead column
+            if (bestSize <= 1)
+                break;
+        }
+    }
+    return best;
+}
+
+SolveStatus ExactCoverSolver::search(ulli limit, const SolveBudget* budget, SolveStats& stats, ulli& found) {
+    found = 0;
+    SolveStatus stop = SOLVE_NO_SOLUTION;
+    ulli nodeLimit = budget != nullptr && budget->maxNodes != 0 ? budget->maxNodes : ~0ULL;
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (budget != nullptr && budget->maxMicros != 0)
+        deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget->maxMicros);
+
+    // stack[0..depth) are the chosen rows; descending enters a new node, otherwise the row
+    // at stack[depth - 1] failed and its column's next row is tried
+    ui depth = 0;
+    ulli nodeCount = 0;
+    bool descending = true;
+    while (true) {
+        ui row;
+        if (descending) {
+            ui column = chooseColumn();
+            if (column == 0) {
+                // Every constraint is covered: the 81 chosen rows are a solution
+                if (found++ == 0) {
+                    for (ui d = 0; d < depth; d++) {
+                        ui r = nodes[stack[d]].row;
+                        solution[r / 9] = (us)(1u << (r % 9));
+                    }
+                }
+                if (found >= limit)
+                    break;
+                descending = false;
+                continue;
+            }
+            if (sizes[column] == 0) {
+                descending = false;
+                continue;
+            }
+            // Forced columns are propagation; only a real choice is a search node
+            if (sizes[column] > 1) {
+                if (++nodeCount > nodeLimit) {
+                    stop = SOLVE_BUDGET_EXCEEDED;
+                } else if (budget != nullptr && (nodeCount & (BUDGET_CHECK_INTERVAL - 1)) == 0) {
+                    if (budget->cancel != nullptr && budget->cancel->load(std::memory_order_relaxed))
+                        stop = SOLVE_CANCELLED;
+                    else if (budget->maxMicros != 0 && std::chrono::steady_clock::now() >= deadline)
+                        stop = SOLVE_BUDGET_EXCEEDED;
+                }
+                if (stop != SOLVE_NO_SOLUTION)
+                    break;
+            }
+            cover(column);
+            row = nodes[column].down;
+        } else {
+            if (depth == 0)
+                break;
+            depth--;
+            uncoverRow(stack[depth]);
+            row = nodes[stack[depth]].down;
+        }
+
+        ui column = nodes[row].column;
+        if (row == column) {
+            // Every row of the column failed
+            uncover(column);
+            descending = false;
+            continue;
+        }
+        if (sizes[column] > 1)
+            stats.assignments++;
+        stack[depth++] = (us)row;
+        coverRow(row);
+        descending = true;
+    }
+
+    // Unwind what a solution or a stop left covered, so the matrix is whole again
+    while (depth > 0) {
+        depth--;
+        uncoverRow(stack[depth]);
+        uncover(nodes[stack[depth]].column);
+    }
+    if (stop != SOLVE_NO_SOLUTION)
+        return stop;
+    return found > 0 ? SOLVE_SOLVED : SOLVE_NO_SOLUTION;
+}
+
+bool ExactCoverSolver::dfsSolve(SolveStats& stats) {
+    ulli found;
+    if (search(1, nullptr, stats, found) != SOLVE_SOLVED)
+        return false;
+    cells = solution;
+    return true;
+}
+
+SolveStatus ExactCoverSolver::solveWithin(const SolveBudget& budget, SolveStats& stats) {
+    ulli found;
+    SolveStatus status = search(1, &budget, stats, found);
+    if (status == SOLVE_SOLVED)
+        cells = solution;
+    return status;
+}
+
+SolutionCount ExactCoverSolver::countSolutions(ulli limit, SolveStats& stats) {
+    SolutionCount result = SolutionCount();
+    search(limit == 0 ? 1 : limit, nullptr, stats, result.solutions);
+    if (result.solutions > 0) {
+        std::array<us, 81> puzzle = cells;
+        cells = solution;
+        result.firstSolution = copyData();
+        cells = puzzle;
+    }
+    return result;
+}
+
+SolutionCount ExactCoverSolver::countSolutions(ulli limit) {
+    SolveStats stats = SolveStats();
+    return countSolutions(limit, stats);
+}
+
+std::array<ulli, 12> ExactCoverSolver::copyData() const {
+    // Same packing as SudokuBoard::copyData()
+    std::array<ulli, 12> data = {};
+    for (ui i = 0; i < 81; i++) {
+        ui bit_index = i * 9u;
+        ui bsci = bit_index / 64;
+        ui bsii = bit_index % 64;
+        data[bsci] |= (ulli)cells[i] << bsii;
+        if (bsii > 64 - 9)
+            data[bsci + 1] |= (ulli)cells[i] >> (64 - bsii);
+    }
+    return data;
+}
+
+void ExactCoverSolver::writeValues(char* out) const {
+    for (ui i = 0; i < 81; i++) {
+        us mask = cells[i];
+        out[i] = std::popcount(mask) == 1 ? char('1' + std::countr_zero(mask)) : '.';
+    }
+}
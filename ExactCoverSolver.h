@@ -0,0 +1,175 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "SolveStats.h"
+
+#include <array>
+
+/**
+ * @class ExactCoverSolver
+ * @brief Alternative search engine: the puzzle as an exact cover problem, solved by Algorithm X
+ *        with dancing links.
+ *
+ * The 324 columns are the constraints "cell c holds a value" (0..80) and "house h holds value
+ * v" (81 + 9 * h + v, houses numbered as in BoardGeometry.h). Every candidate of every cell is a
+ * row covering four columns: its cell, and the value in its row, column and chunk. A solution
+ * is a set of 81 rows covering every column exactly once. The search always branches on the
+ * column with the fewest rows left, so a given or a single is taken without branching, and a
+ * column with no rows left is a contradiction.
+ *
+ * The matrix is array-based: every node holds the 16-bit indices of its four neighbours, its
+ * column header and its row in one fixed array of about 40 KB, so covering and uncovering
+ * walk contiguous memory and nothing is allocated. The search runs on an explicit stack of
+ * the chosen rows, like dfsSolve(), and unlinks and relinks nodes in place instead of
+ * copying state.
+ *
+ * The solve and count calls follow SudokuBoard: dfsSolve(), solveWithin() and countSolutions()
+ * take the same budgets and fill the same SolveStats. Assignments count the rows tried in
+ * columns with more than one row, the analogue of dfsSolve's tentative assignments; this
+ * engine makes no simplification passes. A solve leaves the solution in the cell masks
+ * (see writeValues() and copyData()); a failed or stopped solve leaves the puzzle as it was.
+ */
+class ExactCoverSolver {
+public:
+    /** Constraint columns: 81 cells plus 27 houses times 9 values. */
+    static const ui COLUMNS = 81 + 27 * 9;
+
+    /** Candidate rows of a puzzle with no givens. */
+    static const ui ROWS = 81 * 9;
+
+private:
+    /** Nodes of the matrix: the root, one header per column, four nodes per row. */
+    static const ui NODES = 1 + COLUMNS + 4 * ROWS;
+
+    /**
+     * @struct Node
+     * @brief One matrix node; node 0 is the root and nodes 1..COLUMNS the column headers.
+     */
+    struct Node {
+        us left, right;  /**< Neighbours in the node's row (headers: in the header list) */
+        us up, down;     /**< Neighbours in the node's column */
+        us column;       /**< Header of the node's column (headers: the header itself) */
+        us row;          /**< 9 * cell + value - 1 of the node's candidate row */
+    };
+
+    std::array<Node, NODES> nodes;        /**< The matrix, linked in place */
+    std::array<us, 1 + COLUMNS> sizes;    /**< Rows left in each column, by header node */
+    std::array<us, 81> cells;             /**< Candidate masks of the puzzle, or of its solution */
+    std::array<us, 81> solution;          /**< Masks of the first solution found by the last search */
+    std::array<us, 81> stack;             /**< Row node tried at each search depth */
+
+    /**
+     * @brief Build the matrix of the current cell masks.
+     */
+    void build();
+
+    /**
+     * @brief Remove a column from the header list and its rows from the other columns.
+     * @param column Header node of the column.
+     */
+    void cover(ui column);
+
+    /**
+     * @brief Undo cover(column); columns must be uncovered in reverse order.
+     * @param column Header node of the column.
+     */
+    void uncover(ui column);
+
+    /**
+     * @brief Cover the other columns of a row when the row is chosen.
+     * @param row Node of the row in the column that was branched on.
+     */
+    void coverRow(ui row);
+
+    /**
+     * @brief Undo coverRow(row).
+     * @param row Node passed to coverRow().
+     */
+    void uncoverRow(ui row);
+
+    /**
+     * @brief Find the uncovered column with the fewest rows, the first one on ties.
+     * @return Header node of the column, or 0 if every column is covered.
+     */
+    ui chooseColumn() const;
+
+    /**
+     * @brief Run Algorithm X until limit solutions are found, the tree is exhausted or the budget runs out.
+     *
+     * The matrix is unwound completely before returning, so searches may be repeated.
+     *
+     * @param limit Maximum number of solutions to find (at least 1).
+     * @param budget Node, time and cancellation limits, or nullptr for none.
+     * @param stats Receives the assignments.
+     * @param found Receives the number of solutions found; the first is stored in solution.
+     * @return SOLVE_BUDGET_EXCEEDED or SOLVE_CANCELLED if the search was stopped, otherwise
+     *         SOLVE_SOLVED if a solution was found and SOLVE_NO_SOLUTION if not.
+     */
+    SolveStatus search(ulli limit, const SolveBudget* budget, SolveStats& stats, ulli& found);
+
+public:
+    /**
+     * @brief Build the matrix of a puzzle.
+     * @param data Candidate bits of the puzzle (see SudokuBoard::parseData()); cells with
+     *             several candidates get one row per candidate.
+     */
+    explicit ExactCoverSolver(const std::array<ulli, 12>& data);
+
+    ExactCoverSolver(const ExactCoverSolver& other) = delete;
+    ExactCoverSolver& operator=(const ExactCoverSolver& other) = delete;
+
+    /**
+     * @brief Replace the puzzle, reusing the matrix storage.
+     * @param data Candidate bits of the new puzzle.
+     */
+    void load(const std::array<ulli, 12>& data);
+
+    /**
+     * @brief Solve the puzzle, like SudokuBoard::dfsSolve().
+     * @param stats Receives the assignments.
+     * @return true if a solution was found; the cell masks then hold it.
+     */
+    bool dfsSolve(SolveStats& stats);
+
+    /**
+     * @brief Solve the puzzle within a budget, like SudokuBoard::solveWithin().
+     *
+     * A node is a choice in a column with more than one row left; forced columns play the
+     * part of propagation. The clock and the token are read every BUDGET_CHECK_INTERVAL nodes.
+     *
+     * @param budget Node, time and cancellation limits.
+     * @param stats Receives the assignments, including those of a stopped search.
+     * @return SOLVE_SOLVED, SOLVE_NO_SOLUTION, SOLVE_BUDGET_EXCEEDED or SOLVE_CANCELLED.
+     */
+    SolveStatus solveWithin(const SolveBudget& budget, SolveStats& stats);
+
+    /**
+     * @brief Count the solutions of the puzzle, like SudokuBoard::countSolutions().
+     *
+     * The cell masks are left as they were.
+     *
+     * @param limit Maximum number of solutions to find (0 is treated as 1).
+     * @param stats Receives the assignments.
+     * @return Number of solutions (at most limit) and the first one found.
+     */
+    SolutionCount countSolutions(ulli limit, SolveStats& stats);
+
+    /**
+     * @brief Count the solutions of the puzzle without statistics.
+     * @param limit Maximum number of solutions to find (0 is treated as 1).
+     * @return Number of solutions (at most limit) and the first one found.
+     */
+    SolutionCount countSolutions(ulli limit);
+
+    /**
+     * @brief Copy the cell masks in the 12-ulli form of SudokuBoard::copyData().
+     * @return Candidate bits of the puzzle, or of its solution after a successful solve.
+     */
+    std::array<ulli, 12> copyData() const;
+
+    /**
+     * @brief Write the cells as 81 characters, like SudokuBoard::writeValues().
+     * @param out Pointer to a buffer of at least 81 characters (no terminator is written).
+     */
+    void writeValues(char* out) const;
+};
@@ -0,0 +1,232 @@
+#include "LaneSolver.h"
+#include "BoardGeometry.h"
+
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LANE_SOLVER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+static const ui LANES = (ui)LaneSolver::LANES;
+
+/** Candidate masks of all lanes, cell by cell: cells[c][l] is cell c of puzzle l. */
+typedef us LaneCells[81][LANES];
+
+//======== Portable ========
+// Every statement is a loop over the lanes, with conditions turned into all-ones or all-zeros
+// masks instead of branches, so compilers vectorize it as is.
+
+/**
+ * @brief Run singles rounds on all lanes until none changes.
+ * @param cells Masks of all lanes; updated in place.
+ * @param bad Receives non-zero for the lanes that hit a contradiction.
+ * @param rounds Receives the rounds that changed each lane.
+ */
+static void propagateLanesScalar(LaneCells& cells, us bad[LANES], ui rounds[LANES]) {
+    const BoardGeometry<3>& g = boardGeometry<3>;
+    alignas(32) us placed[27][LANES], hidden[27][LANES];
+    for (ui round = 1;; round++) {
+        // Placed values and hidden singles of every house, and its contradictions
+        for (ui h = 0; h < 27; h++) {
+            alignas(32) us once[LANES] = {}, twice[LANES] = {}, fixedOnce[LANES] = {}, fixedTwice[LANES] = {};
+            for (ui k = 0; k < 9; k++) {
+                const us* m = cells[g.houseCells[h][k]];
+                for (ui l = 0; l < LANES; l++) {
+                    us single = m[l] & (us)((m[l] & (m[l] - 1)) == 0 ? 0xFFFF : 0);
+                    fixedTwice[l] |= fixedOnce[l] & single;
+                    fixedOnce[l] |= single;
+                    twice[l] |= once[l] & m[l];
+                    once[l] |= m[l];
+                }
+            }
+            for (ui l = 0; l < LANES; l++) {
+                placed[h][l] = fixedOnce[l];
+                hidden[h][l] = once[l] & (us)~twice[l] & (us)~fixedOnce[l];
+                bad[l] |= fixedTwice[l] | (0x1FF & (us)~once[l]);
+            }
+        }
+
+        // Eliminate placed peers from unfixed cells, then assign hidden singles
+        alignas(32) us changed[LANES] = {};
+        for (ui c = 0; c < 81; c++) {
+            const us* row = placed[g.cellHouses[c][0]];
+            const us* col = placed[g.cellHouses[c][1]];
+            const us* box = placed[g.cellHouses[c][2]];
+            const us* hiddenRow = hidden[g.cellHouses[c][0]];
+            const us* hiddenCol = hidden[g.cellHouses[c][1]];
+            const us* hiddenBox = hidden[g.cellHouses[c][2]];
+            us* m = cells[c];
+            for (ui l = 0; l < LANES; l++) {
+                us multi = (us)(0 - (us)((m[l] & (m[l] - 1)) != 0));
+                us next = m[l] & (us)~((row[l] | col[l] | box[l]) & multi);
+                us only = next & (hiddenRow[l] | hiddenCol[l] | hiddenBox[l]);
+                us hasOnly = (us)(0 - (us)(only != 0));
+                next = (only & hasOnly) | (next & (us)~hasOnly);
+                bad[l] |= (us)(0 - (us)(next == 0));
+                changed[l] |= m[l] ^ next;
+                m[l] = next;
+            }
+        }
+
+        us any = 0;
+        for (ui l = 0; l < LANES; l++) {
+            us live = changed[l] & (us)(0 - (us)(bad[l] == 0));
+            rounds[l] = live != 0 ? round : rounds[l];
+            any |= live;
+        }
+        if (any == 0)
+            return;
+    }
+}
+
+//======== AVX2 ========
+// One 256-bit vector holds a cell of all 16 lanes.
+
+#ifdef LANE_SOLVER_X86
+
+AVX2_TARGET static void propagateLanesAvx2(LaneCells& cells, us bad[LANES], ui rounds[LANES]) {
+    const BoardGeometry<3>& g = boardGeometry<3>;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i all = _mm256_set1_epi16(0x1FF);
+    __m256i m[81];
+    for (ui c = 0; c < 81; c++)
+        m[c] = _mm256_load_si256((const __m256i*)cells[c]);
+    __m256i placed[27], hidden[27];
+    __m256i badLanes = zero;
+    // Rounds are counted in 16-bit lanes; more than 729 rounds never happen
+    __m256i lastRound = zero;
+
+    for (ui round = 1;; round++) {
+        for (ui h = 0; h < 27; h++) {
+            __m256i once = zero, twice = zero, fixedOnce = zero, fixedTwice = zero;
+            for (ui k = 0; k < 9; k++) {
+                __m256i v = m[g.houseCells[h][k]];
+                __m256i multi = _mm256_and_si256(v, _mm256_sub_epi16(v, one));
+                __m256i single = _mm256_and_si256(v, _mm256_cmpeq_epi16(multi, zero));
+                fixedTwice = _mm256_or_si256(fixedTwice, _mm256_and_si256(fixedOnce, single));
+                fixedOnce = _mm256_or_si256(fixedOnce, single);
+                twice = _mm256_or_si256(twice, _mm256_and_si256(once, v));
+                once = _mm256_or_si256(once, v);
+            }
+            placed[h] = fixedOnce;
+            hidden[h] = _mm256_andnot_si256(_mm256_or_si256(twice, fixedOnce), once);
+            badLanes = _mm256_or_si256(badLanes, _mm256_or_si256(fixedTwice, _mm256_andnot_si256(once, all)));
+        }
+
+        __m256i changed = zero;
+        for (ui c = 0; c < 81; c++) {
+            const std::array<unsigned char, 3>& houses = g.cellHouses[c];
+            __m256i v = m[c];
+            __m256i peers = _mm256_or_si256(_mm256_or_si256(placed[houses[0]], placed[houses[1]]), placed[houses[2]]);
+            __m256i only = _mm256_or_si256(_mm256_or_si256(hidden[houses[0]], hidden[houses[1]]), hidden[houses[2]]);
+            __m256i isSingle = _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_sub_epi16(v, one)), zero);
+            __m256i next = _mm256_blendv_epi8(_mm256_andnot_si256(peers, v), v, isSingle);
+            only = _mm256_and_si256(next, only);
+            next = _mm256_blendv_epi8(only, next, _mm256_cmpeq_epi16(only, zero));
+            badLanes = _mm256_or_si256(badLanes, _mm256_cmpeq_epi16(next, zero));
+            changed = _mm256_or_si256(changed, _mm256_xor_si256(v, next));
+            m[c] = next;
+        }
+
+        // Lanes that changed and are still consistent
+        __m256i live = _mm256_and_si256(_mm256_cmpeq_epi16(badLanes, zero), changed);
+        live = _mm256_andnot_si256(_mm256_cmpeq_epi16(live, zero), _mm256_set1_epi16(-1));
+        lastRound = _mm256_blendv_epi8(lastRound, _mm256_set1_epi16((short)round), live);
+        if (_mm256_testz_si256(live, live))
+            break;
+    }
+
+    alignas(32) us last[LANES];
+    _mm256_store_si256((__m256i*)bad, badLanes);
+    _mm256_store_si256((__m256i*)last, lastRound);
+    for (ui l = 0; l < LANES; l++)
+        rounds[l] = last[l];
+    for (ui c = 0; c < 81; c++)
+        _mm256_store_si256((__m256i*)cells[c], m[c]);
+}
+
+/** Check that the CPU and the OS support AVX2. */
+static bool detectAvx2() {
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+/** Cached result of detectAvx2(). */
+static bool cpuHasAvx2() {
+    static const bool avx2 = detectAvx2();
+    return avx2;
+}
+
+#endif
+
+//======== Entry point ========
+
+unsigned LaneSolver::solveSingles(const std::array<ulli, 12>* puzzles, size_t count, char* out, size_t stride, ui rounds[LANES]) {
+    // Unused lanes stay all-candidate boards, which stall in the first round
+    alignas(32) LaneCells cells;
+    for (ui c = 0; c < 81; c++) {
+        ui bitIndex = c * 9u;
+        ui word = bitIndex / 64;
+        ui shift = bitIndex % 64;
+        for (ui l = 0; l < LANES; l++) {
+            if (l >= count) {
+                cells[c][l] = 0x1FF;
+                continue;
+            }
+            ulli bits = puzzles[l][word] >> shift;
+            if (shift > 64 - 9)
+                bits |= puzzles[l][word + 1] << (64 - shift);
+            cells[c][l] = (us)(bits & 0x1FF);
+        }
+    }
+
+    alignas(32) us bad[LANES] = {};
+    for (ui l = 0; l < LANES; l++)
+        rounds[l] = 0;
+#ifdef LANE_SOLVER_X86
+    if (cpuHasAvx2())
+        propagateLanesAvx2(cells, bad, rounds);
+    else
+        propagateLanesScalar(cells, bad, rounds);
+#else
+    propagateLanesScalar(cells, bad, rounds);
+#endif
+
+    // Without a contradiction, a board of singles only is a valid full grid
+    unsigned solved = 0;
+    for (ui l = 0; l < count; l++) {
+        if (bad[l] != 0)
+            continue;
+        bool full = true;
+        for (ui c = 0; c < 81 && full; c++)
+            full = std::has_single_bit(cells[c][l]);
+        if (!full)
+            continue;
+        char* line = out + l * stride;
+        for (ui c = 0; c < 81; c++)
+            line[c] = (char)('1' + std::countr_zero(cells[c][l]));
+        solved |= 1u << l;
+    }
+    return solved;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "SudokuBoard.h"
+
+#include <cstddef>
+#include <array>
+
+/**
+ * @class LaneSolver
+ * @brief Solves up to LANES easy puzzles at once with naked and hidden singles.
+ *
+ * The boards are stored structure-of-arrays: for each of the 81 cells, one 16-bit candidate
+ * mask per puzzle side by side, so a single vector instruction updates that cell in all
+ * puzzles. Every round rebuilds the placed values and the hidden singles of all 27 houses
+ * from the masks, then eliminates placed values from the peers of every unfixed cell and
+ * assigns the hidden singles, in all lanes at once and with no per-puzzle branches. Rounds
+ * repeat until no lane changes. Lanes that reach a valid full grid are done; lanes that stall
+ * or hit a contradiction are reported as unsolved, for the scalar dfsSolve() path to take.
+ *
+ * Singles reach the same fixpoint whatever order they are applied in, so a puzzle solved
+ * here has exactly the solution (the only one) the scalar search finds. There is an AVX2
+ * kernel (one 256-bit vector per cell) used when the CPU supports AVX2, and a portable
+ * one written as plain loops over the lanes, which compilers vectorize for SSE2 and NEON.
+ */
+class LaneSolver {
+public:
+    /** Puzzles propagated together. */
+    static const size_t LANES = 16;
+
+    /**
+     * @brief Solve up to LANES puzzles by singles propagation.
+     * @param puzzles Candidate bits of count puzzles (see SudokuBoard::parseData()).
+     * @param count Number of puzzles, 1..LANES.
+     * @param out Receives the 81-character solution of solved puzzle i at out + i * stride;
+     *            the lines of unsolved puzzles are left unchanged.
+     * @param stride Distance between the lines of consecutive puzzles in out.
+     * @param rounds Receives, for each puzzle, the rounds that changed its board.
+     * @return Bitset of the solved puzzles (bit i = puzzle i).
+     */
+    static unsigned solveSingles(const std::array<ulli, 12>* puzzles, size_t count, char* out, size_t stride, ui rounds[LANES]);
+};
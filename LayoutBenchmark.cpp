@@ -0,0 +1,220 @@
+#include "SudokuBoard.h"
+#include "PuzzleReader.h"
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <utility>
+#include <vector>
+#include <array>
+#include <bit>
+
+/**
+ * @file
+ * @brief Micro-benchmark of the per-cell mask layout against the former packed 729-bit layout.
+ *
+ * Both layouts are loaded with the same puzzles and run the primitive operations the
+ * solver is built on: single-bit probes, candidate counts, only-value lookups, MRV scans
+ * and eliminate/restore cycles. A full SudokuBoard::dfsSolve pass over the puzzles is
+ * timed as well, once per backtracking mode. Usage: LayoutBenchmark [puzzle file] [iterations]
+ */
+
+/**
+ * @struct PackedLayout
+ * @brief The former SudokuBoard storage: 9 bits per cell packed across 12 ulli words.
+ *
+ * Accessors are the former implementations: a divide and modulo per bit, and a loop
+ * over all 9 values to count candidates.
+ */
+struct PackedLayout {
+    std::array<ulli, 12> bitset;
+
+    explicit PackedLayout(const std::array<ulli, 12>& data) : bitset(data) {}
+
+    bool isPossible(ui cell, uc value) const {
+        ui bit_index = cell * 9u + (value - 1);
+        return (bitset[bit_index / 64] & (1ULL << (bit_index % 64))) != 0ULL;
+    }
+
+    void setPossible(ui cell, uc value, bool isPossible) {
+        ui bit_index = cell * 9u + (value - 1);
+        ulli mask = 1ULL << (bit_index % 64);
+        if (isPossible) bitset[bit_index / 64] |= mask;
+        else bitset[bit_index / 64] &= ~mask;
+    }
+
+    uc cellInfo(ui cell, uc& count) const {
+        count = 0;
+        uc onlyValue = 0;
+        for (uc v = 1; v <= 9; v++) {
+            if (isPossible(cell, v)) {
+                onlyValue = v;
+                count++;
+            }
+        }
+        return count == 1 ? onlyValue : 0;
+    }
+};
+
+/**
+ * @struct MaskLayout
+ * @brief The current SudokuBoard storage: one 16-bit candidate mask per cell.
+ */
+struct MaskLayout {
+    std::array<us, 81> cells;
+
+    explicit MaskLayout(const std::array<ulli, 12>& data) {
+        SudokuBoard board(data);
+        for (ui i = 0; i < 81; i++)
+            cells[i] = board.getCandidateMaskAt(GPos((uc)(i % 9), (uc)(i / 9)));
+    }
+
+    bool isPossible(ui cell, uc value) const {
+        return (cells[cell] & (1u << (value - 1))) != 0;
+    }
+
+    void setPossible(ui cell, uc value, bool isPossible) {
+        us bit = (us)(1u << (value - 1));
+        if (isPossible) cells[cell] |= bit;
+        else cells[cell] &= (us)~bit;
+    }
+
+    uc cellInfo(ui cell, uc& count) const {
+        us mask = cells[cell];
+        count = (uc)std::popcount(mask);
+        return count == 1 ? (uc)(std::countr_zero(mask) + 1) : 0;
+    }
+};
+
+/** Sink for benchmark results so the compiler cannot drop the loops. */
+static volatile ulli benchmarkSink;
+
+/**
+ * @brief Run all primitive benchmarks for one layout and print ns per board.
+ *
+ * @tparam Layout PackedLayout or MaskLayout.
+ * @param name Label printed in front of the results.
+ * @param puzzles Puzzles to load.
+ * @param iterations Number of passes over all puzzles.
+ * @param results Receives the ns-per-board figure of each benchmark.
+ */
+template <class Layout>
+static void benchmarkLayout(const char* name, const std::vector<std::array<ulli, 12>>& puzzles, ui iterations, std::vector<double>& results) {
+    std::vector<Layout> boards;
+    for (const auto& p : puzzles)
+        boards.emplace_back(p);
+    double runs = (double)boards.size() * iterations;
+
+    auto time = [&](const char* label, auto body) {
+        auto start = std::chrono::steady_clock::now();
+        ulli acc = 0;
+        for (ui it = 0; it < iterations; it++)
+            for (Layout& b : boards)
+                acc += body(b);
+        auto end = std::chrono::steady_clock::now();
+        benchmarkSink = acc;
+        double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / runs;
+        results.push_back(ns);
+        std::cout << "  " << name << ' ' << label << ": " << ns << " ns/board" << std::endl;
+    };
+
+    time("probe 729 bits   ", [](Layout& b) {
+        ulli n = 0;
+        for (ui c = 0; c < 81; c++)
+            for (uc v = 1; v <= 9; v++)
+                n += b.isPossible(c, v);
+        return n;
+    });
+    time("count 81 cells   ", [](Layout& b) {
+        ulli n = 0;
+        uc count;
+        for (ui c = 0; c < 81; c++) {
+            b.cellInfo(c, count);
+            n += count;
+        }
+        return n;
+    });
+    time("only-value 81    ", [](Layout& b) {
+        ulli n = 0;
+        uc count;
+        for (ui c = 0; c < 81; c++)
+            n += b.cellInfo(c, count);
+        return n;
+    });
+    time("MRV scan         ", [](Layout& b) {
+        ui best = 0;
+        uc bestCount = 10, count;
+        for (ui c = 0; c < 81; c++) {
+            b.cellInfo(c, count);
+            if (count > 1 && count < bestCount) {
+                bestCount = count;
+                best = c;
+            }
+        }
+        return (ulli)best;
+    });
+    time("eliminate+restore", [](Layout& b) {
+        ulli n = 0;
+        for (ui c = 0; c < 81; c++) {
+            bool was = b.isPossible(c, 5);
+            b.setPossible(c, 5, false);
+            n += b.isPossible(c, 5);
+            b.setPossible(c, 5, was);
+        }
+        return n;
+    });
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = argc >= 2 ? argv[1] : "example.txt";
+    ui iterations = argc >= 3 ? (ui)std::stoul(argv[2]) : 20000;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "{error} cannot open puzzle file: " << path << std::endl;
+        return 1;
+    }
+    std::vector<std::array<ulli, 12>> puzzles;
+    PuzzleReader reader(file);
+    std::array<ulli, 12> data;
+    while (reader.next(data))
+        puzzles.push_back(data);
+    if (puzzles.empty()) {
+        std::cerr << "{error} no puzzles in " << path << std::endl;
+        return 1;
+    }
+    std::cout << puzzles.size() << " puzzles x " << iterations << " iterations" << std::endl;
+
+    std::vector<double> packed, mask;
+    benchmarkLayout<PackedLayout>("packed", puzzles, iterations, packed);
+    benchmarkLayout<MaskLayout>("mask  ", puzzles, iterations, mask);
+    std::cout << "  speedup (packed / mask):";
+    for (size_t i = 0; i < packed.size(); i++)
+        std::cout << ' ' << packed[i] / mask[i] << 'x';
+    std::cout << std::endl;
+
+    // Whole solves with the current board, in both backtracking modes
+    ui solveIterations = iterations / 100 + 1;
+    const std::pair<BacktrackMode, const char*> modes[2] = {
+        { BACKTRACK_SNAPSHOT, "snapshot" },
+        { BACKTRACK_TRAIL, "trail   " }
+    };
+    for (const auto& [mode, label] : modes) {
+        auto start = std::chrono::steady_clock::now();
+        ulli solved = 0;
+        for (ui it = 0; it < solveIterations; it++) {
+            for (const auto& p : puzzles) {
+                SudokuBoard board(p);
+                board.setBacktrackMode(mode);
+                bool assigned[81] = {};
+                solved += board.dfsSolve(assigned);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        benchmarkSink = solved;
+        double us_ = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000.0
+            / ((double)puzzles.size() * solveIterations);
+        std::cout << "  dfsSolve (" << label << "): " << us_ << " us/puzzle" << std::endl;
+    }
+    return 0;
+}
@@ -1,7 +1,29 @@
 ﻿#include "SudokuBoard.h"
+#include "PuzzleReader.h"
+#include "MappedPuzzleFile.h"
+#include "PackedPuzzleFile.h"
+#include "BatchSolver.h"
+#include "PuzzleGenerator.h"
+#include "Version.h"
+#include "ConsoleColors.h"
+#include "TraceFormat.h"
+#include "TraceSink.h"
+#ifndef _WIN32
+  #include "SolverServer.h"
+  #include <csignal>
+#else
+  #include <io.h>
+  #include <fcntl.h>
+#endif
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
 #include <cstdio>
+#include <string>
+#include <memory>
 #include <vector>
+#include <array>
 #include <chrono>
 
 /**
@@ -11,33 +33,34 @@
  * This file defines functions to read a Sudoku puzzle from standard input,
  * print the board state with optional ANSI colors, and solve the puzzle
  * using the SudokuBoard class (bitset-based solver with DFS and logical simplification).
+ * "--describe" traces every assignment, simplification and elimination of the search.
+ * With "--batch [file]" it instead solves a whole puzzle file non-interactively,
+ * optionally on several threads ("--threads N"), and "--box 4" or "--box 5" switches the
+ * batch mode to 16x16 or 25x25 puzzles (see SudokuBoardN). "--serve ADDRESS" runs a
+ * long-lived daemon answering packed puzzle batches over a socket (see SolverServer).
+ * "--generate N" prints N new minimal unique puzzles and "--rate [file]" rates the
+ * difficulty of each puzzle of a file (see PuzzleGenerator). Both batch and rate modes read
+ * text or packed puzzle files (see PackedPuzzleFile.h), and "--pack" writes the batch results
+ * packed.
  */
 
-#define PROGRAM_VERSION "SudokuSolver v1.1.4"
-#define IS_DESCRIPTED_VERSION          0
-#define IS_ANSI_ESCAPE_COLORED_VERSION 0
-
-#if IS_ANSI_ESCAPE_COLORED_VERSION
-  #define ANSI_ESCAPE_RESET    "\033[0m"
-  #define ANSI_ESCAPE_GRAY     "\033[90m"
-  #define ANSI_ESCAPE_RED      "\033[91m"
-  #define ANSI_ESCAPE_GREEN    "\033[92m"
-  #define ANSI_ESCAPE_YELLOW   "\033[93m"
-  #define ANSI_ESCAPE_MAGENTA  "\033[95m"
-#else
-  #define ANSI_ESCAPE_RESET    ""
-  #define ANSI_ESCAPE_GRAY     ""
-  #define ANSI_ESCAPE_RED      ""
-  #define ANSI_ESCAPE_GREEN    ""
-  #define ANSI_ESCAPE_YELLOW   ""
-  #define ANSI_ESCAPE_MAGENTA  ""
-#endif
+/** Batch mode reads, solves and writes puzzles in windows of this many puzzles. */
+#define BATCH_WINDOW_SIZE (1 << 14)
 
 /** Global SudokuBoard instance used by the solver. */
 SudokuBoard board;
 
-/** Counters for assignments and simplifications, used in output summary. */
-static ulli assignments, simplifications;
+/** Whether the interactive solver traces its steps ("DESC") or only counts them ("PRFM"). */
+static bool isDescriptive = false;
+
+/** Sink recording the steps of the interactive solver instead of printing them ("--trace"), or nullptr. */
+static TraceSink* traceSink = nullptr;
+
+/** Strongest propagation rules used by the solver ("--rules"). */
+static RuleTier ruleTier = RULES_SINGLES;
+
+/** Branching strategy used by the solver ("--branch"). */
+static BranchStrategy branchStrategy = BRANCH_MRV;
 
 /** Constant array of 81 falses, used to indicate no highlights when printing. */
 static const bool falseArr81[81] = {};
@@ -45,261 +68,64 @@ static const bool falseArr81[81] = {};
 /**
  * @brief Print the current board state to stdout, optionally highlighting certain cells.
  *
- * This function draws the Sudoku grid with row and column separators.
  * Cells with a single determined value are printed as digits; cells with
  * multiple candidates are shown as '-' and empty cells with zero candidates
- * are marked with '!'. Highlighted cells (where highlights[i] == true)
- * are printed in magenta.
+ * are marked with '!' (see printTraceBoard()).
  *
  * @param spaces Number of leading spaces to indent each printed line (to indicate recursion depth).
  * @param highlights Boolean array of length 81, where true indicates the cell should be highlighted.
  * @return true if any cell has zero candidates (contradiction), false otherwise.
  */
 static bool printBoard(size_t spaces, const bool highlights[81], const char* highlightColor) {
-    bool hasContradiction = false;
-
-    for (ui y = 0; y < 9; y++) {
-        // Print horizontal separator every 3 rows
-        if (y % 3 == 0) {
-            for (size_t i = 0; i < spaces; i++) std::cout << ' ';
-            std::cout << ANSI_ESCAPE_GRAY << "+-------+-------+-------+" << ANSI_ESCAPE_RESET << std::endl;
-        }
-        // Indent
-        for (size_t i = 0; i < spaces; i++) std::cout << ' ';
-
-        for (ui x = 0; x < 9; x++) {
-            // Print vertical separator every 3 columns
-            if (x % 3 == 0) std::cout << ANSI_ESCAPE_GRAY << "| " << ANSI_ESCAPE_RESET;
-
-            uc count;
-            uc val = board.getCellInfoAt(GPos(x, y), count);
-            if (val == 0) {
-                // If no single value assigned
-                if (count == 0) {
-                    // Contradiction: no candidates remain
-                    hasContradiction = true;
-                    std::cout << ANSI_ESCAPE_RED << "! " << ANSI_ESCAPE_RESET;
-                    continue;
-                }
-                // Multiple candidates remain: print placeholder '-'
-                std::cout << ANSI_ESCAPE_GRAY << '-' << ANSI_ESCAPE_RESET << ' ';
-            } else {
-                // Single value assigned
-                bool highlight = highlights[x + 9 * y];
-                if (highlight) std::cout << highlightColor;
-                std::cout << char('0' + val) << ' ';
-                if (highlight) std::cout << ANSI_ESCAPE_RESET;
-            }
-        }
-        // Close row
-        std::cout << ANSI_ESCAPE_GRAY << "|" << std::endl;
-    }
-    // Print final horizontal separator
-    for (ui i = 0; i < spaces; i++) std::cout << ' ';
-    std::cout << ANSI_ESCAPE_GRAY << "+-------+-------+-------+" << ANSI_ESCAPE_RESET << std::endl;
-
-    return hasContradiction;
-}
-
-/**
- * @brief Convert a vector of GPos into a boolean highlight array (length 81).
- *
- * This helper builds an array of 81 booleans where indices corresponding
- * to the positions in 'highlights' are set to true.
- *
- * @param spaces Unused parameter (kept for overload consistency).
- * @param highlights Vector of GPos positions to highlight.
- * @return Boolean array of length 81 with true at highlighted positions.
- */
-static bool printBoard(size_t spaces, const std::vector<GPos>& highlights) {
-    bool highlights_[81] = {}; // Initialize all to false
-    for (size_t i = 0; i < highlights.size(); i++) {
-        GPos gpos = highlights[i];
-        highlights_[gpos.getX() + 9 * gpos.getY()] = true;
-    }
-    return highlights_;
-}
-
-/**
- * @brief Listener callback invoked whenever a tentative value is assigned to a cell during DFS.
- *
- * This function increments the 'assignments' counter, and if descriptive mode is enabled,
- * it prints the current recursion path, the assigned cell coordinates, and the board state.
- *
- * @param path Vector of branch indices taken so far (for tracing).
- * @param assigned Boolean array of length 81 indicating which cells are currently assigned.
- * @param justAssigned GPos of the cell that was just assigned a definite value.
- */
-static void assignListener(
-    const std::vector<ui>& path,
-    const bool assigned[81],
-    const GPos& justAssigned
-) {
-    assignments++;
-    if (!IS_DESCRIPTED_VERSION) return;
-
-    // Indentation proportional to recursion depth
-    size_t spaces = (path.size() - 1) * 2;
-    for (size_t i = 0; i < spaces; i++) std::cout << ' ';
-
-    // Print path of branch decisions (1-based for display)
-    for (size_t i = 1; i < path.size(); i++) {
-        if (i != 0) std::cout << '.';
-        std::cout << (path[i] + 1);
-    }
-
-    std::cout << ANSI_ESCAPE_GRAY << "(T): " << ANSI_ESCAPE_RESET
-        << ANSI_ESCAPE_MAGENTA << "ASSIGN" << ANSI_ESCAPE_RESET
-        << ": (" << (int)(justAssigned.getX() + 1)
-        << ',' << (int)(justAssigned.getY() + 1) << ") = "
-        << ANSI_ESCAPE_MAGENTA
-        << ((int)board.getOnlyPossibleValue(justAssigned))
-        << ANSI_ESCAPE_RESET << std::endl;
-
-    // Print board state after assignment
-    printBoard(spaces, assigned, ANSI_ESCAPE_MAGENTA);
-
-    std::cout << std::endl; // v1.1.4
+    return printTraceBoard(std::cout, board, spaces, highlights, highlightColor);
 }
 
 /**
- * @brief Listener callback invoked after each simplification pass in DFS.
- *
- * This function increments the 'simplifications' counter, and if descriptive mode is enabled,
- * it prints the current path, the number of candidates eliminated in this pass,
- * and the total eliminated so far, followed by the board state.
- *
- * @param path Vector of branch indices taken so far.
- * @param index Index of the simplification iteration (0-based).
- * @param eliminated Number of candidate bits eliminated in this pass.
- * @param eliminatedSum Accumulated total elimination count so far.
- * @param isFirstSimplificationGroup True if this is the first simplify call at this branch.
- * @param assigned Boolean array of length 81 indicating which cells are assigned.
+ * @struct TraceListener
+ * @brief Listener policy of the descriptive mode: counts like StatsListener and prints every step.
  */
-static void simplifyListener(
-    const std::vector<ui>& path,
-    const ui& index,
-    const ui& eliminated,
-    const ulli& eliminatedSum,
-    const bool isFirstSimplificationGroup,
-    const bool assigned[81]
-) {
-    simplifications++;
-    if (!IS_DESCRIPTED_VERSION) return;
-
-    // Indentation proportional to recursion depth
-    size_t spaces = (path.size()) * 2;
-    if (spaces >= 2) {
-        for (size_t i = 0; i < spaces - 2; i++) std::cout << ' ';
-        std::cout << ANSI_ESCAPE_GRAY << "> " << ANSI_ESCAPE_RESET;
-    }
-
-    // Print branch path
-    for (size_t i = 1; i < path.size(); i++) {
-        if (i != 0) std::cout << '.';
-        std::cout << (path[i] + 1);
-    }
-
-    std::cout << ANSI_ESCAPE_GRAY << "(S." << (index + 1) << "): " << ANSI_ESCAPE_RESET
-        << ANSI_ESCAPE_GREEN << "SIMPLIFY" << ANSI_ESCAPE_RESET
-        << ": ELIMINATED = " << eliminated
-        << ANSI_ESCAPE_GRAY << "(sum = " << eliminatedSum << ")" << ANSI_ESCAPE_RESET
-        << std::endl;
-
-    // Print board state after simplification
-    printBoard(spaces, assigned, ANSI_ESCAPE_MAGENTA);
-
-    std::cout << std::endl; // v1.1.3
-}
+struct TraceListener : StatsListener {
+    using StatsListener::StatsListener;
 
-/**
- * @brief Listener callback invoked whenever a single candidate elimination or determination occurs.
- *
- * This function prints detailed information about each elimination step if descriptive mode is enabled:
- * whether the cause was elimination or hidden single logic, which cell was affected,
- * what value was eliminated or assigned, and by which house (row/column/chunk).
- *
- * @param path Vector of branch indices taken so far.
- * @param cause Enumeration value indicating type of elimination or assignment.
- * @param cell GPos of the cell where elimination/assignment occurred.
- * @param value The candidate value (1..9) that was eliminated or determined.
- * @param by For elimination: the index of row/column/chunk responsible (0-based).
- *           For hidden single: the house index similarly encoded.
- */
-static void eliminateListener(
-    const std::vector<ui>& path,
-    const SimplificationCause& cause,
-    const GPos& cell,
-    const uc& value,
-    const uc& by
-) {
-    if (!IS_DESCRIPTED_VERSION) return;
-
-    // Indentation proportional to recursion depth
-    size_t spaces = (path.size()) * 2;
-    for (size_t i = 0; i < spaces; i++) std::cout << ' ';
-
-    bool isElimination = ELIMINATION_BY_ROW <= cause && cause <= ELIMINATION_BY_CHUNK;
-
-    std::cout << ANSI_ESCAPE_GRAY << "-> ";
-    if (cause == NO_VALUE_POSSIBLE) {
-        // Contradiction detected
-        std::cout << ANSI_ESCAPE_MAGENTA << "IMPOSSIBLE" << ANSI_ESCAPE_RESET;
-    } else if (isElimination) {
-        // Candidate eliminated
-        std::cout << ANSI_ESCAPE_RED << "ELIMINATED" << ANSI_ESCAPE_RESET;
-    } else {
-        // Hidden single assignment
-        std::cout << ANSI_ESCAPE_GREEN << "BE DECIDED" << ANSI_ESCAPE_RESET;
+    void onAssign(const SearchPath& path, const bool assigned[81], const GPos& justAssigned) {
+        StatsListener::onAssign(path, assigned, justAssigned);
+        printAssignStep(std::cout, board, path, assigned, justAssigned);
     }
-
-    // Print cell coordinates (1-based for display)
-    std::cout << ": (" << ((int)cell.getX() + 1) << ", " << ((int)cell.getY() + 1) << ")";
-
-    if (cause == NO_VALUE_POSSIBLE) {
-        // Only print "IMPOSSIBLE", no further details
-        std::cout << ANSI_ESCAPE_RESET << std::endl;
-        return;
+    void onSimplify(const SearchPath& path, ui index, ui eliminated, ulli eliminatedSum, bool isFirstSimplificationGroup, const bool assigned[81]) {
+        StatsListener::onSimplify(path, index, eliminated, eliminatedSum, isFirstSimplificationGroup, assigned);
+        printSimplifyStep(std::cout, board, path, index, eliminated, eliminatedSum, assigned);
     }
+    void onEliminate(const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by) {
+        printEliminateStep(std::cout, path, cause, cell, value, by, board.getCandidateMaskAt(cell));
+    }
+};
 
-    // Print the value eliminated or determined
-    std::cout << ' ' << (isElimination ? '!' : '=') << "= " << (int)value;
-
-    // Print which house (row/column/chunk) caused this event
-    std::cout << " by ";
-    int classification = (cause - 1) % 3;
-    if (classification == 0) {
-        std::cout << "row";
-    } else if (classification == 1) {
-        std::cout << "column";
-    } else if (classification == 2) {
-        std::cout << "chunk";
+/**
+ * @struct RecordingListener
+ * @brief Listener policy of "--trace": counts like StatsListener and records every step.
+ */
+struct RecordingListener : StatsListener {
+    TraceSink& sink;  /**< Receives the steps */
+
+    /**
+     * @brief Constructor.
+     * @param stats Record to count into.
+     * @param sink Sink to record the steps into.
+     */
+    RecordingListener(SolveStats& stats, TraceSink& sink) : StatsListener(stats), sink(sink) {}
+
+    void onAssign(const SearchPath& path, const bool assigned[81], const GPos& justAssigned) {
+        StatsListener::onAssign(path, assigned, justAssigned);
+        sink.assign(board, path, assigned, justAssigned);
     }
-    std::cout << ' ' << ((int)by + 1);
-    if (classification == 2) {
-        // For chunk, also display 3×3 coordinates (1-based)
-        std::cout << '(' << (int)(by % 3 + 1) << ", " << ((int)(by / 3) + 1) << ')';
+    void onSimplify(const SearchPath& path, ui index, ui eliminated, ulli eliminatedSum, bool isFirstSimplificationGroup, const bool assigned[81]) {
+        StatsListener::onSimplify(path, index, eliminated, eliminatedSum, isFirstSimplificationGroup, assigned);
+        sink.simplify(board, path, index, eliminated, eliminatedSum, assigned);
     }
-
-    // Print remaining candidates for that cell in gray
-    std::cout << ANSI_ESCAPE_GRAY << " {";
-    bool isFirst = true;
-    uc count = 0;
-    for (uc v = 1; v <= 9; v++) {
-        if (!board.isPossibleAt(cell, v)) continue;
-        if (!isFirst) std::cout << ", ";
-        std::cout << (int)v;
-        isFirst = false;
-        count++;
+    void onEliminate(const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by) {
+        sink.eliminate(path, cause, cell, value, by, board.getCandidateMaskAt(cell));
     }
-    std::cout << "}(" << (int)count << ")" << ANSI_ESCAPE_RESET;
-
-    // If exactly one candidate remains after elimination, mark it
-    if (board.getOnlyPossibleValue(cell) != 0)
-        std::cout << ANSI_ESCAPE_GREEN << " (!)" << ANSI_ESCAPE_RESET;
-
-    std::cout << ANSI_ESCAPE_RESET << std::endl;
-}
+};
 
 /**
  * @brief Consume and discard all characters until a newline is encountered.
@@ -307,8 +133,8 @@ static void eliminateListener(
  * Used to clear the input buffer when expecting the user to press ENTER.
  */
 static void skipToNewLine() {
-    char c;
-    while ((c = std::getchar()) != '\n') {}
+    int c;
+    while ((c = std::getchar()) != '\n' && c != EOF) {}
 }
 
 /**
@@ -316,7 +142,7 @@ static void skipToNewLine() {
  *
  * Prints a prompt and waits for a newline. Used between major steps.
  */
-static void pause() {
+static void pauseForEnter() {
     std::cout << std::endl << "Press ENTER to continue..." << std::endl;
     skipToNewLine();
 }
@@ -327,7 +153,7 @@ static void pause() {
  * 1. Prompt user to enter 9 lines of 9 characters each (digits 1-9 or blank for empty).
  * 2. Populate the SudokuBoard with given clues.
  * 3. Display the initial board, then wait for user input if descriptive mode is off.
- * 4. Invoke DFS solver with listeners to track progress.
+ * 4. Invoke DFS solver with the tracing or the counting listener policy.
  * 5. Measure elapsed time and count of assignments/simplifications.
  * 6. Print final solved board and performance summary.
  *
@@ -344,15 +170,15 @@ static bool solver() {
     for (uc y = 0; y < 9; y++) {
         std::cout << ANSI_ESCAPE_GRAY << (int)(y + 1) << ": " << ANSI_ESCAPE_RESET;
         for (uc x = 0; x < 9; x++) {
-            char c = 0;
             // Read one character (expect digit or blank)
-            if (scanf_s("%c", &c, 1) != 1) {
+            int c = std::getchar();
+            if (c == EOF) {
                 std::cerr << ANSI_ESCAPE_RED << "{error} input-format-error: too little characters provided in a line" << ANSI_ESCAPE_RESET << std::endl;
                 return false;
             }
             // If last column, the next character must be newline
             if (x == 8) {
-                char nl = std::getchar();
+                int nl = std::getchar();
                 if (nl != '\n') {
                     std::cerr << ANSI_ESCAPE_RED << "{error} input-format-error: newline is missing" << ANSI_ESCAPE_RESET << std::endl;
                     skipToNewLine();
@@ -375,7 +201,7 @@ static bool solver() {
     std::cout << std::endl;
     // Display initial board (no highlights)
     printBoard(0, falseArr81, nullptr);
-    pause();
+    pauseForEnter();
 
     bool decidedAtStart[81] = {}; // {false, false, ...}
     SudokuBoard before(board.copyData());
@@ -389,17 +215,37 @@ static bool solver() {
     }
 
 
+    if (traceSink != nullptr)
+        traceSink->begin(board);
+
     // Start timing
     auto start = std::chrono::high_resolution_clock::now();
 
-    // Solve with DFS, collecting highlights array (unused) and listeners
+    // Solve with DFS, collecting highlights array (unused) and counters
     bool highlights[81] = {};
-    bool solved = board.dfsSolve(highlights, assignListener, simplifyListener, eliminateListener);
+    SolveStats stats = SolveStats();
+    bool solved;
+    board.setRuleTier(ruleTier);
+    board.setBranchStrategy(branchStrategy);
+    if (traceSink != nullptr) {
+        RecordingListener listener(stats, *traceSink);
+        solved = board.dfsSolve(highlights, listener);
+    } else if (isDescriptive) {
+        TraceListener listener(stats);
+        solved = board.dfsSolve(highlights, listener);
+    } else {
+        StatsListener listener(stats);
+        solved = board.dfsSolve(highlights, listener);
+    }
 
     // End timing
     auto end = std::chrono::high_resolution_clock::now();
     auto micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
     double seconds = micros / 1'000'000.0;
+    if (traceSink != nullptr) {
+        stats.micros = (ulli)micros;
+        traceSink->end(board, solved, stats);
+    }
 
     // Print spacing and solution header
     std::cout << std::endl;
@@ -412,41 +258,737 @@ static bool solver() {
 
     // Display solved board
     printBoard(0, decidedAtStart, ANSI_ESCAPE_GRAY);
-    std::cout << ANSI_ESCAPE_GRAY << '>' << ANSI_ESCAPE_RESET << " Solved in "
-        << ANSI_ESCAPE_YELLOW << assignments     << ANSI_ESCAPE_RESET << " Tentative Assignments, "
-        << ANSI_ESCAPE_YELLOW << simplifications << ANSI_ESCAPE_RESET << " Simplifications, "
-        << ANSI_ESCAPE_GREEN  << seconds         << ANSI_ESCAPE_RESET << " seconds." << std::endl;
+    printSolveSummary(std::cout, stats, seconds);
+    std::cout.flush();
+    return true;
+}
+
+/**
+ * @brief Write and clear the pending batch output.
+ * @param out Output buffer; emptied after writing.
+ */
+static void flushBatchOutput(std::string& out) {
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    out.clear();
+}
+
+/**
+ * @brief Solve every puzzle of a reader and print one line for each.
+ *
+ * Puzzles are read in windows of BATCH_WINDOW_SIZE, solved in parallel by the BatchSolver,
+ * and their lines are written in input order before the next window is read, so memory
+ * stays bounded for arbitrarily large inputs.
+ *
+ * With pack, each puzzle is instead written as a packed record with its solution and its
+ * counters (see PackedPuzzleFile.h); the caller writes the file header.
+ *
+ * @tparam Reader PuzzleReader, PuzzleChunkReader or a packed reader (anything with
+ *         next(std::array<ulli,12>&) and getLineNumber()).
+ * @param reader Source of puzzles.
+ * @param solver Parallel solver to use.
+ * @param stats Receives the merged statistics of all windows.
+ * @param pack Whether to write packed records instead of lines.
+ * @return true on success; false if the input was malformed (error already printed).
+ */
+template <class Reader>
+static bool batchSolveAll(Reader& reader, BatchSolver& solver, SolveStats& stats, bool pack) {
+    static const uc PACK_FLAGS = PACKED_SOLUTIONS | PACKED_STATS;
+    std::vector<std::array<ulli, 12>> window;
+    window.reserve(BATCH_WINDOW_SIZE);
+    std::string out, packed;
+    std::vector<SolveStats> records;
+
+    bool ok = true;
+    while (ok) {
+        // Read the next window; on a format error still solve what was read before it
+        window.clear();
+        try {
+            std::array<ulli, 12> data;
+            while (window.size() < BATCH_WINDOW_SIZE && reader.next(data))
+                window.push_back(data);
+        } catch (const std::runtime_error& e) {
+            std::fflush(stdout);
+            std::cerr << ANSI_ESCAPE_RED << "{error} input-format-error: " << e.what()
+                << " (line " << reader.getLineNumber() << ")" << ANSI_ESCAPE_RESET << std::endl;
+            ok = false;
+        }
+        if (window.empty())
+            break;
+
+        out.resize(window.size() * BatchSolver::LINE_SIZE);
+        if (pack) {
+            size_t bytes = packedRecordBytes(PACK_FLAGS);
+            records.resize(window.size());
+            mergeSolveStats(stats, solver.solve(window, &out[0], records.data()));
+            packed.resize(window.size() * bytes);
+            for (size_t i = 0; i < window.size(); i++)
+                encodePackedRecord(PACK_FLAGS, window[i], &out[i * BatchSolver::LINE_SIZE], records[i], (unsigned char*)&packed[i * bytes]);
+            flushBatchOutput(packed);
+        } else {
+            mergeSolveStats(stats, solver.solve(window, &out[0]));
+            flushBatchOutput(out);
+        }
+        if (window.size() < BATCH_WINDOW_SIZE)
+            break;
+    }
+    return ok;
+}
+
+/**
+ * @brief Open a text or packed puzzle source and hand its reader to a function.
+ *
+ * Files are memory-mapped; packed files are recognized by their magic bytes, and stdin by
+ * its first byte (see PackedPuzzleFile.h).
+ *
+ * @tparam Fn Callable taking any of the readers by reference and returning bool.
+ * @param path Path of the puzzle file, or nullptr to read from stdin.
+ * @param fn Function to run on the reader.
+ * @return Result of fn; false if the source cannot be opened (error already printed).
+ */
+template <class Fn>
+static bool withPuzzleReader(const char* path, Fn fn) {
+    try {
+        if (path != nullptr) {
+            MappedPuzzleFile file(path);
+            if (isPackedPuzzleData(file.getData(), file.getSize())) {
+                PackedChunkReader reader(file.whole());
+                return fn(reader);
+            }
+            PuzzleChunkReader reader(file.whole());
+            return fn(reader);
+        }
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        if (std::cin.peek() == 0x89) {
+            PackedPuzzleReader reader(std::cin);
+            return fn(reader);
+        }
+        PuzzleReader reader(std::cin);
+        return fn(reader);
+    } catch (const std::runtime_error& e) {
+        std::fflush(stdout);
+        std::cerr << ANSI_ESCAPE_RED << "{error} " << e.what() << ANSI_ESCAPE_RESET << std::endl;
+        return false;
+    }
+}
+
+/**
+ * @brief Print the one-line summary of a batch run or a server session to stderr.
+ * @param stats Merged statistics of the run.
+ * @param start Time the run started.
+ * @param threads Number of worker threads used.
+ * @param label Mode the line is tagged with, "BATCH" or "SERVE".
+ */
+static void reportBatch(const SolveStats& stats, std::chrono::high_resolution_clock::time_point start, ui threads, const char* label = "BATCH") {
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1'000'000.0;
+    std::cerr << PROGRAM_VERSION << ' ' << label << ": " << stats.solved << '/' << stats.puzzles << " puzzles solved in "
+        << seconds << " seconds on " << threads << " threads, "
+        << stats.assignments << " Tentative Assignments, "
+        << stats.simplifications << " Simplifications";
+    if (stats.cacheHits + stats.cacheMisses > 0)
+        std::cerr << ", " << stats.cacheHits << " cache hits, " << stats.cacheMisses << " cache misses";
+    if (stats.overBudget > 0)
+        std::cerr << ", " << stats.overBudget << " over budget";
+    if (stats.tableProbes > 0)
+        std::cerr << ", " << stats.tableHits << '/' << stats.tableProbes << " table hits";
+    std::cerr << '.' << std::endl;
+}
+
+/**
+ * @brief Write search counters to a file (see SolveCounters).
+ * @param path Output file; JSON if it ends in ".json", Prometheus text otherwise.
+ * @param counters Counters to write.
+ * @return false (after printing an error) if the file cannot be written.
+ */
+static bool writeMetrics(const char* path, const SolveCounters& counters) {
+    size_t length = std::strlen(path);
+    bool json = length >= 5 && std::strcmp(path + length - 5, ".json") == 0;
+    std::ofstream out(path, std::ios::binary);
+    out << (json ? solveCountersJson(counters) : solveCountersPrometheus(counters));
+    if (!out) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} cannot write " << path << ANSI_ESCAPE_RESET << std::endl;
+        return false;
+    }
     return true;
 }
 
 /**
- * @brief Program entry point. Repeatedly runs the solver in a loop until terminated.
+ * @brief Non-interactive solver that streams a whole puzzle file.
+ *
+ * Reads puzzles in the 81-characters-per-line layout or as 9-line blocks (see PuzzleReader),
+ * solves them without listeners on a pool of worker threads, and prints exactly one
+ * 81-character line per puzzle to stdout, in input order: the solution, or 81 '.' characters
+ * if the puzzle has no solution. Output is buffered and no board grid or prompt is printed;
+ * a one-line summary goes to stderr. Files are memory-mapped and parsed in place; stdin is
+ * read line by line. Packed puzzle files are read as well, and pack writes a packed file
+ * with the solution and counters of every puzzle instead of the lines.
  *
- * After each solved puzzle (or failure), resets counters and the board,
+ * @param path Path of the puzzle file, or nullptr to read from stdin.
+ * @param threads Number of worker threads; 0 uses all hardware threads.
+ * @param splitDepth 0 to solve puzzles side by side; otherwise split each puzzle's search
+ *                   tree across the threads down to this depth (see ParallelSearch).
+ * @param rules Strongest propagation rules to use.
+ * @param branching Branching strategy to use.
+ * @param cacheSize Capacity of the solution cache (see SolutionCache), or 0 for none;
+ *                  only used without splitDepth.
+ * @param metricsPath File to write the search counters to (see writeMetrics()), or nullptr
+ *                    to not count; only used without splitDepth.
+ * @param lanes Whether groups of puzzles are first propagated together (see LaneSolver).
+ * @param pack Whether to write a packed file (see PackedPuzzleFile.h) instead of lines.
+ * @param budget Node and time limits of every search (see BatchSolver::setBudget()); all
+ *               zero for none. Only used without splitDepth.
+ * @param tableSize Slots of the transposition table (see TranspositionTable), or 0 for none;
+ *                  only used without splitDepth.
+ * @param engine Search engine (see SolverEngine); only used without splitDepth.
+ * @return Process exit code: 0 on success, 1 on I/O or input format error.
+ */
+static int batchSolver(const char* path, ui threads, ui splitDepth, RuleTier rules, BranchStrategy branching, size_t cacheSize, const char* metricsPath, bool lanes, bool pack, const SolveBudget& budget, size_t tableSize, SolverEngine engine) {
+    // No interactive I/O happens in batch mode, so the C stdio sync can go
+    std::ios::sync_with_stdio(false);
+
+    WorkStealingPool pool(threads);
+    BatchSolver solver(pool, splitDepth, rules, branching);
+    std::unique_ptr<SolutionCache> cache;
+    if (cacheSize > 0) {
+        cache = std::make_unique<SolutionCache>(cacheSize);
+        solver.setCache(cache.get());
+    }
+    solver.enableCounters(metricsPath != nullptr);
+    solver.setLanes(lanes);
+    solver.setBudget(budget.maxNodes, budget.maxMicros);
+    solver.setEngine(engine);
+    std::unique_ptr<TranspositionTable> table;
+    if (tableSize > 0) {
+        table = std::make_unique<TranspositionTable>(tableSize);
+        solver.setTranspositionTable(table.get());
+    }
+    SolveStats stats = SolveStats();
+    bool ok;
+
+    if (pack) {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        unsigned char header[PACKED_HEADER_BYTES];
+        writePackedHeader(PACKED_SOLUTIONS | PACKED_STATS, header);
+        std::fwrite(header, 1, sizeof(header), stdout);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ok = withPuzzleReader(path, [&](auto& reader) { return batchSolveAll(reader, solver, stats, pack); });
+    std::fflush(stdout);
+    if (!ok)
+        return 1;
+    reportBatch(stats, start, pool.getThreadCount());
+    if (metricsPath != nullptr && !writeMetrics(metricsPath, solver.getCounters()))
+        return 1;
+    return 0;
+}
+
+/**
+ * @brief Non-interactive solver for BOX^2 x BOX^2 puzzles (see SudokuBoardN).
+ *
+ * Works like batchSolver() with one puzzle per line of exactly CELLS characters; blank lines
+ * and lines starting with '#' are skipped. Values are written '1'..'9', 'A'...
+ * Output is one CELLS-character line per puzzle, or CELLS '.' characters if it has no solution.
+ *
+ * @tparam BOX Chunk side length (4 for 16x16, 5 for 25x25).
+ * @param path Path of the puzzle file, or nullptr to read from stdin.
+ * @param threads Number of worker threads; 0 uses all hardware threads.
+ * @return Process exit code: 0 on success, 1 on I/O or input format error.
+ */
+template <ui BOX>
+static int batchSolverLarge(const char* path, ui threads) {
+    constexpr ui CELLS = SudokuBoardN<BOX>::CELLS;
+    std::ios::sync_with_stdio(false);
+
+    std::ifstream file;
+    if (path != nullptr) {
+        file.open(path, std::ios::binary);
+        if (!file) {
+            std::cerr << ANSI_ESCAPE_RED << "{error} cannot open " << path << ANSI_ESCAPE_RESET << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = path != nullptr ? file : std::cin;
+
+    WorkStealingPool pool(threads);
+    BatchSolver solver(pool);
+    SolveStats stats = SolveStats();
+    std::vector<std::string> window;
+    std::string line, out;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ulli lineNumber = 0;
+    bool ok = true;
+    while (ok) {
+        // Read the next window; on a format error still solve what was read before it
+        window.clear();
+        while (window.size() < BATCH_WINDOW_SIZE && std::getline(in, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty() || line[0] == '#')
+                continue;
+            if (line.size() != CELLS) {
+                std::fflush(stdout);
+                std::cerr << ANSI_ESCAPE_RED << "{error} input-format-error: line of " << line.size()
+                    << " characters (expected " << CELLS << ") (line " << lineNumber << ")" << ANSI_ESCAPE_RESET << std::endl;
+                ok = false;
+                break;
+            }
+            window.push_back(line);
+        }
+        if (window.empty())
+            break;
+
+        out.resize(window.size() * (CELLS + 1));
+        mergeSolveStats(stats, solver.solveLarge<BOX>(window, &out[0]));
+        flushBatchOutput(out);
+    }
+    std::fflush(stdout);
+    reportBatch(stats, start, pool.getThreadCount());
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Print new minimal unique puzzles, one 81-character line each.
+ *
+ * Puzzles of seeds seed, seed + 1, ... are generated (see PuzzleGenerator) and printed in
+ * seed order; a one-line summary with the throughput goes to stderr. With fewer puzzles than
+ * threads, each puzzle's uniqueness checks are spread over the threads instead.
+ *
+ * @param count Number of puzzles.
+ * @param seed Seed of the first puzzle.
+ * @param threads Number of worker threads; 0 uses all hardware threads.
+ * @param rules Propagation rules of the uniqueness checks.
+ * @return Process exit code: always 0.
+ */
+static int generatePuzzles(ulli count, ulli seed, ui threads, RuleTier rules) {
+    std::ios::sync_with_stdio(false);
+    WorkStealingPool pool(threads);
+    PuzzleGenerator generator(pool, rules);
+    GenerateStats stats = GenerateStats();
+    std::string out;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (ulli done = 0; done < count;) {
+        size_t window = (size_t)std::min<ulli>(count - done, BATCH_WINDOW_SIZE);
+        out.resize(window * PuzzleGenerator::LINE_SIZE);
+        if (window < pool.getThreadCount()) {
+            for (size_t i = 0; i < window; i++) {
+                mergeGenerateStats(stats, generator.generate(seed + done + i, &out[i * PuzzleGenerator::LINE_SIZE]));
+                out[i * PuzzleGenerator::LINE_SIZE + 81] = '\n';
+            }
+        } else {
+            mergeGenerateStats(stats, generator.generateBatch(window, seed + done, &out[0]));
+        }
+        flushBatchOutput(out);
+        done += window;
+    }
+    std::fflush(stdout);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1'000'000.0;
+    std::cerr << PROGRAM_VERSION << " GENERATE: " << stats.puzzles << " unique puzzles in " << seconds
+        << " seconds on " << pool.getThreadCount() << " threads (" << (seconds > 0 ? stats.puzzles / seconds : 0.0)
+        << " puzzles/s), " << (stats.puzzles > 0 ? (double)stats.givens / stats.puzzles : 0.0) << " givens on average, "
+        << stats.checks << " uniqueness checks." << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Rate every puzzle of a reader and print one line for each.
+ *
+ * Each line holds the 81-character puzzle, its givens, its solutions (2 meaning more than
+ * one), its tier ("search" if no rule tier solves it alone), its search branches and its
+ * hardest cause ("none" if nothing was deduced), separated by spaces (see PuzzleRating).
+ * Windows of BATCH_WINDOW_SIZE puzzles are rated in parallel and printed in input order.
+ *
+ * @tparam Reader PuzzleReader, PuzzleChunkReader or a packed reader.
+ * @param reader Source of puzzles.
+ * @param pool Pool to rate on.
+ * @param puzzles Receives the number of puzzles rated.
+ * @return true on success; false if the input was malformed (error already printed).
+ */
+template <class Reader>
+static bool rateAll(Reader& reader, WorkStealingPool& pool, ulli& puzzles) {
+    std::vector<std::array<ulli, 12>> window;
+    window.reserve(BATCH_WINDOW_SIZE);
+    std::vector<PuzzleRating> ratings;
+    std::string out;
+
+    bool ok = true;
+    while (ok) {
+        window.clear();
+        try {
+            std::array<ulli, 12> data;
+            while (window.size() < BATCH_WINDOW_SIZE && reader.next(data))
+                window.push_back(data);
+        } catch (const std::runtime_error& e) {
+            std::fflush(stdout);
+            std::cerr << ANSI_ESCAPE_RED << "{error} input-format-error: " << e.what()
+                << " (line " << reader.getLineNumber() << ")" << ANSI_ESCAPE_RESET << std::endl;
+            ok = false;
+        }
+        if (window.empty())
+            break;
+
+        ratings.resize(window.size());
+        for (size_t first = 0; first < window.size(); first += BatchSolver::TASK_SIZE) {
+            size_t last = std::min(first + BatchSolver::TASK_SIZE, window.size());
+            pool.submit([&window, &ratings, first, last](ui worker) {
+                for (size_t i = first; i < last; i++)
+                    ratings[i] = ratePuzzle(window[i]);
+            });
+        }
+        pool.wait();
+
+        for (size_t i = 0; i < window.size(); i++) {
+            const PuzzleRating& r = ratings[i];
+            char cells[81];
+            SudokuBoard(window[i]).writeValues(cells);
+            const char* hardest = simplificationCauseName(hardestCause(r));
+            out.append(cells, 81);
+            out += ' ' + std::to_string(r.givens) + ' ' + std::to_string(r.solutions) + ' '
+                + (r.needsSearch ? "search" : ruleTierName(r.tier)) + ' ' + std::to_string(r.branches) + ' '
+                + (hardest != nullptr ? hardest : "none") + '\n';
+        }
+        flushBatchOutput(out);
+        puzzles += window.size();
+        if (window.size() < BATCH_WINDOW_SIZE)
+            break;
+    }
+    return ok;
+}
+
+/**
+ * @brief Rate the difficulty of every puzzle of a file (see rateAll()).
+ * @param path Path of the puzzle file, or nullptr to read from stdin.
+ * @param threads Number of worker threads; 0 uses all hardware threads.
+ * @return Process exit code: 0 on success, 1 on I/O or input format error.
+ */
+static int ratePuzzles(const char* path, ui threads) {
+    std::ios::sync_with_stdio(false);
+    WorkStealingPool pool(threads);
+    ulli puzzles = 0;
+    bool ok;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ok = withPuzzleReader(path, [&](auto& reader) { return rateAll(reader, pool, puzzles); });
+    std::fflush(stdout);
+    if (!ok)
+        return 1;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1'000'000.0;
+    std::cerr << PROGRAM_VERSION << " RATE: " << puzzles << " puzzles rated in " << seconds
+        << " seconds on " << pool.getThreadCount() << " threads." << std::endl;
+    return 0;
+}
+
+#ifndef _WIN32
+/** Server being run by serveSolver(), for the signal handler. */
+static SolverServer* activeServer = nullptr;
+
+/**
+ * @brief SIGINT/SIGTERM handler: let the server shut down cleanly.
+ */
+static void stopServer(int) {
+    if (activeServer != nullptr)
+        activeServer->stop();
+}
+
+/**
+ * @brief Run the solver daemon until SIGINT or SIGTERM.
+ *
+ * Listens on address and answers request frames of packed puzzles (see SolverServer) on a
+ * pool of worker threads, shared by all connections. Solving one batch per request avoids
+ * starting a process per puzzle. A one-line summary goes to stderr on shutdown.
+ *
+ * @param address Listen address: "unix:PATH", "HOST:PORT" or "PORT" (loopback).
+ * @param threads Number of worker threads; 0 uses all hardware threads.
+ * @param rules Strongest propagation rules to use.
+ * @param branching Branching strategy to use.
+ * @param cacheSize Capacity of the solution cache (see SolutionCache), or 0 for none.
+ * @param metricsPath File to write the search counters to on shutdown (see writeMetrics()),
+ *                    or nullptr to not count.
+ * @param budget Node and time limits of every search (see SolverServer::setBudget()); all zero for none.
+ * @return Process exit code: 0 after a clean shutdown, 1 if the socket cannot be set up.
+ */
+static int serveSolver(const char* address, ui threads, RuleTier rules, BranchStrategy branching, size_t cacheSize, const char* metricsPath, const SolveBudget& budget) {
+    WorkStealingPool pool(threads);
+    SolverServer server(pool, rules, branching);
+    std::unique_ptr<SolutionCache> cache;
+    if (cacheSize > 0) {
+        cache = std::make_unique<SolutionCache>(cacheSize);
+        server.setCache(cache.get());
+    }
+    server.enableCounters(metricsPath != nullptr);
+    server.setBudget(budget.maxNodes, budget.maxMicros);
+    try {
+        server.listen(address);
+    } catch (const std::exception& e) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} " << e.what() << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    std::cerr << PROGRAM_VERSION << " SERVE: listening on " << address << " with " << pool.getThreadCount() << " threads" << std::endl;
+
+    activeServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+        server.run();
+    } catch (const std::runtime_error& e) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} " << e.what() << ANSI_ESCAPE_RESET << std::endl;
+        activeServer = nullptr;
+        return 1;
+    }
+    activeServer = nullptr;
+    reportBatch(server.getStats(), start, pool.getThreadCount(), "SERVE");
+    if (metricsPath != nullptr && !writeMetrics(metricsPath, server.getCounters()))
+        return 1;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Print the command line synopsis.
+ * @param out Stream to print to.
+ */
+static void printUsage(std::ostream& out) {
+    out << "usage: SudokuSolver [--help] [--describe] [--rules singles|locked|pairs|triples] [--branch mrv|degree|house|restarts] [--batch [file|-] [--threads N] [--split-depth D] [--engine bitset|dlx|portfolio] [--no-lanes] [--pack] [--box 3|4|5]] [--serve ADDRESS [--threads N]] [--max-nodes N] [--max-micros N] [--table N] [--cache N] [--metrics FILE] [--generate N [--seed S]] [--rate [file|-]] [--trace FILE]" << std::endl;
+}
+
+/**
+ * @brief Program entry point. Repeatedly runs the solver in a loop until the input ends.
+ *
+ * After each solved puzzle (or failure), resets the board,
  * then waits for ENTER before proceeding to next puzzle.
+ * If started as "SudokuSolver --batch [file] [--threads N] [--split-depth D]", runs batchSolver() instead and exits.
+ * "--rules singles|locked|pairs|triples" picks the propagation rules and
+ * "--branch mrv|degree|house|restarts" the branching strategy, in either mode.
+ * "--engine bitset|dlx|portfolio" picks the batch search engine (see SolverEngine).
+ * "--box 4|5" solves 16x16 or 25x25 puzzles in batch mode instead (see batchSolverLarge()).
+ * These only take "--threads N"; the other batch options are rejected with them.
+ * "--serve ADDRESS [--threads N]" runs serveSolver() instead and exits on SIGINT or SIGTERM.
+ * "--cache N" puts a solution cache of N entries in front of the 9x9 batch and server solvers,
+ * and "--metrics FILE" writes their search counters to FILE when done.
+ * "--generate N [--seed S] [--threads N]" runs generatePuzzles() and
+ * "--rate [file] [--threads N]" runs ratePuzzles() instead, then exit.
+ * "--trace FILE" records the steps of the interactive solver to FILE instead of printing them
+ * (see TraceSink; SudokuTraceRender prints such a file).
  *
- * @return Exit code (unused).
+ * @param argc Argument count.
+ * @param argv Arguments; "--help" to print the usage and exit, "--describe" to trace the interactive solver step by step,
+ *             "--batch" optionally followed by a file path ("-" or none for stdin),
+ *             "--threads N" for the number of worker threads (0 = all hardware threads, the default),
+ *             "--split-depth D" to split each puzzle's search tree across those threads,
+ *             "--no-lanes" to search every batch puzzle on its own (see LaneSolver),
+ *             "--pack" to write the batch results as a packed file (see PackedPuzzleFile.h),
+ *             "--max-nodes N" and "--max-micros N" to stop batch or daemon searches that
+ *             take more search nodes or microseconds (see SolveBudget),
+ *             "--table N" for the slots of the batch transposition table (0 = none),
+ *             "--rules TIER" for the strongest propagation rules (see RuleTier),
+ *             "--branch STRATEGY" for the branching strategy (see BranchStrategy),
+ *             "--engine ENGINE" for the batch search engine (see SolverEngine),
+ *             "--box B" for the chunk size of batch puzzles (3, 4 or 5),
+ *             "--serve ADDRESS" to run as a socket daemon (not on Windows),
+ *             "--cache N" for the capacity of the solution cache (0 = none),
+ *             "--metrics FILE" for the search counters file (JSON if FILE ends in ".json"),
+ *             "--generate N" to print N new puzzles, "--seed S" for the seed of the first,
+ *             "--rate" optionally followed by a file path to rate puzzles,
+ *             "--trace FILE" for the binary trace file of the interactive solver.
+ * @return Exit code (unused in interactive mode).
  */
-int main() {
+int main(int argc, char* argv[]) {
+    bool batch = false;
+    const char* batchPath = nullptr;
+    const char* serveAddress = nullptr;
+    ui threads = 0;
+    ui splitDepth = 0;
+    ui box = 3;
+    size_t cacheSize = 0;
+    const char* metricsPath = nullptr;
+    bool generate = false;
+    ulli generateCount = 0;
+    ulli seed = 1;
+    bool rate = false;
+    bool lanes = true;
+    bool pack = false;
+    SolveBudget budget = { 0, 0, nullptr };
+    size_t tableSize = 0;
+    SolverEngine engine = ENGINE_BITSET;
+    bool rulesGiven = false;
+    bool branchGiven = false;
+    const char* ratePath = nullptr;
+    const char* tracePath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            printUsage(std::cout);
+            return 0;
+        } else if (std::strcmp(argv[i], "--describe") == 0) {
+            isDescriptive = true;
+        } else if (std::strcmp(argv[i], "--batch") == 0) {
+            batch = true;
+            // Optional file operand; "-" means stdin
+            if (i + 1 < argc && (argv[i + 1][0] != '-' || std::strcmp(argv[i + 1], "-") == 0)) {
+                i++;
+                batchPath = std::strcmp(argv[i], "-") == 0 ? nullptr : argv[i];
+            }
+        } else if (std::strcmp(argv[i], "--rate") == 0) {
+            rate = true;
+            if (i + 1 < argc && (argv[i + 1][0] != '-' || std::strcmp(argv[i + 1], "-") == 0)) {
+                i++;
+                ratePath = std::strcmp(argv[i], "-") == 0 ? nullptr : argv[i];
+            }
+        } else if (std::strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+            generate = true;
+            generateCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            serveAddress = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (ui)std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--split-depth") == 0 && i + 1 < argc) {
+            splitDepth = (ui)std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--no-lanes") == 0) {
+            lanes = false;
+        } else if (std::strcmp(argv[i], "--pack") == 0) {
+            pack = true;
+        } else if (std::strcmp(argv[i], "--max-nodes") == 0 && i + 1 < argc) {
+            budget.maxNodes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--max-micros") == 0 && i + 1 < argc) {
+            budget.maxMicros = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--table") == 0 && i + 1 < argc) {
+            tableSize = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cacheSize = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--box") == 0 && i + 1 < argc) {
+            box = (ui)std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--rules") == 0 && i + 1 < argc && parseRuleTier(argv[i + 1], ruleTier)) {
+            rulesGiven = true;
+            i++;
+        } else if (std::strcmp(argv[i], "--branch") == 0 && i + 1 < argc && parseBranchStrategy(argv[i + 1], branchStrategy)) {
+            branchGiven = true;
+            i++;
+        } else if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc && parseSolverEngine(argv[i + 1], engine)) {
+            i++;
+        } else {
+            std::cerr << ANSI_ESCAPE_RED << "{error} unknown argument: " << argv[i] << ANSI_ESCAPE_RESET << std::endl;
+            printUsage(std::cerr);
+            return 1;
+        }
+    }
+    if ((int)batch + (int)generate + (int)rate + (int)(serveAddress != nullptr) > 1) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} only one of --batch, --serve, --generate and --rate can be given" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if (box != 3 && (!batch || (box != 4 && box != 5))) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} --box must be 3, 4 or 5, and 4 and 5 need --batch" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if (box != 3 && (rulesGiven || branchGiven || splitDepth != 0 || !lanes)) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} --rules, --branch, --split-depth and --no-lanes only apply to 9x9 puzzles" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if (pack && (!batch || box != 3)) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} --pack needs --batch with 9x9 puzzles" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if ((budget.maxNodes != 0 || budget.maxMicros != 0) && ((!batch && serveAddress == nullptr) || box != 3 || splitDepth != 0)) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} --max-nodes and --max-micros need --batch or --serve with 9x9 puzzles and no --split-depth" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if (tableSize > 0 && (!batch || box != 3 || splitDepth != 0)) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} --table needs --batch with 9x9 puzzles and no --split-depth" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if (engine != ENGINE_BITSET && (!batch || box != 3 || splitDepth != 0)) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} --engine needs --batch with 9x9 puzzles and no --split-depth" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if ((cacheSize > 0 || metricsPath != nullptr) && ((!batch && serveAddress == nullptr) || box != 3 || splitDepth != 0)) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} --cache and --metrics need --batch or --serve with 9x9 puzzles and no --split-depth" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if (tracePath != nullptr && (batch || generate || rate || serveAddress != nullptr)) {
+        std::cerr << ANSI_ESCAPE_RED << "{error} --trace only applies to the interactive solver" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    if (serveAddress != nullptr) {
+        if (batch || box != 3) {
+            std::cerr << ANSI_ESCAPE_RED << "{error} --serve cannot be combined with --batch or --box" << ANSI_ESCAPE_RESET << std::endl;
+            return 1;
+        }
+#ifdef _WIN32
+        std::cerr << ANSI_ESCAPE_RED << "{error} --serve is not supported on Windows" << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+#else
+        return serveSolver(serveAddress, threads, ruleTier, branchStrategy, cacheSize, metricsPath, budget);
+#endif
+    }
+    if (generate)
+        return generatePuzzles(generateCount, seed, threads, ruleTier);
+    if (rate)
+        return ratePuzzles(ratePath, threads);
+    if (batch && box == 4)
+        return batchSolverLarge<4>(batchPath, threads);
+    if (batch && box == 5)
+        return batchSolverLarge<5>(batchPath, threads);
+    if (batch)
+        return batchSolver(batchPath, threads, splitDepth, ruleTier, branchStrategy, cacheSize, metricsPath, lanes, pack, budget, tableSize, engine);
+
+    std::unique_ptr<TraceSink> sink;
+    if (tracePath != nullptr) {
+        try {
+            sink.reset(new TraceSink(tracePath));
+        } catch (const std::runtime_error& e) {
+            std::cerr << ANSI_ESCAPE_RED << "{error} " << e.what() << ANSI_ESCAPE_RESET << std::endl;
+            return 1;
+        }
+        traceSink = sink.get();
+    }
+
     std::cout << ANSI_ESCAPE_YELLOW << PROGRAM_VERSION << ANSI_ESCAPE_RESET << ' ';
-    std::cout << (IS_DESCRIPTED_VERSION          ?    "DESC" :    "PRFM") << ' ';
+    std::cout << (isDescriptive || traceSink != nullptr ? "DESC" : "PRFM") << ' ';
     std::cout << (IS_ANSI_ESCAPE_COLORED_VERSION ? "COLORED" : "NOCOLOR");
     std::cout << std::endl;
 
     bool isFirst = true;
     while (true) {
-        assignments = 0;
-        simplifications = 0;
         if (isFirst) {
             isFirst = false;
         } else {
             board = SudokuBoard();
         }
 
-        if (!solver()) {
+        // Stop at the end of the input instead of prompting forever
+        bool solved = solver();
+        if (std::feof(stdin))
+            break;
+        if (!solved) {
             continue;
         }
-        pause();
+        pauseForEnter();
+        if (std::feof(stdin))
+            break;
+    }
+    if (sink != nullptr) {
+        try {
+            sink->close();
+        } catch (const std::runtime_error& e) {
+            std::cerr << ANSI_ESCAPE_RED << "{error} " << e.what() << ANSI_ESCAPE_RESET << std::endl;
+            return 1;
+        }
     }
     return 0;
 }
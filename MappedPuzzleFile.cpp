@@ -0,0 +1,177 @@
+#include "MappedPuzzleFile.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <array>
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+/**
+ * @brief Find the end of the line starting at pos (the '\n' or end).
+ */
+static const char* findLineEnd(const char* pos, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+    return nl == nullptr ? end : nl;
+}
+
+/**
+ * @brief Check whether the line [pos, lineEnd) is a row of a 9-line block.
+ */
+static bool isBlockRow(const char* pos, const char* lineEnd) {
+    size_t length = lineEnd - pos;
+    if (length > 0 && pos[length - 1] == '\r')
+        length--;
+    return length == 9 && pos[0] != '#';
+}
+
+#ifdef _WIN32
+
+MappedPuzzleFile::MappedPuzzleFile(const char* path)
+    : data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {
+    fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        throw std::runtime_error(std::string("MappedPuzzleFile: cannot open ") + path);
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        CloseHandle(fileHandle);
+        throw std::runtime_error(std::string("MappedPuzzleFile: cannot get size of ") + path);
+    }
+    size = (size_t)fileSize.QuadPart;
+    if (size == 0)
+        return; // Nothing to map
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle != nullptr)
+        data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        throw std::runtime_error(std::string("MappedPuzzleFile: cannot map ") + path);
+    }
+}
+
+MappedPuzzleFile::~MappedPuzzleFile() {
+    if (data != nullptr) UnmapViewOfFile(data);
+    if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+}
+
+#else
+
+MappedPuzzleFile::MappedPuzzleFile(const char* path) : data(nullptr), size(0), fd(-1) {
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("MappedPuzzleFile: cannot open ") + path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error(std::string("MappedPuzzleFile: cannot get size of ") + path);
+    }
+    size = (size_t)st.st_size;
+    if (size == 0)
+        return; // mmap rejects zero-length mappings
+
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error(std::string("MappedPuzzleFile: cannot map ") + path);
+    }
+    // The file is parsed front to back, so let the kernel read ahead aggressively
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapped);
+}
+
+MappedPuzzleFile::~MappedPuzzleFile() {
+    if (data != nullptr) munmap(const_cast<char*>(data), size);
+    if (fd >= 0) close(fd);
+}
+
+#endif
+
+const char* MappedPuzzleFile::getData() const {
+    return data;
+}
+
+size_t MappedPuzzleFile::getSize() const {
+    return size;
+}
+
+PuzzleChunk MappedPuzzleFile::whole() const {
+    return { data, data + size };
+}
+
+std::vector<PuzzleChunk> MappedPuzzleFile::split(size_t chunkCount) const {
+    std::vector<PuzzleChunk> chunks;
+    if (size == 0)
+        return chunks;
+    if (chunkCount == 0)
+        chunkCount = 1;
+
+    const char* end = data + size;
+    const char* begin = data;
+    for (size_t i = 1; i <= chunkCount && begin < end; i++) {
+        const char* cut = end;
+        if (i < chunkCount) {
+            // Move the ideal split point to the start of the next line
+            cut = data + size / chunkCount * i;
+            if (cut < begin) cut = begin;
+            if (cut != data && cut[-1] != '\n') {
+                cut = findLineEnd(cut, end);
+                if (cut != end) cut++;
+            }
+            // Never start a chunk in the middle of a 9-line block
+            while (cut < end) {
+                const char* lineEnd = findLineEnd(cut, end);
+                if (!isBlockRow(cut, lineEnd)) break;
+                cut = lineEnd == end ? end : lineEnd + 1;
+            }
+        }
+        if (cut > begin)
+            chunks.push_back({ begin, cut });
+        begin = cut;
+    }
+    return chunks;
+}
+
+PuzzleChunkReader::PuzzleChunkReader(PuzzleChunk chunk) : pos(chunk.begin), end(chunk.end), lineNumber(0) {}
+
+bool PuzzleChunkReader::next(std::array<ulli, 12>& data) {
+    while (pos < end) {
+        const char* lineEnd = findLineEnd(pos, end);
+        const char* line = pos;
+        pos = lineEnd == end ? end : lineEnd + 1;
+        lineNumber++;
+
+        const char* cells;
+        if (parser.feed(line, lineEnd - line, cells)) {
+            // Parse straight from the mapped bytes (or the 81-byte block buffer)
+            data = SudokuBoard::parseData(cells);
+            return true;
+        }
+    }
+    if (parser.hasPendingRows())
+        throw std::runtime_error("PuzzleChunkReader::next: chunk ends inside a 9-line block.");
+    return false;
+}
+
+ulli PuzzleChunkReader::getLineNumber() const {
+    return lineNumber;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "PuzzleReader.h"
+
+#include <vector>
+#include <array>
+
+/**
+ * @file
+ * @brief Memory-mapped, zero-copy loader for large puzzle files.
+ *
+ * The file is mapped read-only and parsed straight from the mapped bytes into the
+ * 12-word bitset used by SudokuBoard(std::array<ulli,12>). Lines are never copied into
+ * intermediate strings; only the rows of a 9-line block are gathered (81 bytes).
+ */
+
+/**
+ * @struct PuzzleChunk
+ * @brief A byte range [begin, end) of a mapped file that starts and ends on a puzzle boundary.
+ */
+struct PuzzleChunk {
+    const char* begin;  /**< First byte of the chunk (start of a line) */
+    const char* end;    /**< One past the last byte of the chunk */
+};
+
+/**
+ * @class MappedPuzzleFile
+ * @brief Read-only memory mapping of a puzzle file.
+ *
+ * The mapping lives as long as the object; chunks and readers created from it must not
+ * outlive it.
+ */
+class MappedPuzzleFile {
+private:
+    const char* data;     /**< Start of the mapped bytes (nullptr for an empty file) */
+    size_t size;          /**< Number of mapped bytes */
+#ifdef _WIN32
+    void* fileHandle;     /**< Handle returned by CreateFile */
+    void* mappingHandle;  /**< Handle returned by CreateFileMapping */
+#else
+    int fd;               /**< Open file descriptor */
+#endif
+
+public:
+    /**
+     * @brief Open and map a file.
+     * @param path Path of the puzzle file.
+     * @throw std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedPuzzleFile(const char* path);
+
+    /**
+     * @brief Unmap and close the file.
+     */
+    ~MappedPuzzleFile();
+
+    /**
+     * @brief Delete copy constructor; the mapping has a single owner.
+     */
+    MappedPuzzleFile(const MappedPuzzleFile& other) = delete;
+
+    /**
+     * @brief Delete copy assignment operator; the mapping has a single owner.
+     */
+    MappedPuzzleFile& operator=(const MappedPuzzleFile& other) = delete;
+
+    /**
+     * @brief Get the mapped bytes.
+     * @return Pointer to the first byte, or nullptr for an empty file.
+     */
+    const char* getData() const;
+
+    /**
+     * @brief Get the size of the mapping.
+     * @return Number of bytes in the file.
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief Get the whole file as a single chunk.
+     * @return Chunk covering all mapped bytes.
+     */
+    PuzzleChunk whole() const;
+
+    /**
+     * @brief Split the file into roughly equal chunks that can be parsed independently.
+     *
+     * Split points are moved forward to the next line start. If that line is a row of a
+     * 9-line block, the split point is moved further to the first line that is not such a
+     * row, so a block is never cut in half. Files made of blocks without separator lines
+     * therefore yield fewer, larger chunks. Empty chunks are dropped.
+     *
+     * @param chunkCount Desired number of chunks (at least 1).
+     * @return Chunks in file order; together they cover the whole file.
+     */
+    std::vector<PuzzleChunk> split(size_t chunkCount) const;
+};
+
+/**
+ * @class PuzzleChunkReader
+ * @brief Reads puzzles from a chunk of mapped bytes, in the same layouts as PuzzleReader.
+ */
+class PuzzleChunkReader {
+private:
+    const char* pos;          /**< Start of the next unread line */
+    const char* end;          /**< End of the chunk */
+    PuzzleLineParser parser;  /**< Line parser shared with PuzzleReader */
+    ulli lineNumber;          /**< Number of lines consumed, relative to the chunk start */
+
+public:
+    /**
+     * @brief Constructor. Reading starts at the beginning of the chunk.
+     * @param chunk Byte range to parse.
+     */
+    explicit PuzzleChunkReader(PuzzleChunk chunk);
+
+    /**
+     * @brief Read the next puzzle directly into bitset form.
+     * @param data Receives the candidate bits, as produced by SudokuBoard::parseData().
+     * @return true if a puzzle was read; false at the end of the chunk.
+     * @throw std::runtime_error on a line of the wrong length or a malformed or truncated 9-line block.
+     */
+    bool next(std::array<ulli, 12>& data);
+
+    /**
+     * @brief Get how many lines of the chunk have been consumed.
+     * @return Line number of the last line read, relative to the chunk (1-based).
+     */
+    ulli getLineNumber() const;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * @file
+ * @brief Build switch for compiling the search entry points once per x86-64 level.
+ */
+
+/**
+ * @def SUDOKU_MULTIVERSIONED
+ * @brief Compile a hot function once per x86-64 level and pick the copy for the CPU at load time.
+ *
+ * With SUDOKU_MULTIVERSION (set by the build on x86-64 ELF targets with GCC or Clang), the
+ * function gets an x86-64-v4 (AVX-512), an x86-64-v3 (AVX2, BMI2, FMA) and a baseline clone,
+ * and the dynamic loader binds calls to the best one the CPU supports. Everything the function
+ * calls within its translation unit is inlined into it (flatten), so the search loop, the
+ * propagation and the popcounts of those clones are compiled for the clone's level too.
+ * Functions defined in another .cpp file stay baseline calls, which is why the board steps of
+ * the search (chooseBranch(), findMRVCell(), makeSureAt(), ...) are defined in SudokuBoard.h.
+ * Elsewhere it expands to nothing; ARM64 always has NEON, which the baseline code uses.
+ *
+ * Only use it on file-local (static) functions: a multiversioned member or extern function
+ * makes its declaration in a header disagree with its definition, which LTO reports as an
+ * ODR violation, and callers in other files would bind to the local clones.
+ */
+#if defined(SUDOKU_MULTIVERSION) && (defined(__x86_64__) || defined(_M_X64)) && defined(__ELF__) && defined(__GNUC__)
+#define SUDOKU_MULTIVERSIONED __attribute__((flatten, target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define SUDOKU_MULTIVERSIONED
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @file
+ * @brief Packed form of a 9x9 puzzle or solution: one 4-bit nibble per cell, 41 bytes in all.
+ *
+ * Cell i (row-major) is stored in byte i / 2, in the low nibble for even i and in the high
+ * nibble for odd i. Nibble 0 is an empty cell and 1..9 a value; the unused high nibble of the
+ * last byte is 0. This is half the size of the 81-character text form and needs no separators,
+ * so a batch of puzzles is simply a run of 41-byte records. Plain C types are used so this
+ * header depends on nothing else.
+ */
+
+/** Bytes of one packed puzzle. */
+static const size_t NIBBLE_PUZZLE_BYTES = 41;
+
+/**
+ * @brief Pack an 81-character puzzle row into nibbles.
+ * @param cells 81 characters; '1'..'9' are values, anything else is an empty cell
+ *              (as in SudokuBoard::parseData()).
+ * @param out Receives NIBBLE_PUZZLE_BYTES bytes.
+ */
+inline void packNibbles(const char* cells, unsigned char* out) {
+    for (size_t i = 0; i < NIBBLE_PUZZLE_BYTES; i++)
+        out[i] = 0;
+    for (size_t i = 0; i < 81; i++) {
+        char c = cells[i];
+        unsigned nibble = (c >= '1' && c <= '9') ? (unsigned)(c - '0') : 0u;
+        out[i / 2] |= (unsigned char)(nibble << (i % 2 * 4));
+    }
+}
+
+/**
+ * @brief Unpack nibbles into an 81-character puzzle row.
+ * @param in NIBBLE_PUZZLE_BYTES packed bytes.
+ * @param cells Receives 81 characters: '1'..'9' for values, '.' for empty cells.
+ * @return false if a nibble is above 9 or the padding nibble is not 0; cells is then unspecified.
+ */
+inline bool unpackNibbles(const unsigned char* in, char* cells) {
+    if ((in[NIBBLE_PUZZLE_BYTES - 1] >> 4) != 0)
+        return false;
+    for (size_t i = 0; i < 81; i++) {
+        unsigned nibble = (in[i / 2] >> (i % 2 * 4)) & 0xFu;
+        if (nibble > 9)
+            return false;
+        cells[i] = nibble == 0 ? '.' : (char)('0' + nibble);
+    }
+    return true;
+}
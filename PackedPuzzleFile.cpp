@@ -0,0 +1,246 @@
+#include "PackedPuzzleFile.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/** Magic bytes starting a packed file. */
+static const unsigned char PACKED_MAGIC[4] = { 0x89, 'S', 'D', 'K' };
+
+static void putU32(unsigned char* out, ulli value) {
+    ui clamped = (ui)std::min<ulli>(value, 0xFFFFFFFFull);
+    for (ui i = 0; i < 4; i++)
+        out[i] = (unsigned char)(clamped >> (8 * i));
+}
+
+static ui getU32(const unsigned char* in) {
+    return (ui)in[0] | (ui)in[1] << 8 | (ui)in[2] << 16 | (ui)in[3] << 24;
+}
+
+size_t packedRecordBytes(uc flags) {
+    size_t bytes = NIBBLE_PUZZLE_BYTES;
+    if (flags & PACKED_SOLUTIONS)
+        bytes += NIBBLE_PUZZLE_BYTES;
+    if (flags & PACKED_STATS)
+        bytes += 12;
+    return bytes;
+}
+
+bool isPackedPuzzleData(const char* data, size_t size) {
+    return size >= sizeof(PACKED_MAGIC) && std::memcmp(data, PACKED_MAGIC, sizeof(PACKED_MAGIC)) == 0;
+}
+
+void writePackedHeader(uc flags, unsigned char* out) {
+    std::memcpy(out, PACKED_MAGIC, sizeof(PACKED_MAGIC));
+    out[4] = PACKED_VERSION;
+    out[5] = flags;
+    size_t bytes = packedRecordBytes(flags);
+    out[6] = (unsigned char)bytes;
+    out[7] = (unsigned char)(bytes >> 8);
+}
+
+uc readPackedHeader(const unsigned char* in) {
+    if (std::memcmp(in, PACKED_MAGIC, sizeof(PACKED_MAGIC)) != 0)
+        throw std::runtime_error("not a packed puzzle file");
+    if (in[4] != PACKED_VERSION)
+        throw std::runtime_error("unsupported packed puzzle file version " + std::to_string(in[4]));
+    uc flags = in[5];
+    if ((flags & ~(PACKED_SOLUTIONS | PACKED_STATS)) != 0)
+        throw std::runtime_error("unsupported packed puzzle file flags " + std::to_string(flags));
+    if ((size_t)(in[6] | in[7] << 8) != packedRecordBytes(flags))
+        throw std::runtime_error("packed puzzle file record size does not match its flags");
+    return flags;
+}
+
+/** Bit of PAIR_MASKS entries of bytes with a nibble above 9. */
+static const ui INVALID_PAIR = 1u << 31;
+
+/**
+ * Candidate masks of the two cells of a packed byte, side by side in 18 bits (low nibble
+ * first). As in SudokuBoard::parseData(), a given keeps a single bit and an empty cell all 9.
+ */
+static constexpr std::array<ui, 256> PAIR_MASKS = [] {
+    std::array<ui, 256> masks = {};
+    for (ui byte = 0; byte < 256; byte++) {
+        ui low = byte & 0xF, high = byte >> 4;
+        if (low > 9 || high > 9) {
+            masks[byte] = INVALID_PAIR;
+            continue;
+        }
+        ui lowMask = low != 0 ? 1u << (low - 1) : 0x1FFu;
+        ui highMask = high != 0 ? 1u << (high - 1) : 0x1FFu;
+        masks[byte] = lowMask | highMask << 9;
+    }
+    return masks;
+}();
+
+bool decodePackedPuzzle(const unsigned char* in, std::array<ulli, 12>& data) {
+    // Cells 2p and 2p+1 come from byte p and take bits 18p..18p+17
+    ui invalid = 0;
+    data = {};
+    for (ui p = 0; p < NIBBLE_PUZZLE_BYTES - 1; p++) {
+        ui pair = PAIR_MASKS[in[p]];
+        invalid |= pair;
+        ulli bits = pair & 0x3FFFFu;
+        ui bitIndex = p * 18u;
+        ui word = bitIndex / 64;
+        ui shift = bitIndex % 64;
+        data[word] |= bits << shift;
+        if (shift > 64 - 18)
+            data[word + 1] |= bits >> (64 - shift);
+    }
+    // The last byte holds cell 80 (bits 720..728) and a zero padding nibble
+    unsigned char last = in[NIBBLE_PUZZLE_BYTES - 1];
+    ui pair = PAIR_MASKS[last];
+    data[11] |= (ulli)(pair & 0x1FFu) << (720 % 64);
+    return ((invalid | pair) & INVALID_PAIR) == 0 && (last >> 4) == 0;
+}
+
+void encodePackedRecord(uc flags, const std::array<ulli, 12>& puzzle, const char* solution, const SolveStats& stats, unsigned char* out) {
+    // Cells with a single candidate are the givens
+    std::memset(out, 0, NIBBLE_PUZZLE_BYTES);
+    for (ui i = 0; i < 81; i++) {
+        ui bitIndex = i * 9u;
+        ui word = bitIndex / 64;
+        ui shift = bitIndex % 64;
+        ulli bits = puzzle[word] >> shift;
+        if (shift > 64 - 9)
+            bits |= puzzle[word + 1] << (64 - shift);
+        us mask = (us)(bits & 0x1FF);
+        if (std::has_single_bit(mask))
+            out[i / 2] |= (unsigned char)((std::countr_zero(mask) + 1) << (i % 2 * 4));
+    }
+    out += NIBBLE_PUZZLE_BYTES;
+    if (flags & PACKED_SOLUTIONS) {
+        // packNibbles() turns the '.' row of an unsolved puzzle into all zeros
+        if (solution != nullptr)
+            packNibbles(solution, out);
+        else
+            std::memset(out, 0, NIBBLE_PUZZLE_BYTES);
+        out += NIBBLE_PUZZLE_BYTES;
+    }
+    if (flags & PACKED_STATS) {
+        putU32(out, stats.assignments);
+        putU32(out + 4, stats.simplifications);
+        putU32(out + 8, stats.micros);
+    }
+}
+
+bool decodePackedRecord(uc flags, const unsigned char* in, PackedRecord& record) {
+    if (!decodePackedPuzzle(in, record.puzzle))
+        return false;
+    in += NIBBLE_PUZZLE_BYTES;
+    record.solved = false;
+    std::fill(record.solution, record.solution + 81, '.');
+    if (flags & PACKED_SOLUTIONS) {
+        if (!unpackNibbles(in, record.solution))
+            return false;
+        record.solved = std::find(record.solution, record.solution + 81, '.') == record.solution + 81;
+        if (!record.solved)
+            std::fill(record.solution, record.solution + 81, '.');
+        in += NIBBLE_PUZZLE_BYTES;
+    }
+    record.stats = SolveStats();
+    if (flags & PACKED_STATS) {
+        record.stats.assignments = getU32(in);
+        record.stats.simplifications = getU32(in + 4);
+        record.stats.micros = getU32(in + 8);
+    }
+    return true;
+}
+
+//======== PackedChunkReader ========
+
+PackedChunkReader::PackedChunkReader(PuzzleChunk chunk)
+    : pos((const unsigned char*)chunk.begin), end((const unsigned char*)chunk.end), flags(0), recordBytes(0), records(0) {
+    if ((size_t)(end - pos) < PACKED_HEADER_BYTES)
+        throw std::runtime_error("not a packed puzzle file");
+    flags = readPackedHeader(pos);
+    recordBytes = packedRecordBytes(flags);
+    pos += PACKED_HEADER_BYTES;
+}
+
+const unsigned char* PackedChunkReader::advance() {
+    if (pos == end)
+        return nullptr;
+    if ((size_t)(end - pos) < recordBytes) {
+        pos = end;
+        throw std::runtime_error("truncated packed record");
+    }
+    const unsigned char* record = pos;
+    pos += recordBytes;
+    records++;
+    return record;
+}
+
+bool PackedChunkReader::next(std::array<ulli, 12>& data) {
+    const unsigned char* record = advance();
+    if (record == nullptr)
+        return false;
+    if (!decodePackedPuzzle(record, data))
+        throw std::runtime_error("invalid packed puzzle");
+    return true;
+}
+
+bool PackedChunkReader::next(PackedRecord& record) {
+    const unsigned char* bytes = advance();
+    if (bytes == nullptr)
+        return false;
+    if (!decodePackedRecord(flags, bytes, record))
+        throw std::runtime_error("invalid packed record");
+    return true;
+}
+
+uc PackedChunkReader::getFlags() const {
+    return flags;
+}
+
+ulli PackedChunkReader::getLineNumber() const {
+    return records;
+}
+
+//======== PackedPuzzleReader ========
+
+PackedPuzzleReader::PackedPuzzleReader(std::istream& in) : in(in), flags(0), recordBytes(0), records(0), buffer() {
+    unsigned char header[PACKED_HEADER_BYTES];
+    if (!in.read((char*)header, PACKED_HEADER_BYTES))
+        throw std::runtime_error("not a packed puzzle file");
+    flags = readPackedHeader(header);
+    recordBytes = packedRecordBytes(flags);
+}
+
+bool PackedPuzzleReader::advance() {
+    in.read((char*)buffer, recordBytes);
+    if (in.gcount() == 0)
+        return false;
+    if ((size_t)in.gcount() < recordBytes)
+        throw std::runtime_error("truncated packed record");
+    records++;
+    return true;
+}
+
+bool PackedPuzzleReader::next(std::array<ulli, 12>& data) {
+    if (!advance())
+        return false;
+    if (!decodePackedPuzzle(buffer, data))
+        throw std::runtime_error("invalid packed puzzle");
+    return true;
+}
+
+bool PackedPuzzleReader::next(PackedRecord& record) {
+    if (!advance())
+        return false;
+    if (!decodePackedRecord(flags, buffer, record))
+        throw std::runtime_error("invalid packed record");
+    return true;
+}
+
+uc PackedPuzzleReader::getFlags() const {
+    return flags;
+}
+
+ulli PackedPuzzleReader::getLineNumber() const {
+    return records;
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "SolveStats.h"
+#include "MappedPuzzleFile.h"
+#include "NibbleCodec.h"
+
+#include <array>
+#include <istream>
+
+/**
+ * @file
+ * @brief Packed puzzle files: fixed-size records of 41-byte puzzles (see NibbleCodec.h) behind a small header.
+ *
+ * All integers are little-endian:
+ *
+ *     header: u8 magic[4] = 0x89 'S' 'D' 'K', u8 version (1), u8 flags, u16 record bytes
+ *     record: 41-byte puzzle
+ *             41-byte solution, all zero if there is none         (if flags has PACKED_SOLUTIONS)
+ *             u32 assignments, u32 simplifications, u32 micros     (if flags has PACKED_STATS)
+ *
+ * The first magic byte is not ASCII, which tells packed input apart from text puzzle files.
+ * Records have a fixed size, so a mapped file is read in place without any parsing, and a
+ * packed puzzle decodes straight into the bitset form of SudokuBoard(std::array<ulli,12>).
+ * The solver daemon (see SolverServer) sends the same 41-byte puzzles and solutions.
+ * "SudokuSolver --batch --pack" converts a text file; the batch and rate modes read either.
+ */
+
+/** Records also hold the solution of their puzzle. */
+static const uc PACKED_SOLUTIONS = 1;
+
+/** Records also hold the search counters of their puzzle. */
+static const uc PACKED_STATS = 2;
+
+/** Bytes of the file header. */
+static const size_t PACKED_HEADER_BYTES = 8;
+
+/** Format version written in the header. */
+static const uc PACKED_VERSION = 1;
+
+/** Largest record: puzzle, solution and counters. */
+static const size_t PACKED_MAX_RECORD_BYTES = 2 * NIBBLE_PUZZLE_BYTES + 12;
+
+/**
+ * @struct PackedRecord
+ * @brief One decoded record of a packed file.
+ */
+struct PackedRecord {
+    std::array<ulli, 12> puzzle;  /**< Candidate bits of the puzzle (see SudokuBoard::parseData()) */
+    bool solved;                  /**< Whether solution holds a solution (false without PACKED_SOLUTIONS) */
+    char solution[81];            /**< Solution cells '1'..'9', or 81 '.' */
+    SolveStats stats;             /**< Assignments, simplifications and micros (zero without PACKED_STATS) */
+};
+
+/**
+ * @brief Get the size of the records of a file.
+ * @param flags PACKED_SOLUTIONS and PACKED_STATS bits of the file.
+ * @return Bytes per record.
+ */
+size_t packedRecordBytes(uc flags);
+
+/**
+ * @brief Check whether bytes start like a packed file.
+ * @param data First bytes of a file.
+ * @param size Number of bytes available.
+ * @return true if the magic bytes are present.
+ */
+bool isPackedPuzzleData(const char* data, size_t size);
+
+/**
+ * @brief Write a file header.
+ * @param flags PACKED_SOLUTIONS and PACKED_STATS bits of the records.
+ * @param out Receives PACKED_HEADER_BYTES bytes.
+ */
+void writePackedHeader(uc flags, unsigned char* out);
+
+/**
+ * @brief Check a file header.
+ * @param in PACKED_HEADER_BYTES bytes.
+ * @return Flags of the file.
+ * @throw std::runtime_error if the magic, version, flags or record size are not supported.
+ */
+uc readPackedHeader(const unsigned char* in);
+
+/**
+ * @brief Decode a 41-byte puzzle straight into bitset form.
+ * @param in NIBBLE_PUZZLE_BYTES packed bytes.
+ * @param data Receives the candidate bits, as SudokuBoard::parseData() produces them.
+ * @return false if a nibble is above 9 or the padding nibble is not 0; data is then unspecified.
+ */
+bool decodePackedPuzzle(const unsigned char* in, std::array<ulli, 12>& data);
+
+/**
+ * @brief Encode a record.
+ * @param flags Flags of the file.
+ * @param puzzle Candidate bits of the puzzle; its cells with a single candidate are the givens.
+ * @param solution 81 solution cells ('.' rows are stored as no solution), or nullptr for none.
+ * @param stats Counters of the puzzle; values above 2^32 - 1 are clamped.
+ * @param out Receives packedRecordBytes(flags) bytes.
+ */
+void encodePackedRecord(uc flags, const std::array<ulli, 12>& puzzle, const char* solution, const SolveStats& stats, unsigned char* out);
+
+/**
+ * @brief Decode a record.
+ * @param flags Flags of the file.
+ * @param in packedRecordBytes(flags) bytes.
+ * @param record Receives the record.
+ * @return false if the puzzle or solution is not a valid packed puzzle.
+ */
+bool decodePackedRecord(uc flags, const unsigned char* in, PackedRecord& record);
+
+/**
+ * @class PackedChunkReader
+ * @brief Reads the records of a packed file in place from mapped bytes.
+ */
+class PackedChunkReader {
+private:
+    const unsigned char* pos;  /**< Next unread record */
+    const unsigned char* end;  /**< End of the chunk */
+    uc flags;                  /**< Flags of the file */
+    size_t recordBytes;        /**< Bytes per record */
+    ulli records;              /**< Records read so far */
+
+    /**
+     * @brief Advance to the next record.
+     * @return The record, or nullptr at the end of the chunk.
+     * @throw std::runtime_error if the chunk ends inside a record.
+     */
+    const unsigned char* advance();
+
+public:
+    /**
+     * @brief Constructor; checks the header at the start of the chunk.
+     * @param chunk Bytes of the whole file (see MappedPuzzleFile::whole()).
+     * @throw std::runtime_error if the header is missing or not supported.
+     */
+    explicit PackedChunkReader(PuzzleChunk chunk);
+
+    /**
+     * @brief Read the next puzzle.
+     * @param data Receives the candidate bits, as produced by SudokuBoard::parseData().
+     * @return true if a puzzle was read; false at the end of the chunk.
+     * @throw std::runtime_error on a truncated record or an invalid packed puzzle.
+     */
+    bool next(std::array<ulli, 12>& data);
+
+    /**
+     * @brief Read the next record with its solution and counters.
+     * @param record Receives the record.
+     * @return true if a record was read; false at the end of the chunk.
+     * @throw std::runtime_error on a truncated or invalid record.
+     */
+    bool next(PackedRecord& record);
+
+    /**
+     * @brief Get the flags of the file.
+     * @return PACKED_SOLUTIONS and PACKED_STATS bits.
+     */
+    uc getFlags() const;
+
+    /**
+     * @brief Get how many records have been read, reported by the batch mode in place of a line number.
+     * @return Number of the last record read (1-based).
+     */
+    ulli getLineNumber() const;
+};
+
+/**
+ * @class PackedPuzzleReader
+ * @brief Reads the records of a packed file one by one from a std::istream (file or stdin).
+ */
+class PackedPuzzleReader {
+private:
+    std::istream& in;                                 /**< Source stream */
+    uc flags;                                         /**< Flags of the file */
+    size_t recordBytes;                               /**< Bytes per record */
+    ulli records;                                     /**< Records read so far */
+    unsigned char buffer[PACKED_MAX_RECORD_BYTES];    /**< The record being read */
+
+    /**
+     * @brief Read the next record into buffer.
+     * @return false at the end of the stream.
+     * @throw std::runtime_error if the stream ends inside a record.
+     */
+    bool advance();
+
+public:
+    /**
+     * @brief Constructor; reads and checks the header.
+     * @param in Stream positioned at the start of a packed file.
+     * @throw std::runtime_error if the header is missing or not supported.
+     */
+    explicit PackedPuzzleReader(std::istream& in);
+
+    /**
+     * @brief Read the next puzzle.
+     * @param data Receives the candidate bits, as produced by SudokuBoard::parseData().
+     * @return true if a puzzle was read; false at the end of input.
+     * @throw std::runtime_error on a truncated record or an invalid packed puzzle.
+     */
+    bool next(std::array<ulli, 12>& data);
+
+    /**
+     * @brief Read the next record with its solution and counters.
+     * @param record Receives the record.
+     * @return true if a record was read; false at the end of input.
+     * @throw std::runtime_error on a truncated or invalid record.
+     */
+    bool next(PackedRecord& record);
+
+    /**
+     * @brief Get the flags of the file.
+     * @return PACKED_SOLUTIONS and PACKED_STATS bits.
+     */
+    uc getFlags() const;
+
+    /**
+     * @brief Get how many records have been read, reported by the batch mode in place of a line number.
+     * @return Number of the last record read (1-based).
+     */
+    ulli getLineNumber() const;
+};
@@ -0,0 +1,131 @@
+#include "ParallelSearch.h"
+
+#include <atomic>
+#include <vector>
+#include <array>
+#include <bit>
+#include <algorithm>
+#include <mutex>
+
+ParallelSearch::ParallelSearch(WorkStealingPool& pool, ui splitDepth, RuleTier rules, BranchStrategy branching)
+    : pool(pool), splitDepth(splitDepth), rules(rules), branching(branching), limit(1), cancelled(false), solutions(0),
+      solution(), perWorker(pool.getThreadCount()) {}
+
+void ParallelSearch::recordSolutions(const std::array<ulli, 12>& first, ulli count) {
+    ulli before = solutions.load();
+    // Count the solutions unless the limit was reached concurrently
+    while (before < limit && !solutions.compare_exchange_weak(before, std::min(limit, before + count))) {}
+    if (before >= limit)
+        return;
+    if (before == 0) {
+        std::lock_guard<std::mutex> lock(solutionMutex);
+        solution = first;
+    }
+    if (before + count >= limit)
+        cancelled.store(true);
+}
+
+void ParallelSearch::spawn(SearchArena& arena, const std::array<ulli, 12>& data, ui depth) {
+    // Two pointers fit the task's inline storage, so only the arena holds the board
+    Branch* branch = arena.create<Branch>(Branch{ data, depth });
+    pool.submit([this, branch](ui worker) {
+        if (cancelled.load(std::memory_order_relaxed))
+            return;
+        SudokuBoard board(branch->data);
+        board.setRuleTier(rules);
+        if (branch->depth < splitDepth)
+            expand(board, branch->depth, perWorker[worker]);
+        else
+            searchSubtree(board, perWorker[worker]);
+    });
+}
+
+void ParallelSearch::expand(SudokuBoard& board, ui depth, WorkerStats& worker) {
+    SolveStats& stats = worker.stats;
+
+    // Same propagation step as dfsSolve, counting rounds instead of tracing them
+    StatsListener listener(stats);
+    ulli totalEliminations;
+    if (!board.propagate(totalEliminations, listener))
+        return;
+
+    if (board.isSolved()) {
+        recordSolutions(board.copyData(), 1);
+        return;
+    }
+
+    auto [pos, count] = board.findMRVCell();
+    if (count == 0)
+        return;
+
+    // Every branch becomes its own task on its own board copy
+    std::array<ulli, 12> history = board.copyData();
+    for (us mask = board.getCandidateMaskAt(pos); mask != 0; mask &= mask - 1) {
+        uc v = (uc)(std::countr_zero(mask) + 1);
+        if (cancelled.load(std::memory_order_relaxed))
+            return;
+        stats.assignments++;
+        SudokuBoard child(history);
+        child.makeSureAt(pos, v, false);
+        spawn(worker.arena, child.copyData(), depth + 1);
+    }
+}
+
+void ParallelSearch::searchSubtree(SudokuBoard& board, WorkerStats& worker) {
+    // The shared flag is the subtrees' cancellation token
+    StatsListener listener(worker.stats);
+    SolveBudget budget = { 0, 0, &cancelled };
+    board.setBranchStrategy(branching);
+    if (limit == 1) {
+        bool assigned[81] = {};
+        if (board.solveWithin(budget, assigned, listener) == SOLVE_SOLVED)
+            recordSolutions(board.copyData(), 1);
+        return;
+    }
+    // Solutions found before a cancellation are still solutions
+    SolutionCount count = board.countSolutionsWithin(limit, budget, listener);
+    if (count.solutions > 0)
+        recordSolutions(count.firstSolution, count.solutions);
+}
+
+ParallelSearchResult ParallelSearch::search(const std::array<ulli, 12>& data, ulli limit) {
+    this->limit = limit == 0 ? 1 : limit;
+
+    if (splitDepth == 0) {
+        // Nothing to split: run the sequential counter on this thread
+        ParallelSearchResult result;
+        result.stats = SolveStats();
+        StatsListener listener(result.stats);
+        SudokuBoard board(data);
+        board.setRuleTier(rules);
+        board.setBranchStrategy(branching);
+        SolutionCount count = board.countSolutions(this->limit, listener);
+        result.solutions = count.solutions;
+        result.solution = count.firstSolution;
+        result.stats.puzzles = 1;
+        result.stats.solved = result.solutions > 0 ? 1 : 0;
+        return result;
+    }
+
+    cancelled.store(false);
+    solutions.store(0);
+    solution = std::array<ulli, 12>();
+    for (WorkerStats& w : perWorker) {
+        w.stats = SolveStats();
+        w.arena.reset();
+    }
+
+    // No task runs yet, so the root may use the first worker's arena
+    spawn(perWorker[0].arena, data, 0);
+    pool.wait();
+
+    ParallelSearchResult result;
+    result.solutions = solutions.load();
+    result.solution = solution;
+    result.stats = SolveStats();
+    for (const WorkerStats& w : perWorker)
+        mergeSolveStats(result.stats, w.stats);
+    result.stats.puzzles = 1;
+    result.stats.solved = result.solutions > 0 ? 1 : 0;
+    return result;
+}
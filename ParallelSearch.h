@@ -0,0 +1,131 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "SolveStats.h"
+#include "SearchArena.h"
+#include "WorkStealingPool.h"
+
+#include <atomic>
+#include <vector>
+#include <array>
+#include <mutex>
+
+/**
+ * @struct ParallelSearchResult
+ * @brief Outcome of ParallelSearch::search().
+ */
+struct ParallelSearchResult {
+    ulli solutions;                 /**< Number of solutions found, at most the requested limit */
+    std::array<ulli, 12> solution;  /**< Bitset of the first solution found (valid if solutions > 0) */
+    SolveStats stats;               /**< Assignments and simplification passes over all workers */
+};
+
+/**
+ * @class ParallelSearch
+ * @brief Opt-in DFS that splits the search tree of one puzzle across a thread pool.
+ *
+ * The top splitDepth levels of the tree are expanded here (propagate, MRV cell, one branch
+ * per candidate), and every branch becomes a pool task with its own copy of the board. A
+ * task at splitDepth searches its whole subtree with SudokuBoard::solveWithin() (or
+ * countSolutionsWithin() for a limit above 1), so the subtrees get the iterative search, the
+ * trail, the branching strategy and the budget checks of the sequential solver. The shared
+ * cancellation flag is the token of their budget: once the solution limit is reached, every
+ * running subtree stops within BUDGET_CHECK_INTERVAL nodes. With several workers the "first"
+ * solution is the first one any worker finds, which may differ from the sequential dfsSolve
+ * result.
+ *
+ * The board of a spawned branch lives in the spawning worker's SearchArena and the task only
+ * holds a pointer to it, so spawning does not heap-allocate a task closure. The arenas are
+ * reset when the next search starts and keep their memory, so a batch of puzzles reuses it.
+ */
+class ParallelSearch {
+private:
+    /**
+     * @struct WorkerStats
+     * @brief Per-worker statistics, padded to a cache line to avoid false sharing.
+     */
+    struct alignas(64) WorkerStats {
+        SolveStats stats;   /**< Counters of the nodes this worker expanded */
+        SearchArena arena;  /**< Boards of the branches this worker spawned */
+    };
+
+    /**
+     * @struct Branch
+     * @brief A spawned branch: the board state to expand and its depth.
+     */
+    struct Branch {
+        std::array<ulli, 12> data;  /**< Bitset of the branch's board */
+        ui depth;                   /**< Depth of the branch */
+    };
+
+    WorkStealingPool& pool;  /**< Pool running the branch tasks */
+    ui splitDepth;           /**< Branches at depth < splitDepth are spawned as tasks */
+    RuleTier rules;          /**< Strongest propagation rules of every board */
+    BranchStrategy branching;  /**< Branching strategy of the subtree searches */
+
+    ulli limit;                               /**< Stop after this many solutions */
+    std::atomic<bool> cancelled;              /**< Set once the limit is reached */
+    std::atomic<ulli> solutions;              /**< Solutions found so far (capped at limit) */
+    std::mutex solutionMutex;                 /**< Guards solution */
+    std::array<ulli, 12> solution;            /**< First solution recorded */
+    std::vector<WorkerStats> perWorker;       /**< Statistics and arena of each worker */
+
+    /**
+     * @brief Record solutions found by a worker; cancels the search once the limit is reached.
+     * @param first Bitset of the first of them.
+     * @param count Number of solutions found.
+     */
+    void recordSolutions(const std::array<ulli, 12>& first, ulli count);
+
+    /**
+     * @brief Expand one node above splitDepth.
+     *
+     * Propagates the board, then branches on the MRV cell and submits every branch as a
+     * new task.
+     *
+     * @param board Board of this node; modified in place.
+     * @param depth Number of branch decisions above this node (less than splitDepth).
+     * @param worker Counters and arena of the worker running the node.
+     */
+    void expand(SudokuBoard& board, ui depth, WorkerStats& worker);
+
+    /**
+     * @brief Search the whole subtree of a node at splitDepth with the sequential solver.
+     * @param board Board of the node.
+     * @param worker Counters of the worker running the subtree.
+     */
+    void searchSubtree(SudokuBoard& board, WorkerStats& worker);
+
+    /**
+     * @brief Submit a task that expands the given board state.
+     * @param arena Arena of the calling worker, to store the branch in.
+     * @param data Bitset of the node's board.
+     * @param depth Depth of the node.
+     */
+    void spawn(SearchArena& arena, const std::array<ulli, 12>& data, ui depth);
+
+public:
+    /**
+     * @brief Constructor.
+     * @param pool Pool to run branch tasks on; must outlive the search.
+     * @param splitDepth Number of tree levels whose branches are run as separate tasks
+     *                   (0 searches the whole tree with SudokuBoard::countSolutions() on the
+     *                   calling thread).
+     * @param rules Strongest propagation rules to search with.
+     * @param branching Branching strategy of the subtrees below splitDepth (the split
+     *                  levels always branch on the MRV cell).
+     */
+    ParallelSearch(WorkStealingPool& pool, ui splitDepth, RuleTier rules = RULES_SINGLES, BranchStrategy branching = BRANCH_MRV);
+
+    /**
+     * @brief Search solutions of a puzzle, stopping once limit solutions are found.
+     *
+     * Blocks until the search is finished or cancelled. Must not be called from a
+     * worker thread of the pool.
+     *
+     * @param data Candidate bits of the puzzle.
+     * @param limit Maximum number of solutions to find (1 = solve, 2 = uniqueness check).
+     * @return Number of solutions, first solution and statistics.
+     */
+    ParallelSearchResult search(const std::array<ulli, 12>& data, ulli limit);
+};
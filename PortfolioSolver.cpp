@@ -0,0 +1,126 @@
+#include "PortfolioSolver.h"
+#include "Multiversion.h"
+
+#include <condition_variable>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <array>
+
+/** Command line names of the engines, indexed by SolverEngine. */
+static const char* const SOLVER_ENGINE_NAMES[3] = { "bitset", "dlx", "portfolio" };
+
+const char* solverEngineName(SolverEngine engine) {
+    return SOLVER_ENGINE_NAMES[engine];
+}
+
+bool parseSolverEngine(const char* name, SolverEngine& engine) {
+    for (int i = 0; i < 3; i++) {
+        if (std::strcmp(name, SOLVER_ENGINE_NAMES[i]) == 0) {
+            engine = (SolverEngine)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Whether a search outcome answers the puzzle.
+ * @param status Outcome of a search.
+ * @return true for SOLVE_SOLVED and SOLVE_NO_SOLUTION.
+ */
+static bool isAnswer(SolveStatus status) {
+    return status == SOLVE_SOLVED || status == SOLVE_NO_SOLUTION;
+}
+
+/**
+ * @brief Bitset side of a race, multiversioned (see SUDOKU_MULTIVERSIONED).
+ * @param board Board to solve.
+ * @param budget Limits of the search, including the race's cancellation token.
+ * @param stats Receives the assignments and simplifications.
+ * @return Outcome of the search.
+ */
+SUDOKU_MULTIVERSIONED static SolveStatus solveBoard(SudokuBoard& board, const SolveBudget& budget, SolveStats& stats) {
+    bool assigned[81] = {};
+    StatsListener listener(stats);
+    return board.solveWithin(budget, assigned, listener);
+}
+
+PortfolioSolver::PortfolioSolver()
+    : cover(std::array<ulli, 12>()), puzzle(), coverBudget(), coverStats(), coverStatus(SOLVE_NO_SOLUTION),
+      boardStop(false), coverStop(false), started(false), finished(false), stopping(false) {
+    helper = std::thread([this] { run(); });
+}
+
+PortfolioSolver::~PortfolioSolver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCv.notify_one();
+    helper.join();
+}
+
+void PortfolioSolver::run() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCv.wait(lock, [this] { return started || stopping; });
+            if (stopping)
+                return;
+            started = false;
+        }
+
+        cover.load(puzzle);
+        coverStats = SolveStats();
+        coverStatus = cover.solveWithin(coverBudget, coverStats);
+        if (isAnswer(coverStatus))
+            boardStop.store(true, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        doneCv.notify_one();
+    }
+}
+
+SolveStatus PortfolioSolver::race(SudokuBoard& board, const std::array<ulli, 12>& data, SolveStats& stats, const SolveBudget* budget) {
+    SolveBudget boardBudget = { 0, 0, &boardStop };
+    if (budget != nullptr) {
+        boardBudget.maxNodes = budget->maxNodes;
+        boardBudget.maxMicros = budget->maxMicros;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        puzzle = data;
+        coverBudget = { boardBudget.maxNodes, boardBudget.maxMicros, &coverStop };
+        boardStop.store(false, std::memory_order_relaxed);
+        coverStop.store(false, std::memory_order_relaxed);
+        started = true;
+    }
+    startCv.notify_one();
+
+    SolveStatus status = solveBoard(board, boardBudget, stats);
+    if (isAnswer(status))
+        coverStop.store(true, std::memory_order_relaxed);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCv.wait(lock, [this] { return finished; });
+        finished = false;
+    }
+    mergeSolveStats(stats, coverStats);
+
+    if (isAnswer(status))
+        return status;
+    if (isAnswer(coverStatus)) {
+        // The exact cover search won; the board was rolled back, so load its answer
+        if (coverStatus == SOLVE_SOLVED)
+            board = SudokuBoard(cover.copyData());
+        return coverStatus;
+    }
+    // Neither engine was cancelled by the other, so both ran out of budget
+    return SOLVE_BUDGET_EXCEEDED;
+}
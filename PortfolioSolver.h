@@ -0,0 +1,104 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "ExactCoverSolver.h"
+#include "SolveStats.h"
+
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <array>
+
+/**
+ * @enum SolverEngine
+ * @brief Search engine of the batch solver.
+ */
+enum SolverEngine {
+    ENGINE_BITSET = 0,       /**< SudokuBoard: candidate propagation and chooseBranch() branching */
+    ENGINE_EXACT_COVER = 1,  /**< ExactCoverSolver: Algorithm X with dancing links */
+    ENGINE_PORTFOLIO = 2     /**< Both at once on every puzzle; the first to finish wins (see PortfolioSolver) */
+};
+
+/**
+ * @brief Get the command line name of an engine.
+ * @param engine Search engine.
+ * @return "bitset", "dlx" or "portfolio".
+ */
+const char* solverEngineName(SolverEngine engine);
+
+/**
+ * @brief Parse an engine name as written by solverEngineName().
+ * @param name Name to parse.
+ * @param engine Receives the engine.
+ * @return false if the name is unknown.
+ */
+bool parseSolverEngine(const char* name, SolverEngine& engine);
+
+/**
+ * @class PortfolioSolver
+ * @brief Races the bitset search and the exact cover search on each puzzle.
+ *
+ * The two engines are slow on different puzzles, so running both and keeping the first
+ * answer bounds a puzzle by the faster of them. The bitset search runs on the calling thread
+ * and ExactCoverSolver on a helper thread owned by this object, which sleeps between puzzles.
+ * Each engine is given a cancellation token that the other sets once it has an answer, so
+ * the loser stops within BUDGET_CHECK_INTERVAL nodes. Statistics of both searches are
+ * counted, so assignments measure all the work done.
+ *
+ * If both engines finish, the bitset result is kept; for a puzzle with several solutions
+ * either engine's solution may be returned. One object serves one calling thread at a time.
+ */
+class PortfolioSolver {
+private:
+    ExactCoverSolver cover;              /**< Engine of the helper thread */
+    std::array<ulli, 12> puzzle;         /**< Puzzle of the current race */
+    SolveBudget coverBudget;             /**< Limits of the helper's search; its token is coverStop */
+    SolveStats coverStats;               /**< Counters of the helper's search */
+    SolveStatus coverStatus;             /**< Outcome of the helper's search */
+    std::atomic<bool> boardStop;         /**< Set by the helper once it has an answer */
+    std::atomic<bool> coverStop;         /**< Set by the caller once it has an answer */
+
+    std::mutex mutex;                    /**< Guards started, finished and stopping */
+    std::condition_variable startCv;     /**< Signalled when a race starts or on shutdown */
+    std::condition_variable doneCv;      /**< Signalled when the helper's search is done */
+    bool started;                        /**< A race is waiting for the helper */
+    bool finished;                       /**< The helper's search of the race is done */
+    bool stopping;                       /**< Set by the destructor */
+    std::thread helper;                  /**< Runs the exact cover searches */
+
+    /**
+     * @brief Main loop of the helper thread.
+     */
+    void run();
+
+public:
+    /**
+     * @brief Constructor; starts the helper thread.
+     */
+    PortfolioSolver();
+
+    /**
+     * @brief Destructor; stops and joins the helper thread.
+     */
+    ~PortfolioSolver();
+
+    PortfolioSolver(const PortfolioSolver& other) = delete;
+    PortfolioSolver& operator=(const PortfolioSolver& other) = delete;
+
+    /**
+     * @brief Solve a puzzle with both engines and keep the first answer.
+     *
+     * The node and time limits of budget apply to each engine on its own; its cancellation
+     * token is not consulted, since each engine's token is taken by the race.
+     *
+     * @param board Board of the puzzle, set up with the rules, branching and table of the
+     *              bitset search; receives the solution, whichever engine found it.
+     * @param data Candidate bits of the puzzle, for the exact cover search.
+     * @param stats Receives the assignments and simplifications of both searches.
+     * @param budget Node and time limits of each search, or nullptr for none.
+     * @return SOLVE_SOLVED or SOLVE_NO_SOLUTION from the first engine to finish, or
+     *         SOLVE_BUDGET_EXCEEDED if both ran out of budget.
+     */
+    SolveStatus race(SudokuBoard& board, const std::array<ulli, 12>& data, SolveStats& stats, const SolveBudget* budget);
+};
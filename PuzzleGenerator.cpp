@@ -0,0 +1,206 @@
+#include "PuzzleGenerator.h"
+
+#include <algorithm>
+#include <vector>
+#include <array>
+
+/**
+ * @brief Scramble a seed with the splitmix64 finalizer, so consecutive seeds give unrelated streams.
+ * @param seed Any value.
+ * @return Mixed value, never 0.
+ */
+static ulli mixSeed(ulli seed) {
+    seed += 0x9E3779B97F4A7C15ULL;
+    seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+    seed ^= seed >> 31;
+    return seed != 0 ? seed : 1;
+}
+
+/**
+ * @brief Advance a xorshift64 generator.
+ * @param state Generator state, never 0.
+ * @return Next pseudo-random number.
+ */
+static ulli nextRandom(ulli& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/**
+ * @struct RatingListener
+ * @brief Listener policy counting search nodes and events by cause, for ratePuzzle().
+ */
+struct RatingListener : NullSolveListener {
+    PuzzleRating& rating;  /**< Receives the nodes and eliminations */
+    ulli nodes;            /**< Search nodes entered */
+
+    explicit RatingListener(PuzzleRating& rating) : rating(rating), nodes(0) {}
+
+    void onNode(const SearchPath& path) {
+        nodes++;
+    }
+    void onEliminate(const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by) {
+        rating.eliminations[cause - NO_PLACE_POSSIBLE]++;
+    }
+    void onEliminate(SimplificationCause cause, const GPos& cell, uc value, uc by) {
+        rating.eliminations[cause - NO_PLACE_POSSIBLE]++;
+    }
+};
+
+PuzzleRating ratePuzzle(const std::array<ulli, 12>& data) {
+    PuzzleRating rating = PuzzleRating();
+    SudokuBoard givens(data);
+    for (ui y = 0; y < 9; y++)
+        for (ui x = 0; x < 9; x++)
+            rating.givens += givens.getPossiblesCountAt(GPos((uc)x, (uc)y)) == 1;
+
+    // Logic alone: propagation either solves, contradicts, or stalls
+    for (int t = RULES_SINGLES; t <= RULES_TRIPLES; t++) {
+        std::fill(rating.eliminations, rating.eliminations + SIMPLIFICATION_CAUSE_COUNT, 0ULL);
+        SudokuBoard board(data);
+        board.setRuleTier((RuleTier)t);
+        RatingListener listener(rating);
+        ulli eliminations = 0;
+        bool consistent = board.propagate(eliminations, listener);
+        if (!consistent || board.isSolved()) {
+            rating.solutions = consistent ? 1 : 0;
+            rating.tier = (RuleTier)t;
+            return rating;
+        }
+    }
+
+    // Guessing needed: count the nodes of the whole proof of uniqueness
+    std::fill(rating.eliminations, rating.eliminations + SIMPLIFICATION_CAUSE_COUNT, 0ULL);
+    SudokuBoard board(data);
+    board.setRuleTier(RULES_TRIPLES);
+    RatingListener listener(rating);
+    rating.solutions = board.countSolutions(2, listener).solutions;
+    rating.tier = RULES_TRIPLES;
+    rating.needsSearch = true;
+    rating.branches = listener.nodes - 1;
+    return rating;
+}
+
+SimplificationCause hardestCause(const PuzzleRating& rating) {
+    // Contradictions (the two negative causes) say nothing about the rules needed
+    for (ui i = SIMPLIFICATION_CAUSE_COUNT; i-- > (ui)(1 - NO_PLACE_POSSIBLE);) {
+        if (rating.eliminations[i] != 0)
+            return (SimplificationCause)((int)i + NO_PLACE_POSSIBLE);
+    }
+    return (SimplificationCause)0;
+}
+
+void mergeGenerateStats(GenerateStats& into, const GenerateStats& from) {
+    into.puzzles += from.puzzles;
+    into.givens += from.givens;
+    into.checks += from.checks;
+}
+
+PuzzleGenerator::PuzzleGenerator(WorkStealingPool& pool, RuleTier rules) : pool(pool), rules(rules) {}
+
+void PuzzleGenerator::fillGrid(ulli seed, char* grid) {
+    SudokuBoard board;
+    board.setBranchStrategy(BRANCH_RANDOM_RESTART);
+    board.setRandomSeed(mixSeed(seed));
+    bool assigned[81] = {};
+    board.dfsSolve(assigned);
+    board.writeValues(grid);
+}
+
+bool PuzzleGenerator::uniqueWithout(const char* puzzle, ui cell, RuleTier rules) {
+    char cells[81];
+    std::copy(puzzle, puzzle + 81, cells);
+    cells[cell] = '.';
+    // Any solution without the clue's value is a second one
+    SudokuBoard board(SudokuBoard::parseData(cells));
+    board.setRuleTier(rules);
+    board.setPossibleAt(GPos((uc)(cell % 9), (uc)(cell / 9)), (uc)(puzzle[cell] - '0'), false);
+    return board.countSolutions(1).solutions == 0;
+}
+
+/**
+ * @brief Fill the full grid of a seed and the random order its clues are tried in.
+ * @param seed Seed of the puzzle.
+ * @param grid Receives the 81 digits of the solution.
+ * @param order Receives a permutation of the 81 cells.
+ */
+static void startPuzzle(ulli seed, char* grid, std::array<uc, 81>& order) {
+    PuzzleGenerator::fillGrid(seed, grid);
+    ulli random = mixSeed(~seed);
+    for (ui i = 0; i < 81; i++)
+        order[i] = (uc)i;
+    for (ui i = 80; i > 0; i--)
+        std::swap(order[i], order[nextRandom(random) % (i + 1)]);
+}
+
+void PuzzleGenerator::generateOne(ulli seed, char* out, GenerateStats& stats, RuleTier rules) {
+    std::array<uc, 81> order;
+    startPuzzle(seed, out, order);
+    ui givens = 81;
+    for (ui i = 0; i < 81; i++) {
+        stats.checks++;
+        if (uniqueWithout(out, order[i], rules)) {
+            out[order[i]] = '.';
+            givens--;
+        }
+    }
+    stats.puzzles++;
+    stats.givens += givens;
+}
+
+GenerateStats PuzzleGenerator::generate(ulli seed, char* out) {
+    GenerateStats stats = GenerateStats();
+    std::array<uc, 81> order;
+    startPuzzle(seed, out, order);
+    ui window = std::max(pool.getThreadCount(), 1u);
+    std::vector<char> unique(window);
+    ui givens = 81;
+
+    ui next = 0;
+    while (next < 81) {
+        ui count = std::min(window, 81 - next);
+        for (ui k = 0; k < count; k++) {
+            pool.submit([this, out, &order, &unique, next, k](ui worker) {
+                unique[k] = uniqueWithout(out, order[next + k], rules);
+            });
+        }
+        pool.wait();
+        stats.checks += count;
+
+        // Failures before the first removal stay clues; checks after it saw the old puzzle
+        ui k = 0;
+        while (k < count && !unique[k])
+            k++;
+        if (k < count) {
+            out[order[next + k]] = '.';
+            givens--;
+        }
+        next += std::min(k + 1, count);
+    }
+    stats.puzzles = 1;
+    stats.givens = givens;
+    return stats;
+}
+
+GenerateStats PuzzleGenerator::generateBatch(size_t count, ulli firstSeed, char* out) {
+    std::vector<WorkerStats> perWorker(pool.getThreadCount());
+    for (WorkerStats& w : perWorker)
+        w.stats = GenerateStats();
+
+    for (size_t i = 0; i < count; i++) {
+        pool.submit([this, &perWorker, out, firstSeed, i](ui worker) {
+            char* line = out + i * LINE_SIZE;
+            generateOne(firstSeed + i, line, perWorker[worker].stats, rules);
+            line[81] = '\n';
+        });
+    }
+    pool.wait();
+
+    GenerateStats total = GenerateStats();
+    for (const WorkerStats& w : perWorker)
+        mergeGenerateStats(total, w.stats);
+    return total;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "WorkStealingPool.h"
+
+#include <vector>
+#include <array>
+
+/**
+ * @struct PuzzleRating
+ * @brief Outcome of ratePuzzle(): what it takes to solve a puzzle.
+ *
+ * The puzzle is first propagated with each rule tier in turn, weakest first; the first tier
+ * that solves it without guessing is its tier. A puzzle no tier solves is searched with
+ * RULES_TRIPLES propagation at every node, and branches counts the search nodes below the
+ * root needed to find its solutions and prove there are no more.
+ */
+struct PuzzleRating {
+    ui givens;           /**< Number of givens */
+    ulli solutions;      /**< 0 (no solution or contradicting givens), 1, or 2 for more than one */
+    RuleTier tier;       /**< Weakest tier solving by propagation alone; RULES_TRIPLES if needsSearch */
+    bool needsSearch;    /**< No tier solves the puzzle without branching */
+    ulli branches;       /**< Search nodes below the root (0 unless needsSearch) */
+    ulli eliminations[SIMPLIFICATION_CAUSE_COUNT];  /**< Events of the deciding run by cause, indexed by cause - NO_PLACE_POSSIBLE */
+};
+
+/**
+ * @brief Rate the difficulty of a puzzle (see PuzzleRating).
+ * @param data Candidate bits of the puzzle (see SudokuBoard::parseData()).
+ * @return Rating of the puzzle.
+ */
+PuzzleRating ratePuzzle(const std::array<ulli, 12>& data);
+
+/**
+ * @brief Strongest cause reported while rating, i.e. the hardest rule the puzzle needs.
+ * @param rating Rating of a puzzle.
+ * @return Cause with the largest value that occurred, or 0 (no cause) if there was none.
+ */
+SimplificationCause hardestCause(const PuzzleRating& rating);
+
+/**
+ * @struct GenerateStats
+ * @brief Counters of PuzzleGenerator runs.
+ */
+struct GenerateStats {
+    ulli puzzles;  /**< Puzzles generated */
+    ulli givens;   /**< Givens over all puzzles */
+    ulli checks;   /**< Uniqueness checks run, wasted speculative ones included */
+};
+
+/**
+ * @brief Add the counters of one record to another.
+ * @param into Record receiving the sums.
+ * @param from Record to add.
+ */
+void mergeGenerateStats(GenerateStats& into, const GenerateStats& from);
+
+/**
+ * @class PuzzleGenerator
+ * @brief Generates minimal unique puzzles: a random solution grid, thinned clue by clue.
+ *
+ * A puzzle of seed s starts from a full grid found by a randomized DFS of the empty board
+ * (BRANCH_RANDOM_RESTART seeded with s). Its cells are then visited in a random order, and
+ * each clue is removed if the puzzle stays unique without it. Removing clues never makes a
+ * failed removal succeed later, so every cell is checked once and the result is minimal:
+ * no single clue of it can be removed. The check for one clue of value v asks whether the
+ * puzzle with v ruled out of that cell still has a solution, a single search that fails
+ * early instead of a full count of two solutions.
+ *
+ * generate() checks several candidate removals of one puzzle at once across the pool, for
+ * the latency of a single puzzle; generateBatch() builds puzzles side by side, one per
+ * worker, for throughput. Both produce the same puzzle for the same seed, whatever the
+ * number of threads.
+ */
+class PuzzleGenerator {
+public:
+    /** Bytes written per puzzle: 81 cells and a newline. */
+    static const size_t LINE_SIZE = 82;
+
+private:
+    /**
+     * @struct WorkerStats
+     * @brief Per-worker statistics, padded to a cache line to avoid false sharing.
+     */
+    struct alignas(64) WorkerStats {
+        GenerateStats stats;  /**< Counters of the puzzles this worker generated */
+    };
+
+    WorkStealingPool& pool;  /**< Pool running the checks or puzzles */
+    RuleTier rules;          /**< Propagation rules of the uniqueness checks */
+
+public:
+    /**
+     * @brief Constructor.
+     * @param pool Pool to run on; must outlive the generator.
+     * @param rules Propagation rules of the uniqueness checks (the puzzles do not depend on them).
+     */
+    explicit PuzzleGenerator(WorkStealingPool& pool, RuleTier rules = RULES_SINGLES);
+
+    /**
+     * @brief Fill a random solution grid.
+     * @param seed Seed of the grid; equal seeds give equal grids.
+     * @param grid Receives the 81 digits.
+     */
+    static void fillGrid(ulli seed, char* grid);
+
+    /**
+     * @brief Check whether a puzzle stays unique without one of its clues.
+     * @param puzzle 81 characters of a unique puzzle, '.' for empty cells.
+     * @param cell Row-major cell of the clue to remove.
+     * @param rules Propagation rules of the check.
+     * @return true if the puzzle without the clue still has exactly one solution.
+     */
+    static bool uniqueWithout(const char* puzzle, ui cell, RuleTier rules);
+
+    /**
+     * @brief Generate one puzzle on the calling thread.
+     * @param seed Seed of the puzzle.
+     * @param out Receives the 81 characters of the puzzle, '.' for empty cells.
+     * @param stats Receives the counters of the puzzle.
+     * @param rules Propagation rules of the uniqueness checks.
+     */
+    static void generateOne(ulli seed, char* out, GenerateStats& stats, RuleTier rules = RULES_SINGLES);
+
+    /**
+     * @brief Generate one puzzle, checking candidate removals in parallel.
+     *
+     * The next getThreadCount() cells of the removal order are checked at once. Failed checks
+     * stay valid as clues are removed, so only the results after the first successful removal
+     * are checked again; the outcome equals that of generateOne(). Must not be called from a
+     * worker thread of the pool.
+     *
+     * @param seed Seed of the puzzle.
+     * @param out Receives the 81 characters of the puzzle, '.' for empty cells.
+     * @return Counters of the puzzle.
+     */
+    GenerateStats generate(ulli seed, char* out);
+
+    /**
+     * @brief Generate puzzles of consecutive seeds side by side.
+     *
+     * Must not be called from a worker thread of the pool.
+     *
+     * @param count Number of puzzles.
+     * @param firstSeed Seed of the first puzzle; puzzle i uses firstSeed + i.
+     * @param out Receives count lines of LINE_SIZE bytes, in seed order.
+     * @return Counters merged over all puzzles.
+     */
+    GenerateStats generateBatch(size_t count, ulli firstSeed, char* out);
+};
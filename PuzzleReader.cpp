@@ -0,0 +1,85 @@
+#include "PuzzleReader.h"
+
+#include <stdexcept>
+#include <istream>
+#include <string>
+#include <cstring>
+#include <array>
+
+PuzzleLineParser::PuzzleLineParser() : block(), rows(0) {}
+
+bool PuzzleLineParser::feed(const char* line, size_t length, const char*& cells) {
+    // Ignore the '\r' of CRLF line endings
+    if (length > 0 && line[length - 1] == '\r')
+        length--;
+
+    // Lines starting with '#' are comments such as "## MASTER"
+    if (length > 0 && line[0] == '#') {
+        if (rows != 0)
+            throw std::runtime_error("PuzzleLineParser::feed: comment line inside a 9-line block.");
+        return false;
+    }
+
+    if (length == 81) {
+        // One puzzle per line: point straight into the caller's line
+        if (rows != 0)
+            throw std::runtime_error("PuzzleLineParser::feed: 81-character line inside a 9-line block.");
+        cells = line;
+        return true;
+    }
+
+    if (length == 9) {
+        // One row of a 9-line block
+        std::memcpy(block + 9 * rows, line, 9);
+        if (++rows < 9)
+            return false;
+        rows = 0;
+        cells = block;
+        return true;
+    }
+
+    // A blank line separates blocks
+    if (length == 0) {
+        if (rows != 0)
+            throw std::runtime_error("PuzzleLineParser::feed: 9-line block interrupted after "
+                + std::to_string(rows) + " rows.");
+        return false;
+    }
+
+    // Skipping any other line would shift every later output line against its puzzle
+    throw std::runtime_error("PuzzleLineParser::feed: line of " + std::to_string(length)
+        + " characters (expected 81, or 9 in a 9-line block).");
+}
+
+bool PuzzleLineParser::hasPendingRows() const {
+    return rows != 0;
+}
+
+PuzzleReader::PuzzleReader(std::istream& in) : in(in), lineNumber(0) {}
+
+bool PuzzleReader::next(char cells[81]) {
+    while (std::getline(in, line)) {
+        lineNumber++;
+        const char* parsed;
+        if (parser.feed(line.data(), line.size(), parsed)) {
+            std::memcpy(cells, parsed, 81);
+            return true;
+        }
+    }
+    // End of input in the middle of a block
+    if (parser.hasPendingRows())
+        throw std::runtime_error("PuzzleReader::next: input ends inside a 9-line block.");
+    return false;
+}
+
+bool PuzzleReader::next(std::array<ulli, 12>& data) {
+    char cells[81];
+    if (!next(cells))
+        return false;
+    data = SudokuBoard::parseData(cells);
+    return true;
+}
+
+ulli PuzzleReader::getLineNumber() const {
+    return lineNumber;
+}
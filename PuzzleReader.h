@@ -0,0 +1,104 @@
+#pragma once
+
+#include "SudokuBoard.h"
+
+#include <istream>
+#include <string>
+
+/**
+ * @file
+ * @brief Line-oriented readers for puzzle files used by the batch mode.
+ *
+ * Two text layouts are accepted and may be mixed in one file:
+ *   - One puzzle per line of exactly 81 characters.
+ *   - Blocks of 9 lines with 9 characters each, as in example.txt.
+ * In both layouts '1'..'9' are givens and any other character is an empty cell.
+ * Lines starting with '#' (such as "## HARD" headers) are comments and blank lines separate
+ * blocks. A line of any other length is an error, so that every output line of a batch run
+ * still belongs to the input puzzle at the same position.
+ */
+
+/**
+ * @class PuzzleLineParser
+ * @brief Incremental parser that turns a sequence of lines into 81-character puzzles.
+ *
+ * It does not own or copy whole lines. For the 81-per-line layout the returned
+ * pointer refers into the line that was fed; only the 9-line block layout is
+ * gathered into a small internal buffer.
+ */
+class PuzzleLineParser {
+private:
+    char block[81];  /**< Rows of a 9-line block collected so far */
+    ui rows;         /**< Number of rows stored in block (0..8) */
+
+public:
+    /**
+     * @brief Constructor. Starts outside of any block.
+     */
+    PuzzleLineParser();
+
+    /**
+     * @brief Feed one line without its terminating newline.
+     *
+     * A trailing '\r' is ignored so files with CRLF line endings work unchanged.
+     *
+     * @param line Pointer to the first character of the line.
+     * @param length Number of characters in the line.
+     * @param cells Set to the 81 cells of the completed puzzle when true is returned.
+     *              Valid until the next call to feed() or until line goes out of scope.
+     * @return true if the line completed a puzzle; false otherwise.
+     * @throw std::runtime_error if a 9-line block is interrupted by another line, or if the
+     *        line is not blank, a comment, 81 characters or 9 characters long.
+     */
+    bool feed(const char* line, size_t length, const char*& cells);
+
+    /**
+     * @brief Check whether a 9-line block has been started but not completed.
+     *
+     * Call at end of input to detect a truncated final block.
+     *
+     * @return true if 1..8 rows are pending; false otherwise.
+     */
+    bool hasPendingRows() const;
+};
+
+/**
+ * @class PuzzleReader
+ * @brief Reads puzzles one by one from a std::istream (file or stdin).
+ */
+class PuzzleReader {
+private:
+    std::istream& in;         /**< Source stream */
+    PuzzleLineParser parser;  /**< Line parser shared with other loaders */
+    std::string line;         /**< Reused line buffer */
+    ulli lineNumber;          /**< Number of lines consumed so far, for error messages */
+
+public:
+    /**
+     * @brief Constructor. Reading starts at the current position of the stream.
+     * @param in Stream to read puzzles from.
+     */
+    explicit PuzzleReader(std::istream& in);
+
+    /**
+     * @brief Read the next puzzle.
+     * @param cells Buffer of at least 81 characters receiving the puzzle cells.
+     * @return true if a puzzle was read; false at end of input.
+     * @throw std::runtime_error on a line of the wrong length or a malformed or truncated 9-line block.
+     */
+    bool next(char cells[81]);
+
+    /**
+     * @brief Read the next puzzle directly into bitset form.
+     * @param data Receives the candidate bits, as produced by SudokuBoard::parseData().
+     * @return true if a puzzle was read; false at end of input.
+     * @throw std::runtime_error on a line of the wrong length or a malformed or truncated 9-line block.
+     */
+    bool next(std::array<ulli, 12>& data);
+
+    /**
+     * @brief Get how many lines have been consumed.
+     * @return Line number of the last line read (1-based).
+     */
+    ulli getLineNumber() const;
+};
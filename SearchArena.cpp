@@ -0,0 +1,45 @@
+#include "SearchArena.h"
+
+#include <algorithm>
+
+SearchArena::SearchArena(size_t blockSize) : blockSize(blockSize), blocks(), current(0), used(0) {}
+
+void SearchArena::nextBlock(size_t bytes, size_t align) {
+    // Blocks come from new[], which aligns them for any fundamental type
+    while (++current < blocks.size()) {
+        if (bytes <= blocks[current].size) {
+            used = 0;
+            return;
+        }
+    }
+    size_t size = std::max(blockSize, bytes + align);
+    blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+    current = blocks.size() - 1;
+    used = 0;
+}
+
+void* SearchArena::allocate(size_t bytes, size_t align) {
+    if (blocks.empty()) {
+        size_t size = std::max(blockSize, bytes + align);
+        blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+    }
+    size_t start = (used + align - 1) & ~(align - 1);
+    if (start + bytes > blocks[current].size) {
+        nextBlock(bytes, align);
+        start = 0;
+    }
+    used = start + bytes;
+    return blocks[current].data.get() + start;
+}
+
+void SearchArena::reset() {
+    current = 0;
+    used = 0;
+}
+
+size_t SearchArena::capacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks)
+        total += block.size;
+    return total;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @class SearchArena
+ * @brief Bump allocator for the transient state of one solve, released all at once.
+ *
+ * Memory is handed out from a chain of blocks by advancing a pointer; nothing is freed on its
+ * own. reset() rewinds to the start of the first block in O(1) and keeps every block, so
+ * once an arena has served its largest solve, later solves of a worker never reach the
+ * global allocator. Only trivially destructible objects may live in an arena, since no
+ * destructor runs on reset(). An arena is not thread-safe: each worker owns its own.
+ */
+class SearchArena {
+public:
+    /** Default size of a block in bytes. */
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+private:
+    /**
+     * @struct Block
+     * @brief One chunk of memory of the chain.
+     */
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;  /**< Memory of the block */
+        size_t size;                            /**< Bytes of the block */
+    };
+
+    size_t blockSize;           /**< Size of new blocks, unless a request needs more */
+    std::vector<Block> blocks;  /**< All blocks allocated so far, in use order */
+    size_t current;             /**< Block being filled */
+    size_t used;                /**< Bytes handed out from the current block */
+
+    /**
+     * @brief Move on to the next block that can hold a request, allocating it if needed.
+     * @param bytes Size of the request.
+     * @param align Alignment of the request.
+     */
+    void nextBlock(size_t bytes, size_t align);
+
+public:
+    /**
+     * @brief Constructor; no memory is allocated until the first request.
+     * @param blockSize Size of each block in bytes.
+     */
+    explicit SearchArena(size_t blockSize = BLOCK_SIZE);
+
+    SearchArena(const SearchArena& other) = delete;
+    SearchArena& operator=(const SearchArena& other) = delete;
+    SearchArena(SearchArena&& other) noexcept = default;
+    SearchArena& operator=(SearchArena&& other) noexcept = default;
+
+    /**
+     * @brief Allocate raw memory, valid until the next reset().
+     * @param bytes Size in bytes.
+     * @param align Alignment, a power of two no larger than alignof(std::max_align_t).
+     * @return Pointer to the memory.
+     */
+    void* allocate(size_t bytes, size_t align);
+
+    /**
+     * @brief Construct an object in the arena.
+     * @tparam T Trivially destructible type.
+     * @param args Constructor arguments.
+     * @return Pointer to the object, valid until the next reset().
+     */
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "SearchArena never runs destructors");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Release everything allocated so far, keeping the blocks for reuse.
+     */
+    void reset();
+
+    /**
+     * @brief Bytes held by all blocks.
+     * @return Total block size.
+     */
+    size_t capacity() const;
+};
@@ -0,0 +1,465 @@
+#include "SolutionCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <array>
+
+/** Row refinements after which canonicalize() settles for the best form found so far. */
+static const ui CANONICAL_BUDGET = 1 << 11;
+
+/**
+ * @brief Sort the columns of one group, at most three, with compare-swaps.
+ * @param cols Columns to sort.
+ * @param count Number of columns, 0..3.
+ * @param less Strict order of two columns.
+ */
+template <class Less>
+static void sortGroup(uc* cols, ui count, Less less) {
+    if (count > 1 && less(cols[1], cols[0]))
+        std::swap(cols[0], cols[1]);
+    if (count > 2) {
+        if (less(cols[2], cols[1]))
+            std::swap(cols[1], cols[2]);
+        if (less(cols[1], cols[0]))
+            std::swap(cols[0], cols[1]);
+    }
+}
+
+/**
+ * @struct CanonicalState
+ * @brief One partial transform of the canonical search: output rows chosen so far.
+ *
+ * Column positions are split into groups (a stack is at least one group); columns inside a
+ * group have been empty in every chosen row, so any order of them gives the same rows and the
+ * choice is left to the rows below.
+ */
+struct CanonicalState {
+    std::array<uc, 9> cols;    /**< Source column of each position */
+    us groups;                 /**< Bit p set if position p starts a group */
+    std::array<uc, 10> labels; /**< Output digit of each source digit seen so far, 0 if none */
+    uc next;                   /**< Next unused output digit */
+    uc source;                 /**< Source row of the last chosen output row */
+    bool transposed;           /**< Works on the transposed grid */
+    std::array<uc, 9> out;     /**< Relabeled last chosen output row */
+};
+
+/**
+ * @struct CanonicalSearch
+ * @brief State of one GridTransform::canonicalize() search.
+ *
+ * best holds the smallest prefix whose first bestRows rows are known; a search node at output
+ * row k is only entered while the rows above it equal best, so every leaf reached is the
+ * best form so far. Once the budget runs out, best may hold a prefix no leaf was found for,
+ * so the form of the last leaf is kept apart.
+ */
+struct CanonicalSearch {
+    uc grid[2][81];                        /**< Digits 0..9 of the puzzle, as given and transposed */
+    uc best[81];                           /**< Smallest form found so far */
+    ui bestRows;                           /**< Rows of best that are valid */
+    ui evaluations;                        /**< Rows refined, against CANONICAL_BUDGET */
+    bool found;                            /**< A complete form has been reached */
+    std::array<uc, 9> rows;                /**< Source row of each chosen output row */
+    uc form[81];                           /**< Form of the last leaf reached */
+    GridTransform result;                  /**< Transform giving form */
+    std::vector<CanonicalState> levels[9];  /**< Candidates of each output row */
+
+    /**
+     * @brief Append every smallest way to place one source row below a partial transform.
+     *
+     * Group by group, empty cells go first (and stay a group), then digits with a label in
+     * ascending order, then new digits. New digits get the next labels in that order, so one
+     * state is appended per order of the new digits of each group.
+     *
+     * @param state Partial transform; its groups are refined from position pos on.
+     * @param row Source row in the state's grid.
+     * @param pos First position still to place.
+     * @param list Receives the refined states.
+     */
+    void refine(CanonicalState& state, const uc* row, ui pos, std::vector<CanonicalState>& list) {
+        if (pos == 9) {
+            list.push_back(state);
+            return;
+        }
+        ui end = pos + 1;
+        while (end < 9 && (state.groups >> end & 1) == 0)
+            end++;
+
+        uc empty[3], known[3], fresh[3];
+        ui emptyCount = 0, knownCount = 0, freshCount = 0;
+        for (ui p = pos; p < end; p++) {
+            uc col = state.cols[p], v = row[col];
+            if (v == 0)
+                empty[emptyCount++] = col;
+            else if (state.labels[v] != 0)
+                known[knownCount++] = col;
+            else
+                fresh[freshCount++] = col;
+        }
+        sortGroup(known, knownCount, [&](uc a, uc b) { return state.labels[row[a]] < state.labels[row[b]]; });
+
+        // Empty cells stay one group; every other cell is now fixed in place
+        ui p = pos;
+        for (ui i = 0; i < emptyCount; i++)
+            state.cols[p + i] = empty[i], state.out[p + i] = 0;
+        p += emptyCount;
+        for (ui q = p; q < end; q++)
+            state.groups |= (us)(1u << q);
+        for (ui i = 0; i < knownCount; i++, p++)
+            state.cols[p] = known[i], state.out[p] = state.labels[row[known[i]]];
+
+        sortGroup(fresh, freshCount, [](uc a, uc b) { return a < b; });
+        do {
+            CanonicalState next = state;
+            for (ui i = 0; i < freshCount; i++) {
+                next.cols[p + i] = fresh[i];
+                next.labels[row[fresh[i]]] = next.next;
+                next.out[p + i] = next.next++;
+            }
+            refine(next, row, end, list);
+        } while (std::next_permutation(fresh, fresh + freshCount));
+    }
+
+    /**
+     * @brief Place each candidate source row below a partial transform.
+     * @param state Partial transform with output rows 0..k-1.
+     * @param source Source row to place as output row k.
+     * @param list Receives the refined states.
+     */
+    void place(const CanonicalState& state, ui source, std::vector<CanonicalState>& list) {
+        CanonicalState next = state;
+        next.source = (uc)source;
+        refine(next, grid[state.transposed] + 9 * source, 0, list);
+        evaluations++;
+    }
+
+    /**
+     * @brief Keep the candidates of output row k tied for the smallest row and search below each.
+     * @param k Output row the candidates are for.
+     * @param usedRows Bit r set if source row r is placed in rows 0..k-1.
+     */
+    void descend(ui k, ui usedRows) {
+        const std::vector<CanonicalState>& candidates = levels[k];
+        if (candidates.empty())
+            return;
+        size_t minimum = 0;
+        for (size_t i = 1; i < candidates.size(); i++) {
+            if (candidates[i].out < candidates[minimum].out)
+                minimum = i;
+        }
+
+        uc* bestRow = best + 9 * k;
+        if (k < bestRows) {
+            int order = std::memcmp(candidates[minimum].out.data(), bestRow, 9);
+            if (order > 0)
+                return;
+            if (order < 0)
+                bestRows = k;
+        }
+        if (k >= bestRows) {
+            std::memcpy(bestRow, candidates[minimum].out.data(), 9);
+            bestRows = k + 1;
+        }
+
+        bool emptyTried = false;
+        for (const CanonicalState& state : candidates) {
+            if (std::memcmp(state.out.data(), bestRow, 9) != 0)
+                continue;
+            // Two empty rows of one band are interchangeable, so one subtree covers both
+            if (k % 3 != 0 && *std::max_element(state.out.begin(), state.out.end()) == 0) {
+                if (emptyTried)
+                    continue;
+                emptyTried = true;
+            }
+            rows[k] = state.source;
+            if (k == 8) {
+                result.transposed = state.transposed;
+                result.rows = rows;
+                result.cols = state.cols;
+                result.labels = state.labels;
+                std::memcpy(form, best, 81);
+                found = true;
+            } else {
+                expand(k + 1, usedRows | 1u << state.source, state);
+            }
+        }
+    }
+
+    /**
+     * @brief Generate the candidates of output row k and search them.
+     * @param k Output row to choose (1..8).
+     * @param usedRows Bit r set if source row r is placed in rows 0..k-1.
+     * @param state Partial transform with output rows 0..k-1.
+     */
+    void expand(ui k, ui usedRows, const CanonicalState& state) {
+        if (found && evaluations >= CANONICAL_BUDGET)
+            return;
+        std::vector<CanonicalState>& candidates = levels[k];
+        candidates.clear();
+        // A band is started by any row of an unused band, then continued within it
+        if (k % 3 == 0) {
+            for (ui r = 0; r < 9; r++) {
+                if ((usedRows >> (r / 3 * 3) & 7) == 0)
+                    place(state, r, candidates);
+            }
+        } else {
+            for (ui r = rows[k - k % 3] / 3 * 3, end = r + 3; r < end; r++) {
+                if ((usedRows >> r & 1) == 0)
+                    place(state, r, candidates);
+            }
+        }
+        descend(k, usedRows);
+    }
+};
+
+GridTransform GridTransform::canonicalize(const char* cells, char* canonical) {
+    // Reused so the candidate lists keep their capacity from one puzzle to the next
+    static thread_local CanonicalSearch s;
+    for (ui i = 0; i < 81; i++) {
+        char c = cells[i];
+        uc v = (c >= '1' && c <= '9') ? (uc)(c - '0') : 0;
+        s.grid[0][i] = v;
+        s.grid[1][i % 9 * 9 + i / 9] = v;
+    }
+    s.bestRows = 0;
+    s.evaluations = 0;
+    s.found = false;
+    s.levels[0].clear();
+
+    // Relabeling assumes the digits of a row are distinct; a grid repeating one in a row or
+    // column has no solution and is left as it is
+    for (ui t = 0; t < 2; t++) {
+        for (ui r = 0; r < 9; r++) {
+            ui seen = 0;
+            for (ui c = 0; c < 9; c++) {
+                uc v = s.grid[t][9 * r + c];
+                if (v != 0 && (seen >> v & 1) != 0) {
+                    GridTransform identity = {};
+                    for (ui i = 0; i < 9; i++)
+                        identity.rows[i] = identity.cols[i] = (uc)i;
+                    for (ui i = 0; i <= 9; i++)
+                        identity.labels[i] = (uc)i;
+                    identity.apply(cells, canonical);
+                    return identity;
+                }
+                seen |= 1u << v;
+            }
+        }
+    }
+
+    // Row 0 puts the stacks with the most empty cells first, so only these stack orders of the
+    // rows with the fewest givens per stack (sorted) can start the smallest form
+    ui bestShape = ~0u;
+    for (ui t = 0; t < 2; t++) {
+        for (ui r = 0; r < 9; r++) {
+            ui givens[3] = {};
+            for (ui c = 0; c < 9; c++)
+                givens[c / 3] += s.grid[t][9 * r + c] != 0;
+            std::sort(givens, givens + 3);
+            bestShape = std::min(bestShape, givens[0] * 16 + givens[1] * 4 + givens[2]);
+        }
+    }
+    for (ui t = 0; t < 2; t++) {
+        for (ui r = 0; r < 9; r++) {
+            ui givens[3] = {};
+            for (ui c = 0; c < 9; c++)
+                givens[c / 3] += s.grid[t][9 * r + c] != 0;
+            std::array<uc, 3> stacks = { 0, 1, 2 };
+            do {
+                ui a = givens[stacks[0]], b = givens[stacks[1]], d = givens[stacks[2]];
+                if (a > b || b > d || a * 16 + b * 4 + d != bestShape)
+                    continue;
+                CanonicalState root = {};
+                for (ui p = 0; p < 9; p++)
+                    root.cols[p] = (uc)(3 * stacks[p / 3] + p % 3);
+                root.groups = 1 | 1 << 3 | 1 << 6;
+                root.next = 1;
+                root.transposed = t != 0;
+                s.place(root, r, s.levels[0]);
+            } while (std::next_permutation(stacks.begin(), stacks.end()));
+        }
+    }
+    s.descend(0, 0);
+
+    // Digits missing from the puzzle take the remaining labels in ascending order
+    GridTransform result = s.result;
+    uc next = 1;
+    for (ui v = 1; v <= 9; v++)
+        next = std::max<uc>(next, (uc)(result.labels[v] + 1));
+    for (ui v = 1; v <= 9; v++) {
+        if (result.labels[v] == 0)
+            result.labels[v] = next++;
+    }
+    for (ui i = 0; i < 81; i++)
+        canonical[i] = s.form[i] == 0 ? '.' : (char)('0' + s.form[i]);
+    return result;
+}
+
+void GridTransform::apply(const char* cells, char* out) const {
+    for (ui r = 0; r < 9; r++) {
+        for (ui c = 0; c < 9; c++) {
+            ui source = transposed ? 9 * cols[c] + rows[r] : 9 * rows[r] + cols[c];
+            char v = cells[source];
+            out[9 * r + c] = (v >= '1' && v <= '9') ? (char)('0' + labels[v - '0']) : '.';
+        }
+    }
+}
+
+void GridTransform::invert(const char* cells, char* out) const {
+    uc digits[10] = {};
+    for (ui v = 1; v <= 9; v++)
+        digits[labels[v]] = (uc)v;
+    for (ui r = 0; r < 9; r++) {
+        for (ui c = 0; c < 9; c++) {
+            ui source = transposed ? 9 * cols[c] + rows[r] : 9 * rows[r] + cols[c];
+            char v = cells[9 * r + c];
+            out[source] = (v >= '1' && v <= '9') ? (char)('0' + digits[v - '0']) : '.';
+        }
+    }
+}
+
+/**
+ * @brief 64-bit FNV-1a hash of a packed grid.
+ */
+static ulli fnv1a(const SolutionCache::Packed& key) {
+    ulli hash = 14695981039346656037ULL;
+    for (uc byte : key)
+        hash = (hash ^ byte) * 1099511628211ULL;
+    return hash;
+}
+
+SolutionCache::SolutionCache(size_t capacity)
+    : shardCapacity(std::max<size_t>(1, capacity / SHARDS)), slotMask(0), shards(new Shard[SHARDS]) {
+    // At most half of the slots are in use, which keeps probe runs short
+    size_t slots = 2;
+    while (slots < 2 * shardCapacity)
+        slots *= 2;
+    slotMask = slots - 1;
+    for (size_t i = 0; i < SHARDS; i++) {
+        Shard& shard = shards[i];
+        shard.entries.reset(new Entry[shardCapacity]);
+        shard.slots.reset(new ui[slots]());
+        shard.used = 0;
+        shard.newest = shard.oldest = NONE;
+    }
+}
+
+size_t SolutionCache::findSlot(const Shard& shard, const Packed& key, ui hash) const {
+    for (size_t slot = hash & slotMask;; slot = (slot + 1) & slotMask) {
+        ui held = shard.slots[slot];
+        if (held == 0)
+            return slot;
+        const Entry& entry = shard.entries[held - 1];
+        if (entry.hash == hash && entry.key == key)
+            return slot;
+    }
+}
+
+void SolutionCache::eraseSlot(Shard& shard, size_t slot) {
+    // Backward-shift deletion: pull later entries of the run into the hole if they probed past it
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & slotMask; shard.slots[next] != 0; next = (next + 1) & slotMask) {
+        size_t home = shard.entries[shard.slots[next] - 1].hash & slotMask;
+        if (((next - home) & slotMask) >= ((next - hole) & slotMask)) {
+            shard.slots[hole] = shard.slots[next];
+            hole = next;
+        }
+    }
+    shard.slots[hole] = 0;
+}
+
+void SolutionCache::unlink(Shard& shard, ui entry) {
+    Entry& e = shard.entries[entry];
+    if (e.newer != NONE)
+        shard.entries[e.newer].older = e.older;
+    else
+        shard.newest = e.older;
+    if (e.older != NONE)
+        shard.entries[e.older].newer = e.newer;
+    else
+        shard.oldest = e.newer;
+}
+
+void SolutionCache::touch(Shard& shard, ui entry) {
+    if (shard.newest == entry)
+        return;
+    unlink(shard, entry);
+    Entry& e = shard.entries[entry];
+    e.newer = NONE;
+    e.older = shard.newest;
+    if (shard.newest != NONE)
+        shard.entries[shard.newest].newer = entry;
+    shard.newest = entry;
+    if (shard.oldest == NONE)
+        shard.oldest = entry;
+}
+
+bool SolutionCache::lookup(const char* canonical, char* solution) {
+    Packed key;
+    packNibbles(canonical, key.data());
+    // The low bits pick the slot inside the shard, so pick the shard by the high ones
+    ulli hash = fnv1a(key);
+    Shard& shard = shards[(hash >> 48) % SHARDS];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ui held = shard.slots[findSlot(shard, key, (ui)hash)];
+    if (held == 0)
+        return false;
+    touch(shard, held - 1);
+    const Packed& value = shard.entries[held - 1].value;
+    if (std::all_of(value.begin(), value.end(), [](uc byte) { return byte == 0; }))
+        std::fill(solution, solution + 81, '.');
+    else
+        unpackNibbles(value.data(), solution);
+    return true;
+}
+
+void SolutionCache::insert(const char* canonical, const char* solution) {
+    Packed key, value = {};
+    packNibbles(canonical, key.data());
+    if (solution != nullptr)
+        packNibbles(solution, value.data());
+    ulli hash = fnv1a(key);
+    Shard& shard = shards[(hash >> 48) % SHARDS];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size_t slot = findSlot(shard, key, (ui)hash);
+    if (shard.slots[slot] != 0) {
+        touch(shard, shard.slots[slot] - 1);
+        return;
+    }
+
+    // A free pool entry, or else the least recently used one
+    ui entry;
+    if (shard.used < shardCapacity) {
+        entry = shard.used++;
+        Entry& e = shard.entries[entry];
+        e.newer = NONE;
+        e.older = shard.newest;
+        if (shard.newest != NONE)
+            shard.entries[shard.newest].newer = entry;
+        shard.newest = entry;
+        if (shard.oldest == NONE)
+            shard.oldest = entry;
+    } else {
+        entry = shard.oldest;
+        Entry& old = shard.entries[entry];
+        eraseSlot(shard, findSlot(shard, old.key, old.hash));
+        touch(shard, entry);
+        slot = findSlot(shard, key, (ui)hash);
+    }
+    Entry& e = shard.entries[entry];
+    e.key = key;
+    e.value = value;
+    e.hash = (ui)hash;
+    shard.slots[slot] = entry + 1;
+}
+
+size_t SolutionCache::size() {
+    size_t total = 0;
+    for (size_t i = 0; i < SHARDS; i++) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        total += shards[i].used;
+    }
+    return total;
+}
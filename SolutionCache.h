@@ -0,0 +1,175 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "NibbleCodec.h"
+
+#include <cstddef>
+#include <memory>
+#include <array>
+#include <mutex>
+
+/**
+ * @struct GridTransform
+ * @brief A validity-preserving symmetry of the 9x9 grid, and the search for the canonical form.
+ *
+ * Output cell (r, c) takes the digit of source cell (rows[r], cols[c]) of the grid, transposed
+ * first if transposed is set, relabeled through labels. rows and cols only permute rows within
+ * bands and bands (columns within stacks and stacks), so every transform maps puzzles to
+ * puzzles and solutions to solutions.
+ */
+struct GridTransform {
+    bool transposed;                /**< Swap rows and columns before permuting */
+    std::array<uc, 9> rows;          /**< Source row of each output row */
+    std::array<uc, 9> cols;          /**< Source column of each output column */
+    std::array<uc, 10> labels;       /**< Output digit of each source digit (index 0 unused) */
+
+    /**
+     * @brief Find the transform giving the lexicographically smallest puzzle.
+     *
+     * Empty cells sort before values, and digits are relabeled in order of first appearance,
+     * so symmetric puzzles (digit relabelings, row and column permutations within bands and
+     * stacks, band and stack permutations, transposition) get the same canonical form. The
+     * 3.4 million transforms are searched row by row, keeping only the ties of the best
+     * prefix; digits missing from the puzzle get the remaining labels in ascending order.
+     * Very sparse puzzles have so many ties that the search stops after a fixed budget; their
+     * form is then still a valid transform of the puzzle, but symmetric copies may get another.
+     * A grid repeating a digit in a row or column is returned unchanged (identity transform).
+     *
+     * @param cells 81 characters; '1'..'9' are givens, anything else is an empty cell.
+     * @param canonical Receives the 81-character canonical puzzle, '.' for empty cells.
+     * @return The transform mapping cells to canonical.
+     */
+    static GridTransform canonicalize(const char* cells, char* canonical);
+
+    /**
+     * @brief Apply the transform to a grid.
+     * @param cells 81 characters; '1'..'9' are relabeled, anything else becomes '.'.
+     * @param out Receives the 81 transformed characters; must not alias cells.
+     */
+    void apply(const char* cells, char* out) const;
+
+    /**
+     * @brief Apply the inverse transform to a grid, e.g. map a canonical solution back.
+     * @param cells 81 characters; '1'..'9' are relabeled, anything else becomes '.'.
+     * @param out Receives the 81 characters of the original orientation; must not alias cells.
+     */
+    void invert(const char* cells, char* out) const;
+};
+
+/**
+ * @class SolutionCache
+ * @brief Thread-safe LRU cache of solutions, keyed by canonical puzzle.
+ *
+ * Keys and values are the 41-byte packed form (see NibbleCodec.h) of the canonical puzzle and
+ * of its solution; an all-zero value records that the puzzle has no solution. The table is
+ * split into SHARDS independently locked parts, picked by key hash, so workers of a batch
+ * rarely contend; each shard evicts its least recently used entry once it holds its share
+ * of the capacity.
+ *
+ * All memory is allocated by the constructor: each shard owns a pool of entries, linked into
+ * its recency list by index, and an open-addressing index of those entries. An evicted entry
+ * is reused by the key replacing it, so lookups and inserts never call the global allocator.
+ *
+ * For a puzzle with several solutions, a hit returns whichever solution was cached first,
+ * mapped through the symmetry, which may differ from the one a fresh search would find.
+ */
+class SolutionCache {
+public:
+    /** Independently locked parts of the table. */
+    static const size_t SHARDS = 16;
+
+    /** Packed puzzle or solution. */
+    typedef std::array<uc, NIBBLE_PUZZLE_BYTES> Packed;
+
+private:
+    /** Marks the end of a recency list. */
+    static const ui NONE = ~0u;
+
+    /**
+     * @struct Entry
+     * @brief One pooled entry: key, value and links of the recency list.
+     */
+    struct Entry {
+        Packed key;    /**< Packed canonical puzzle */
+        Packed value;  /**< Packed canonical solution, all zero if none */
+        ui hash;       /**< Low bits of the key's hash, to re-probe without rehashing */
+        ui newer;      /**< Next more recently used entry, or NONE */
+        ui older;      /**< Next less recently used entry, or NONE */
+    };
+
+    /**
+     * @struct Shard
+     * @brief One locked part: entry pool, recency list and index into the pool.
+     */
+    struct alignas(64) Shard {
+        std::mutex mutex;                 /**< Guards the fields below */
+        std::unique_ptr<Entry[]> entries;  /**< Pool of shardCapacity entries */
+        std::unique_ptr<ui[]> slots;      /**< Linear-probing index: entry + 1 per slot, 0 if free */
+        ui used;                          /**< Entries of the pool in use */
+        ui newest;                        /**< Most recently used entry, or NONE */
+        ui oldest;                        /**< Least recently used entry, or NONE */
+    };
+
+    size_t shardCapacity;                  /**< Entries kept per shard */
+    size_t slotMask;                       /**< Slots per shard minus one (a power of two) */
+    std::unique_ptr<Shard[]> shards;       /**< The SHARDS parts */
+
+    /**
+     * @brief Find the slot of a key in a shard.
+     * @param shard Shard to search.
+     * @param key Canonical puzzle.
+     * @param hash Hash of key.
+     * @return Slot holding the key, or the free slot ending its probe sequence.
+     */
+    size_t findSlot(const Shard& shard, const Packed& key, ui hash) const;
+
+    /**
+     * @brief Remove the index slot of an entry, shifting later entries of its probe run back.
+     * @param shard Shard holding the slot.
+     * @param slot Slot to free.
+     */
+    void eraseSlot(Shard& shard, size_t slot);
+
+    /**
+     * @brief Move an entry to the front of its shard's recency list.
+     * @param shard Shard holding the entry.
+     * @param entry Index of the entry.
+     */
+    static void touch(Shard& shard, ui entry);
+
+    /**
+     * @brief Unlink an entry from its shard's recency list.
+     * @param shard Shard holding the entry.
+     * @param entry Index of the entry.
+     */
+    static void unlink(Shard& shard, ui entry);
+
+public:
+    /**
+     * @brief Constructor.
+     * @param capacity Largest number of cached solutions (at least one per shard is kept);
+     *                 the memory for all of them is allocated here.
+     */
+    explicit SolutionCache(size_t capacity);
+
+    /**
+     * @brief Look up a canonical puzzle and mark it recently used.
+     * @param canonical 81-character canonical puzzle (see GridTransform::canonicalize()).
+     * @param solution Receives the 81-character canonical solution, or 81 '.' if it has none.
+     * @return true on a hit; solution is unchanged on a miss.
+     */
+    bool lookup(const char* canonical, char* solution);
+
+    /**
+     * @brief Cache the solution of a canonical puzzle, evicting the least recently used entry if full.
+     * @param canonical 81-character canonical puzzle.
+     * @param solution 81-character canonical solution, or nullptr if the puzzle has none.
+     */
+    void insert(const char* canonical, const char* solution);
+
+    /**
+     * @brief Number of cached solutions.
+     * @return Entries over all shards.
+     */
+    size_t size();
+};
@@ -0,0 +1,103 @@
+#include "SolveCounters.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <bit>
+
+void mergeSolveCounters(SolveCounters& into, const SolveCounters& from) {
+    into.puzzles += from.puzzles;
+    into.nodes += from.nodes;
+    into.backtracks += from.backtracks;
+    into.maxDepth = std::max(into.maxDepth, from.maxDepth);
+    into.propagationTicks += from.propagationTicks;
+    into.searchTicks += from.searchTicks;
+    for (ui i = 0; i < SIMPLIFICATION_CAUSE_COUNT; i++)
+        into.eliminations[i] += from.eliminations[i];
+    for (ui i = 0; i < SolveCounters::LATENCY_BUCKETS; i++)
+        into.latency[i] += from.latency[i];
+    into.latencyMicros += from.latencyMicros;
+}
+
+void recordLatency(SolveCounters& counters, ulli micros) {
+    // Bucket b holds (2^(b-1), 2^b] microseconds
+    ui bucket = micros <= 1 ? 0 : (ui)std::bit_width(micros - 1);
+    counters.latency[std::min(bucket, SolveCounters::LATENCY_BUCKETS - 1)]++;
+    counters.latencyMicros += micros;
+}
+
+/**
+ * @brief Share of the search ticks spent propagating.
+ * @return 0..1, or 0 if nothing was timed.
+ */
+static double propagationShare(const SolveCounters& counters) {
+    return counters.searchTicks == 0 ? 0.0 : (double)counters.propagationTicks / (double)counters.searchTicks;
+}
+
+std::string solveCountersJson(const SolveCounters& counters) {
+    std::ostringstream out;
+    out.precision(6);
+    out << "{\"puzzles\": " << counters.puzzles << ", \"nodes\": " << counters.nodes
+        << ", \"backtracks\": " << counters.backtracks << ", \"max_depth\": " << counters.maxDepth
+        << ", \"propagation_ticks\": " << counters.propagationTicks << ", \"search_ticks\": " << counters.searchTicks
+        << ", \"propagation_share\": " << propagationShare(counters) << ", \"eliminations\": {";
+    bool first = true;
+    for (ui i = 0; i < SIMPLIFICATION_CAUSE_COUNT; i++) {
+        const char* name = simplificationCauseName((SimplificationCause)((int)i + NO_PLACE_POSSIBLE));
+        if (name == nullptr)
+            continue;
+        out << (first ? "" : ", ") << '"' << name << "\": " << counters.eliminations[i];
+        first = false;
+    }
+    // Bucket upper bounds in microseconds; the last one has none
+    out << "}, \"latency_us\": {\"sum\": " << counters.latencyMicros << ", \"buckets\": [";
+    for (ui b = 0; b < SolveCounters::LATENCY_BUCKETS; b++) {
+        out << (b == 0 ? "" : ", ") << "{\"le\": ";
+        if (b + 1 < SolveCounters::LATENCY_BUCKETS)
+            out << (1ULL << b);
+        else
+            out << "null";
+        out << ", \"count\": " << counters.latency[b] << '}';
+    }
+    out << "]}}\n";
+    return out.str();
+}
+
+std::string solveCountersPrometheus(const SolveCounters& counters) {
+    std::ostringstream out;
+    out.precision(6);
+    out << "# HELP sudoku_puzzles_total Puzzles searched.\n# TYPE sudoku_puzzles_total counter\n"
+        << "sudoku_puzzles_total " << counters.puzzles << '\n'
+        << "# HELP sudoku_nodes_total Search nodes entered.\n# TYPE sudoku_nodes_total counter\n"
+        << "sudoku_nodes_total " << counters.nodes << '\n'
+        << "# HELP sudoku_backtracks_total Branches rolled back.\n# TYPE sudoku_backtracks_total counter\n"
+        << "sudoku_backtracks_total " << counters.backtracks << '\n'
+        << "# HELP sudoku_max_depth Deepest branch level reached.\n# TYPE sudoku_max_depth gauge\n"
+        << "sudoku_max_depth " << counters.maxDepth << '\n'
+        << "# HELP sudoku_propagation_ticks_total Ticks spent propagating.\n# TYPE sudoku_propagation_ticks_total counter\n"
+        << "sudoku_propagation_ticks_total " << counters.propagationTicks << '\n'
+        << "# HELP sudoku_search_ticks_total Ticks spent searching, propagation included.\n# TYPE sudoku_search_ticks_total counter\n"
+        << "sudoku_search_ticks_total " << counters.searchTicks << '\n'
+        << "# HELP sudoku_eliminations_total Simplification events by cause.\n# TYPE sudoku_eliminations_total counter\n";
+    for (ui i = 0; i < SIMPLIFICATION_CAUSE_COUNT; i++) {
+        const char* name = simplificationCauseName((SimplificationCause)((int)i + NO_PLACE_POSSIBLE));
+        if (name != nullptr)
+            out << "sudoku_eliminations_total{cause=\"" << name << "\"} " << counters.eliminations[i] << '\n';
+    }
+
+    out << "# HELP sudoku_solve_latency_microseconds Solve time per puzzle.\n"
+        << "# TYPE sudoku_solve_latency_microseconds histogram\n";
+    ulli cumulative = 0;
+    for (ui b = 0; b < SolveCounters::LATENCY_BUCKETS; b++) {
+        cumulative += counters.latency[b];
+        out << "sudoku_solve_latency_microseconds_bucket{le=\"";
+        if (b + 1 < SolveCounters::LATENCY_BUCKETS)
+            out << (1ULL << b);
+        else
+            out << "+Inf";
+        out << "\"} " << cumulative << '\n';
+    }
+    out << "sudoku_solve_latency_microseconds_sum " << counters.latencyMicros << '\n'
+        << "sudoku_solve_latency_microseconds_count " << cumulative << '\n';
+    return out.str();
+}
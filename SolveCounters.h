@@ -0,0 +1,132 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "SolveStats.h"
+
+#include <chrono>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SOLVE_COUNTERS_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+/**
+ * @file
+ * @brief Optional hot-path counters of the search, and their JSON and Prometheus export.
+ *
+ * Counting is done by CounterListener, a listener policy, so searches run with any other
+ * listener compile to the same code as before and pay nothing. Each thread counts into its
+ * own SolveCounters, padded to a cache line so workers never share one; the records are
+ * merged with mergeSolveCounters() once the threads are done.
+ */
+
+/**
+ * @brief Read a cheap monotonic tick counter: the TSC on x86, steady_clock nanoseconds elsewhere.
+ *
+ * Ticks are only compared with each other (e.g. propagation against the whole search), so
+ * their length does not matter.
+ *
+ * @return Current tick count.
+ */
+inline ulli readTicks() {
+#ifdef SOLVE_COUNTERS_TSC
+    return (ulli)__rdtsc();
+#else
+    return (ulli)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @struct SolveCounters
+ * @brief Counters of the searches run by one thread.
+ *
+ * Latency bucket 0 counts puzzles of at most 1 microsecond, bucket b (0 < b < LATENCY_BUCKETS - 1)
+ * those in (2^(b-1), 2^b] microseconds, and the last bucket all slower ones.
+ */
+struct alignas(64) SolveCounters {
+    static const ui LATENCY_BUCKETS = 24;  /**< Powers of two up to 2^22 us (about 4 s), plus overflow */
+
+    ulli puzzles;                                      /**< Puzzles searched */
+    ulli nodes;                                        /**< Search nodes entered */
+    ulli backtracks;                                   /**< Branches rolled back */
+    ulli maxDepth;                                     /**< Deepest branch level reached */
+    ulli propagationTicks;                             /**< Ticks spent propagating (see readTicks()) */
+    ulli searchTicks;                                  /**< Ticks spent in the whole search */
+    ulli eliminations[SIMPLIFICATION_CAUSE_COUNT];     /**< Events by cause, indexed by cause - NO_PLACE_POSSIBLE */
+    ulli latency[LATENCY_BUCKETS];                     /**< Puzzles by solve time, see above */
+    ulli latencyMicros;                                /**< Solve time of all puzzles in microseconds */
+};
+
+/**
+ * @brief Add the counters of one record to another.
+ * @param into Record receiving the sums (and the larger maxDepth).
+ * @param from Record to add.
+ */
+void mergeSolveCounters(SolveCounters& into, const SolveCounters& from);
+
+/**
+ * @brief Count one puzzle in the latency histogram.
+ * @param counters Record to count into.
+ * @param micros Solve time of the puzzle in microseconds.
+ */
+void recordLatency(SolveCounters& counters, ulli micros);
+
+/**
+ * @brief Format counters as one JSON object.
+ * @param counters Counters to format.
+ * @return JSON text ending with a newline.
+ */
+std::string solveCountersJson(const SolveCounters& counters);
+
+/**
+ * @brief Format counters in the Prometheus text exposition format.
+ *
+ * Counters are named sudoku_*_total, eliminations carry a cause label, and the latency
+ * histogram is sudoku_solve_latency_microseconds with cumulative le buckets.
+ *
+ * @param counters Counters to format.
+ * @return Exposition text ending with a newline.
+ */
+std::string solveCountersPrometheus(const SolveCounters& counters);
+
+/**
+ * @struct CounterListener
+ * @brief Listener policy that counts like StatsListener and also fills a SolveCounters.
+ *
+ * Every hook is a few increments; time is taken with readTicks() around each propagation.
+ */
+struct CounterListener : StatsListener {
+    SolveCounters& counters;  /**< Receives the search counters */
+    ulli propagateStart;      /**< Ticks at the start of the running propagation */
+
+    /**
+     * @brief Constructor.
+     * @param stats Record to count assignments and simplifications into.
+     * @param counters Record to count nodes, backtracks, depth, eliminations and time into.
+     */
+    CounterListener(SolveStats& stats, SolveCounters& counters) : StatsListener(stats), counters(counters), propagateStart(0) {}
+
+    void onNode(const SearchPath& path) {
+        counters.nodes++;
+        // The path holds a dummy root entry
+        if (path.size() - 1 > counters.maxDepth)
+            counters.maxDepth = path.size() - 1;
+    }
+    void onPropagateBegin(const SearchPath& path) {
+        propagateStart = readTicks();
+    }
+    void onPropagateEnd(const SearchPath& path, bool consistent) {
+        counters.propagationTicks += readTicks() - propagateStart;
+    }
+    void onBacktrack(const SearchPath& path) {
+        counters.backtracks++;
+    }
+    void onEliminate(const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by) {
+        counters.eliminations[cause - NO_PLACE_POSSIBLE]++;
+    }
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * @file
+ * @brief Plain statistics record filled by the batch and library solve paths.
+ *
+ * Kept as a C-compatible struct so it can be shared across module boundaries
+ * and merged cheaply from per-thread copies.
+ */
+
+/**
+ * @struct SolveStats
+ * @brief Counters describing one or more solves.
+ */
+typedef struct SolveStats {
+    unsigned long long puzzles;          /**< Number of puzzles attempted */
+    unsigned long long solved;           /**< Number of puzzles for which a solution was found */
+    unsigned long long assignments;      /**< Tentative DFS assignments over all puzzles */
+    unsigned long long simplifications;  /**< Simplification passes over all puzzles */
+    unsigned long long micros;           /**< Solve time in microseconds, summed over puzzles */
+    unsigned long long cacheHits;        /**< Puzzles answered from the solution cache */
+    unsigned long long cacheMisses;      /**< Puzzles looked up in the solution cache and then solved */
+    unsigned long long overBudget;       /**< Puzzles whose search was stopped by its node or time budget or cancelled */
+    unsigned long long tableProbes;      /**< Transposition table lookups of the searches */
+    unsigned long long tableHits;        /**< Lookups that found the state */
+} SolveStats;
+
+#ifdef __cplusplus
+/**
+ * @brief Add the counters of one record to another.
+ * @param into Record receiving the sums.
+ * @param from Record to add.
+ */
+inline void mergeSolveStats(SolveStats& into, const SolveStats& from) {
+    into.puzzles += from.puzzles;
+    into.solved += from.solved;
+    into.assignments += from.assignments;
+    into.simplifications += from.simplifications;
+    into.micros += from.micros;
+    into.cacheHits += from.cacheHits;
+    into.cacheMisses += from.cacheMisses;
+    into.overBudget += from.overBudget;
+    into.tableProbes += from.tableProbes;
+    into.tableHits += from.tableHits;
+}
+#endif
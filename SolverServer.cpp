@@ -0,0 +1,364 @@
+#include "SolverServer.h"
+#include "BatchSolver.h"
+#include "PackedPuzzleFile.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#ifdef MSG_NOSIGNAL
+  #define SEND_FLAGS MSG_NOSIGNAL
+#else
+  #define SEND_FLAGS 0
+#endif
+
+/**
+ * @struct Job
+ * @brief One request frame being solved: its puzzles and the response frame being filled.
+ */
+struct Job {
+    std::vector<unsigned char> puzzles;   /**< count packed puzzles */
+    std::vector<unsigned char> response;  /**< Header plus count packed solutions */
+    std::atomic<size_t> remaining;        /**< Tasks of this job not yet finished */
+};
+
+/**
+ * @brief Read exactly size bytes.
+ * @return false on end of stream or error.
+ */
+static bool readFully(int fd, unsigned char* buffer, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::recv(fd, buffer, size, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buffer += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * @brief Write exactly size bytes.
+ * @return false if the peer is gone or an error occurred.
+ */
+static bool writeFully(int fd, const unsigned char* buffer, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, buffer, size, SEND_FLAGS);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buffer += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * @brief Error message for a failed system call.
+ */
+static std::string systemError(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+/**
+ * @brief Keep a write to a closed socket from raising SIGPIPE where send() cannot be told so.
+ */
+static void disableSigpipe(int fd) {
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+    (void)fd;
+#endif
+}
+
+SolverServer::SolverServer(WorkStealingPool& pool, RuleTier rules, BranchStrategy branching)
+    : pool(pool), rules(rules), branching(branching), cache(nullptr), counting(false), stopping(false), budget{ 0, 0, &stopping }, perWorker(pool.getThreadCount()), listenFd(-1) {
+    for (WorkerStats& w : perWorker) {
+        w.stats = SolveStats();
+        w.counters = SolveCounters();
+    }
+    if (::pipe(wakePipe) != 0)
+        throw std::runtime_error(systemError("pipe"));
+    // Neither stop() nor the drain in run() may ever block on it
+    fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+}
+
+SolverServer::~SolverServer() {
+    reapConnections(true);
+    if (listenFd >= 0)
+        ::close(listenFd);
+    if (!unixPath.empty())
+        ::unlink(unixPath.c_str());
+    ::close(wakePipe[0]);
+    ::close(wakePipe[1]);
+}
+
+void SolverServer::setCache(SolutionCache* cache) {
+    this->cache = cache;
+}
+
+void SolverServer::enableCounters(bool enable) {
+    counting = enable;
+}
+
+void SolverServer::setBudget(ulli maxNodes, ulli maxMicros) {
+    budget = { maxNodes, maxMicros, &stopping };
+}
+
+void SolverServer::listen(const char* address) {
+    if (listenFd >= 0)
+        throw std::runtime_error("server is already listening");
+
+    std::string spec(address);
+    if (spec.compare(0, 5, "unix:") == 0) {
+        std::string path = spec.substr(5);
+        sockaddr_un addr = {};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path))
+            throw std::invalid_argument("bad Unix socket path: " + path);
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        // Replace a socket left behind by an earlier run, but never any other file
+        struct stat st;
+        if (::stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+            ::unlink(path.c_str());
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            throw std::runtime_error(systemError("socket"));
+        if (::bind(fd, (const sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+            std::string message = systemError(path.c_str());
+            ::close(fd);
+            throw std::runtime_error(message);
+        }
+        listenFd = fd;
+        unixPath = path;
+        return;
+    }
+
+    // "PORT" listens on loopback only; "HOST:PORT" on the given interface
+    size_t colon = spec.rfind(':');
+    std::string host = colon == std::string::npos ? "127.0.0.1" : spec.substr(0, colon);
+    std::string port = colon == std::string::npos ? spec : spec.substr(colon + 1);
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']')
+        host = host.substr(1, host.size() - 2);
+    if (port.empty() || port.find_first_not_of("0123456789") != std::string::npos)
+        throw std::invalid_argument("bad listen address: " + spec);
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    addrinfo* found = nullptr;
+    int status = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found);
+    if (status != 0)
+        throw std::runtime_error(spec + ": " + gai_strerror(status));
+
+    std::string message = "cannot listen on " + spec;
+    for (addrinfo* ai = found; ai != nullptr && listenFd < 0; ai = ai->ai_next) {
+        int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) {
+            listenFd = fd;
+        } else {
+            message = systemError(spec.c_str());
+            ::close(fd);
+        }
+    }
+    ::freeaddrinfo(found);
+    if (listenFd < 0)
+        throw std::runtime_error(message);
+}
+
+void SolverServer::run() {
+    if (listenFd < 0)
+        throw std::runtime_error("server is not listening");
+
+    while (true) {
+        pollfd fds[2] = { { listenFd, POLLIN, 0 }, { wakePipe[0], POLLIN, 0 } };
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(systemError("poll"));
+        }
+        if (fds[1].revents != 0)
+            break;
+        if ((fds[0].revents & POLLIN) == 0)
+            continue;
+
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            // The client may have given up already; only a broken listener ends the loop
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN || errno == EMFILE || errno == ENFILE)
+                continue;
+            throw std::runtime_error(systemError("accept"));
+        }
+
+        reapConnections(false);
+        if (connections.size() >= MAX_CONNECTIONS) {
+            ::close(fd);
+            continue;
+        }
+        // Responses are small frames; waiting to coalesce them would only add latency
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        disableSigpipe(fd);
+
+        std::shared_ptr<Connection> conn = std::make_shared<Connection>(fd);
+        conn->reader = std::thread(&SolverServer::readLoop, this, conn);
+        conn->writer = std::thread(&SolverServer::writeLoop, this, conn);
+        connections.push_back(conn);
+    }
+
+    // Drain the wake pipe so the server could run again
+    char drain[16];
+    while (::read(wakePipe[0], drain, sizeof(drain)) > 0) {
+    }
+    reapConnections(true);
+}
+
+void SolverServer::stop() {
+    // write() and a lock-free store are async-signal-safe; a full pipe already has a wake-up pending
+    stopping.store(true, std::memory_order_relaxed);
+    char wake = 1;
+    ssize_t ignored = ::write(wakePipe[1], &wake, 1);
+    (void)ignored;
+}
+
+void SolverServer::reapConnections(bool all) {
+    if (all) {
+        for (const std::shared_ptr<Connection>& conn : connections) {
+            if (!conn->finished.load())
+                ::shutdown(conn->fd, SHUT_RDWR);
+        }
+    }
+    std::vector<std::shared_ptr<Connection>> open;
+    for (const std::shared_ptr<Connection>& conn : connections) {
+        if (all || conn->finished.load()) {
+            conn->reader.join();
+            conn->writer.join();
+            ::close(conn->fd);
+        } else {
+            open.push_back(conn);
+        }
+    }
+    connections.swap(open);
+}
+
+void SolverServer::readLoop(std::shared_ptr<Connection> conn) {
+    unsigned char header[HEADER_BYTES];
+    while (readFully(conn->fd, header, HEADER_BYTES)) {
+        // The id (bytes 0..3) is only echoed back, so the header is copied as is
+        size_t count = (size_t)header[4] | (size_t)header[5] << 8;
+        if (count == 0 || count > MAX_BATCH)
+            break;
+
+        std::shared_ptr<Job> job = std::make_shared<Job>();
+        job->puzzles.resize(count * NIBBLE_PUZZLE_BYTES);
+        if (!readFully(conn->fd, job->puzzles.data(), job->puzzles.size()))
+            break;
+        job->response.assign(HEADER_BYTES + count * NIBBLE_PUZZLE_BYTES, 0);
+        std::copy(header, header + HEADER_BYTES, job->response.begin());
+        job->remaining = (count + BatchSolver::TASK_SIZE - 1) / BatchSolver::TASK_SIZE;
+
+        {
+            // Backpressure: while this connection owes too much, leave the rest in the socket
+            std::unique_lock<std::mutex> lock(conn->mutex);
+            conn->cv.wait(lock, [&] { return conn->broken || conn->inFlight + count <= MAX_IN_FLIGHT; });
+            if (conn->broken)
+                break;
+            conn->inFlight += count;
+        }
+
+        for (size_t first = 0; first < count; first += BatchSolver::TASK_SIZE) {
+            size_t last = std::min(first + BatchSolver::TASK_SIZE, count);
+            pool.submit([this, conn, job, first, last](ui worker) {
+                SolveStats& stats = perWorker[worker].stats;
+                SolveCounters* counters = counting ? &perWorker[worker].counters : nullptr;
+                char cells[BatchSolver::LINE_SIZE];
+                for (size_t i = first; i < last; i++) {
+                    unsigned char* solution = job->response.data() + HEADER_BYTES + i * NIBBLE_PUZZLE_BYTES;
+                    std::array<ulli, 12> data;
+                    if (!decodePackedPuzzle(job->puzzles.data() + i * NIBBLE_PUZZLE_BYTES, data)) {
+                        stats.puzzles++;
+                        continue;
+                    }
+                    SolveStatus status = BatchSolver::solveOne(data, cells, stats, rules, branching, cache, counters, &budget);
+                    if (status == SOLVE_SOLVED)
+                        packNibbles(cells, solution);
+                    else if (status != SOLVE_NO_SOLUTION)
+                        std::fill(solution, solution + NIBBLE_PUZZLE_BYTES, 0xFF);
+                }
+                if (job->remaining.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lock(conn->mutex);
+                    conn->outbox.push_back(std::move(job->response));
+                    conn->cv.notify_all();
+                }
+            });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    conn->readerDone = true;
+    conn->cv.notify_all();
+}
+
+void SolverServer::writeLoop(std::shared_ptr<Connection> conn) {
+    std::unique_lock<std::mutex> lock(conn->mutex);
+    while (true) {
+        conn->cv.wait(lock, [&] { return !conn->outbox.empty() || (conn->readerDone && conn->inFlight == 0); });
+        if (conn->outbox.empty())
+            break;
+
+        std::vector<unsigned char> frame = std::move(conn->outbox.front());
+        conn->outbox.pop_front();
+        lock.unlock();
+        bool sent = !conn->broken && writeFully(conn->fd, frame.data(), frame.size());
+        lock.lock();
+
+        if (!sent && !conn->broken) {
+            // The client is gone: stop reading from it, and drop what is still being solved
+            conn->broken = true;
+            ::shutdown(conn->fd, SHUT_RD);
+        }
+        conn->inFlight -= (frame.size() - HEADER_BYTES) / NIBBLE_PUZZLE_BYTES;
+        conn->cv.notify_all();
+    }
+    // Tell the client no more responses follow
+    ::shutdown(conn->fd, SHUT_WR);
+    conn->finished = true;
+}
+
+SolveStats SolverServer::getStats() const {
+    SolveStats total = SolveStats();
+    for (const WorkerStats& w : perWorker)
+        mergeSolveStats(total, w.stats);
+    return total;
+}
+
+SolveCounters SolverServer::getCounters() const {
+    SolveCounters total = SolveCounters();
+    for (const WorkerStats& w : perWorker)
+        mergeSolveCounters(total, w.counters);
+    return total;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "SolveStats.h"
+#include "WorkStealingPool.h"
+#include "SolutionCache.h"
+#include "SolveCounters.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+/**
+ * @class SolverServer
+ * @brief Long-running solver daemon answering batches of packed puzzles over a socket.
+ *
+ * Listens on a TCP port or a Unix domain socket. Every connection sends request frames and
+ * gets one response frame per request; requests may be pipelined (sent without waiting for
+ * earlier responses), and responses come back as their batches finish, not necessarily in
+ * request order, so clients match them up by request id. All integers are little-endian:
+ *
+ *     request:  u32 id, u16 count (1..MAX_BATCH), count x 41-byte puzzles (see NibbleCodec.h)
+ *     response: u32 id, u16 count,                count x 41-byte solutions
+ *
+ * A solution is all-zero if the puzzle has no solution or is not a valid packed puzzle, and
+ * all-ones (0xFF bytes) if its search ran out of the budget set with setBudget() or was
+ * cancelled by stop().
+ * A frame with a count of 0 or above MAX_BATCH is a protocol error: the server stops reading
+ * that connection, sends the responses still owed and closes it.
+ *
+ * Batches are split into groups of BatchSolver::TASK_SIZE puzzles and solved on the pool, so
+ * the threads are shared by all connections. Each connection has a reader thread, which parses
+ * frames and submits them, and a writer thread, which sends finished responses. At most
+ * MAX_IN_FLIGHT puzzles of a connection may be queued, being solved, or waiting to be sent;
+ * beyond that the reader stops reading the socket, so a client that sends faster than the pool
+ * solves, or does not read its responses, is slowed down by the socket's flow control instead
+ * of growing the server's memory.
+ *
+ * Not available on Windows.
+ */
+class SolverServer {
+public:
+    /** Bytes of a frame header: request id and puzzle count. */
+    static const size_t HEADER_BYTES = 6;
+
+    /** Largest number of puzzles in one request frame. */
+    static const ui MAX_BATCH = 4096;
+
+    /** Largest number of unanswered puzzles of one connection. */
+    static const size_t MAX_IN_FLIGHT = 1 << 14;
+
+    /** Largest number of open connections; further clients are closed right after accept. */
+    static const ui MAX_CONNECTIONS = 64;
+
+private:
+    /**
+     * @struct Connection
+     * @brief State of one client connection, shared by its threads and its pending tasks.
+     */
+    struct Connection {
+        int fd;                                      /**< Connected socket */
+        std::mutex mutex;                            /**< Guards the fields below */
+        std::condition_variable cv;                  /**< Signals a new response or freed room */
+        std::deque<std::vector<unsigned char>> outbox;  /**< Finished response frames, oldest first */
+        size_t inFlight;                             /**< Puzzles submitted but not yet sent */
+        bool readerDone;                             /**< No further requests will be submitted */
+        bool broken;                                 /**< Sending failed; responses are dropped */
+        std::thread reader;                          /**< Runs readLoop() */
+        std::thread writer;                          /**< Runs writeLoop() */
+        std::atomic<bool> finished;                  /**< Both loops are done; fd is closed by the reaper */
+
+        explicit Connection(int fd) : fd(fd), inFlight(0), readerDone(false), broken(false), finished(false) {}
+    };
+
+    /**
+     * @struct WorkerStats
+     * @brief Per-worker statistics, padded to a cache line to avoid false sharing.
+     */
+    struct alignas(64) WorkerStats {
+        SolveStats stats;        /**< Counters of the puzzles this worker solved */
+        SolveCounters counters;  /**< Search counters of those puzzles, if counting is enabled */
+    };
+
+    WorkStealingPool& pool;            /**< Pool solving the puzzles */
+    RuleTier rules;                    /**< Strongest propagation rules of every board */
+    BranchStrategy branching;          /**< Branching strategy of every board */
+    SolutionCache* cache;              /**< Cache consulted before solving, or nullptr */
+    bool counting;                     /**< Whether the workers fill their SolveCounters */
+    std::atomic<bool> stopping;        /**< Set by stop(); cancels the searches in progress */
+    SolveBudget budget;                /**< Limits of every search, always watching stopping */
+    std::vector<WorkerStats> perWorker;  /**< Statistics of each pool worker */
+    int listenFd;                      /**< Listening socket, or -1 */
+    int wakePipe[2];                   /**< stop() writes to [1] to wake run() polling [0] */
+    std::string unixPath;              /**< Path of the Unix socket to remove, or empty */
+    std::vector<std::shared_ptr<Connection>> connections;  /**< Open connections (owned by run()) */
+
+    /**
+     * @brief Read request frames from a connection and submit them until it ends.
+     * @param conn Connection to read.
+     */
+    void readLoop(std::shared_ptr<Connection> conn);
+
+    /**
+     * @brief Send finished responses of a connection until the reader is done and none are owed.
+     * @param conn Connection to write.
+     */
+    void writeLoop(std::shared_ptr<Connection> conn);
+
+    /**
+     * @brief Close connections whose loops are done and join their threads.
+     * @param all Also shut down the sockets of the others and wait for them.
+     */
+    void reapConnections(bool all);
+
+public:
+    /**
+     * @brief Constructor.
+     * @param pool Pool to solve on; must outlive the server and run no other work meanwhile.
+     * @param rules Strongest propagation rules to solve with.
+     * @param branching Branching strategy to solve with.
+     */
+    SolverServer(WorkStealingPool& pool, RuleTier rules = RULES_SINGLES, BranchStrategy branching = BRANCH_MRV);
+
+    /**
+     * @brief Stop listening and close all connections.
+     */
+    ~SolverServer();
+
+    SolverServer(const SolverServer&) = delete;
+    SolverServer& operator=(const SolverServer&) = delete;
+
+    /**
+     * @brief Consult a solution cache before solving each puzzle.
+     * @param cache Cache shared by all connections, or nullptr to always solve; must outlive the server.
+     */
+    void setCache(SolutionCache* cache);
+
+    /**
+     * @brief Profile every search with SolveCounters (see BatchSolver::enableCounters()).
+     * @param enable true to count; call before run().
+     */
+    void enableCounters(bool enable);
+
+    /**
+     * @brief Stop the search of any puzzle that takes too long (see BatchSolver::setBudget()).
+     * @param maxNodes Search nodes allowed per puzzle, 0 for no limit.
+     * @param maxMicros Microseconds allowed per puzzle, 0 for no limit; call before run().
+     */
+    void setBudget(ulli maxNodes, ulli maxMicros);
+
+    /**
+     * @brief Open the listening socket.
+     *
+     * @param address "unix:PATH" for a Unix domain socket, "HOST:PORT" for TCP on that
+     *                interface (e.g. "0.0.0.0:5000" for all), or "PORT" for TCP on loopback only.
+     *                A stale socket file at PATH is replaced.
+     * @throws std::invalid_argument if the address cannot be parsed.
+     * @throws std::runtime_error if the socket cannot be set up.
+     */
+    void listen(const char* address);
+
+    /**
+     * @brief Accept and serve connections until stop() is called.
+     *
+     * All connections are closed before returning; responses still owed are dropped.
+     *
+     * @throws std::runtime_error if listen() has not succeeded or accepting fails.
+     */
+    void run();
+
+    /**
+     * @brief Make run() return, cancelling the searches in progress. May be called from any
+     *        thread and from a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Statistics of all puzzles solved so far.
+     * @return Counters merged over all workers; only exact once run() has returned.
+     */
+    SolveStats getStats() const;
+
+    /**
+     * @brief Search counters of all puzzles solved so far.
+     * @return Counters merged over all workers; all zero unless enabled, only exact once run() has returned.
+     */
+    SolveCounters getCounters() const;
+};
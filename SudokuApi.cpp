@@ -0,0 +1,87 @@
+#include "SudokuApi.h"
+#include "SudokuBoard.h"
+#include "Multiversion.h"
+#include "SolveStats.h"
+#include "Version.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+/**
+ * @struct SudokuCancelToken
+ * @brief The flag behind the opaque C handle.
+ */
+struct SudokuCancelToken {
+    std::atomic<bool> cancelled;  /**< Set by sudokuCancelTokenCancel() */
+};
+
+/**
+ * @brief Solve a puzzle within a budget and report it the C API way.
+ * @param puzzle81 81 characters of the puzzle.
+ * @param out81 Receives the solution or 81 '.'.
+ * @param budget Limits of the search, or nullptr for none.
+ * @param stats Counters to add to, or nullptr.
+ * @return Result code of sudokuSolveWithin().
+ */
+SUDOKU_MULTIVERSIONED static int solvePuzzle(const char* puzzle81, char* out81, const SolveBudget* budget, SolveStats* stats) {
+    if (puzzle81 == nullptr || out81 == nullptr)
+        return -1;
+
+    SolveStats local = SolveStats();
+    SudokuBoard board(SudokuBoard::parseData(puzzle81));
+    bool assigned[81] = {};
+    StatsListener listener(local);
+
+    auto start = std::chrono::steady_clock::now();
+    SolveStatus status = budget != nullptr
+        ? board.solveWithin(*budget, assigned, listener)
+        : (board.dfsSolve(assigned, listener) ? SOLVE_SOLVED : SOLVE_NO_SOLUTION);
+    auto end = std::chrono::steady_clock::now();
+    local.micros = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    // The puzzle is fully parsed above, so out81 may alias it
+    bool solved = status == SOLVE_SOLVED;
+    if (solved)
+        board.writeValues(out81);
+    else
+        std::fill(out81, out81 + 81, '.');
+
+    local.puzzles = 1;
+    local.solved = solved ? 1 : 0;
+    local.overBudget = status == SOLVE_BUDGET_EXCEEDED || status == SOLVE_CANCELLED ? 1 : 0;
+    if (stats != nullptr)
+        mergeSolveStats(*stats, local);
+    switch (status) {
+    case SOLVE_SOLVED: return 1;
+    case SOLVE_BUDGET_EXCEEDED: return SUDOKU_BUDGET_EXCEEDED;
+    case SOLVE_CANCELLED: return SUDOKU_CANCELLED;
+    default: return 0;
+    }
+}
+
+int sudokuSolve(const char* puzzle81, char* out81, SolveStats* stats) {
+    return solvePuzzle(puzzle81, out81, nullptr, stats);
+}
+
+SudokuCancelToken* sudokuCancelTokenCreate(void) {
+    return new SudokuCancelToken{ { false } };
+}
+
+void sudokuCancelTokenCancel(SudokuCancelToken* token) {
+    token->cancelled.store(true, std::memory_order_relaxed);
+}
+
+void sudokuCancelTokenDestroy(SudokuCancelToken* token) {
+    delete token;
+}
+
+int sudokuSolveWithin(const char* puzzle81, char* out81, unsigned long long maxNodes, unsigned long long maxMicros,
+                      const SudokuCancelToken* token, SolveStats* stats) {
+    SolveBudget budget = { maxNodes, maxMicros, token != nullptr ? &token->cancelled : nullptr };
+    return solvePuzzle(puzzle81, out81, &budget, stats);
+}
+
+const char* sudokuVersion(void) {
+    return PROGRAM_VERSION;
+}
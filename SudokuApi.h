@@ -0,0 +1,87 @@
+#pragma once
+
+#include "SolveStats.h"
+
+/**
+ * @file
+ * @brief C-compatible entry points of the solver library, for embedding without the console program.
+ *
+ * The functions are reentrant: every call works on its own board, so several threads may
+ * solve at the same time. Link against the SudokuLibrary target (libsudoku).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Solve one 9x9 puzzle.
+ *
+ * @param puzzle81 81 characters, row-major; '1'..'9' are givens, any other character is an
+ *                 empty cell. Need not be NUL-terminated.
+ * @param out81 Receives 81 characters (no NUL): the solution, or 81 '.' if the puzzle has
+ *              no solution. May be the same buffer as puzzle81.
+ * @param stats If not NULL, the counters of this solve (puzzles, solved, assignments,
+ *              simplifications, micros) are added to it.
+ * @return 1 if solved, 0 if the puzzle has no solution, -1 if puzzle81 or out81 is NULL.
+ */
+int sudokuSolve(const char* puzzle81, char* out81, SolveStats* stats);
+
+/** Result of sudokuSolveWithin() when the node or time budget ran out first. */
+#define SUDOKU_BUDGET_EXCEEDED 2
+/** Result of sudokuSolveWithin() when the cancellation token was set first. */
+#define SUDOKU_CANCELLED 3
+
+/**
+ * @brief Flag that stops the budgeted solves watching it; safe to set from any thread.
+ */
+typedef struct SudokuCancelToken SudokuCancelToken;
+
+/**
+ * @brief Create a cancellation token, not set.
+ * @return New token, to be released with sudokuCancelTokenDestroy().
+ */
+SudokuCancelToken* sudokuCancelTokenCreate(void);
+
+/**
+ * @brief Set a token: the solves watching it stop at their next check.
+ * @param token Token to set.
+ */
+void sudokuCancelTokenCancel(SudokuCancelToken* token);
+
+/**
+ * @brief Release a token once no solve watches it any more.
+ * @param token Token to release, or NULL.
+ */
+void sudokuCancelTokenDestroy(SudokuCancelToken* token);
+
+/**
+ * @brief Solve one 9x9 puzzle within a budget.
+ *
+ * Same search and outcome as sudokuSolve() when the puzzle is done within the budget. The
+ * search stops after maxNodes search nodes, after maxMicros microseconds, or once token is
+ * set, whichever comes first; the time and the token are checked every 64 nodes. The node
+ * budget stops a puzzle at the same point on every run.
+ *
+ * @param puzzle81 81 characters, as for sudokuSolve().
+ * @param out81 Receives the solution, or 81 '.' if there is none or the search stopped.
+ * @param maxNodes Search nodes allowed, 0 for no limit.
+ * @param maxMicros Microseconds allowed, 0 for no limit.
+ * @param token Cancellation token, or NULL.
+ * @param stats If not NULL, the counters of the solve are added to it, those of the partial
+ *              search when it stopped (puzzles, micros and overBudget counted, solved not).
+ * @return 1 if solved, 0 if there is no solution, SUDOKU_BUDGET_EXCEEDED, SUDOKU_CANCELLED,
+ *         or -1 if puzzle81 or out81 is NULL.
+ */
+int sudokuSolveWithin(const char* puzzle81, char* out81, unsigned long long maxNodes, unsigned long long maxMicros,
+                      const SudokuCancelToken* token, SolveStats* stats);
+
+/**
+ * @brief Get the version of the library.
+ * @return Static string such as "SudokuSolver v1.1.4".
+ */
+const char* sudokuVersion(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,198 +1,173 @@
 #include "SudokuBoard.h"
+#include "Multiversion.h"
 
-#include <functional>
 #include <stdexcept>
 #include <iostream>
 #include <utility>
 #include <vector>
+#include <cstring>
 #include <array>
+#include <bit>
 
+/** Command line names of the branching strategies, indexed by BranchStrategy. */
+static const char* const BRANCH_STRATEGY_NAMES[4] = { "mrv", "degree", "house", "restarts" };
 
-
-Tuple2::Tuple2(uc x_val, uc y_val)
-    : x(x_val), y(y_val) {}
-uc Tuple2::getX() const {
-    return x;
-}
-uc Tuple2::getY() const {
-    return y;
-}
-
-GPos::GPos() : Tuple2(0, 0) {}
-GPos::GPos(uc x, uc y) : Tuple2(x, y) {}
-
-ui SudokuBoard::gpos2bitsetIndex(GPos gpos) {
-    // Compute a 0-based cell index from (x,y), then multiply by 9 for candidate bits
-    ui cellIndex = (ui)gpos.getX() + (ui)gpos.getY() * 9u;
-    return cellIndex * 9u;
+const char* branchStrategyName(BranchStrategy strategy) {
+    return BRANCH_STRATEGY_NAMES[strategy];
 }
 
-bool SudokuBoard::dfsSolve(SudokuBoard& board, std::vector<ui>& path, bool assigned[81],
-    std::function<void(const std::vector<ui>& path, const bool assigned[81], const GPos& justAssigned)> assignListener,
-    std::function<void(const std::vector<ui>& path, const ui& index, const ui& eliminated, const ulli& eliminatedSum, const bool isFirstSimplificationGroup, const bool assigned[81])> simplifyListener,
-    std::function<void(const std::vector<ui>& path, const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener, bool isFirst) {
-    // First, repeatedly simplify the board using logical rules
-    ulli totalEliminations;
-    if (!board.simplifyToTheEnd(
-        totalEliminations,
-        // Wrap the simplifyListener to include path and isFirst flag
-        [path, simplifyListener, isFirst, assigned](ui i, ui elim, ui elimSum) {
-            simplifyListener(path, i, elim, elimSum, isFirst, assigned);
-        },
-        // Wrap the eliminateListener for each individual elimination event
-        [path, eliminateListener](const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by) {
-            eliminateListener(path, cause, cell, value, by);
-        })
-        ) {
-        // Contradiction found during simplification
-        return false;
-    }
-
-    // If all cells now have exactly one candidate, puzzle is solved
-    if (board.isSolved())
-        return true;
-
-    // Choose next cell by MRV (minimum remaining values)
-    auto [pos, count] = board.findMRVCell();
-    if (count == 0) {
-        // No candidates left for some cell => dead end
-        return false;
+bool parseBranchStrategy(const char* name, BranchStrategy& strategy) {
+    for (int i = 0; i < 4; i++) {
+        if (std::strcmp(name, BRANCH_STRATEGY_NAMES[i]) == 0) {
+            strategy = (BranchStrategy)i;
+            return true;
+        }
     }
+    return false;
+}
 
-    uc x = pos.getX();
-    uc y = pos.getY();
-
-    // Retrieve list of possible values for this cell
-    std::vector<uc> candidates = getCandiatesAt(pos);
-
-    // Mark this cell as assigned in the local boolean array
-    assigned[x + 9 * y] = true;
-    ui branchIndex = 0;
-
-    // Try each candidate in turn
-    for (uc v : candidates) {
-        // Save current bitset to history for rollback if needed
-        std::array<ulli, 12> history = board.copyData();
+/** Command line names of the rule tiers, indexed by RuleTier. */
+static const char* const RULE_TIER_NAMES[4] = { "singles", "locked", "pairs", "triples" };
 
-        // Force this cell to value v (eliminate other bits)
-        board.makeSureAt(pos, v, false);
-        // Record which branch we're taking
-        path.push_back(branchIndex++);
-        // Notify listener that a value was assigned
-        assignListener(path, assigned, pos);
+const char* ruleTierName(RuleTier tier) {
+    return RULE_TIER_NAMES[tier];
+}
 
-        // Recurse
-        if (dfsSolve(board, path, assigned, assignListener, simplifyListener, eliminateListener, false))
+bool parseRuleTier(const char* name, RuleTier& tier) {
+    for (int i = 0; i < 4; i++) {
+        if (std::strcmp(name, RULE_TIER_NAMES[i]) == 0) {
+            tier = (RuleTier)i;
             return true;
-
-        // If recursion failed, rollback board state and path
-        path.pop_back();
-        board = SudokuBoard(history);
+        }
     }
-
-    // Unmark assignment on backtrack
-    assigned[x + 9 * y] = false;
     return false;
 }
 
+/** Metric names of the causes, indexed by cause - NO_PLACE_POSSIBLE. */
+static const char* const CAUSE_NAMES[SIMPLIFICATION_CAUSE_COUNT] = {
+    "no_place_possible", "no_value_possible", nullptr,
+    "elimination_by_row", "elimination_by_column", "elimination_by_chunk",
+    "value_sure_by_row", "value_sure_by_column", "value_sure_by_chunk",
+    "locked_candidate_by_row", "locked_candidate_by_column", "locked_candidate_by_chunk",
+    "naked_pair_by_row", "naked_pair_by_column", "naked_pair_by_chunk",
+    "hidden_pair_by_row", "hidden_pair_by_column", "hidden_pair_by_chunk",
+    "naked_triple_by_row", "naked_triple_by_column", "naked_triple_by_chunk",
+    "hidden_triple_by_row", "hidden_triple_by_column", "hidden_triple_by_chunk"
+};
+
+const char* simplificationCauseName(SimplificationCause cause) {
+    int index = (int)cause - NO_PLACE_POSSIBLE;
+    return index >= 0 && index < (int)SIMPLIFICATION_CAUSE_COUNT ? CAUSE_NAMES[index] : nullptr;
+}
 
 SudokuBoard::SudokuBoard() {
     // Initialize all bits to 1 (all candidates possible for every cell)
-    for (uc i = 0; i < 12; i++) {
-        bitset[i] = ~0ULL;
+    cells.fill(0x1FF);
+    placed.fill(0);
+    // Everything is new to propagate()
+    dirty = { ~0ULL, (1ULL << (81 - 64)) - 1 };
+    dirtyHouses = (1u << 27) - 1;
+    trail = nullptr;
+    backtrackMode = BACKTRACK_TRAIL;
+    ruleTier = RULES_SINGLES;
+    branchStrategy = BRANCH_MRV;
+    randomSeed = 1;
+    table = nullptr;
+    rebuildCounts();
+    rebuildHash();
+}
+SudokuBoard::SudokuBoard(std::array<ulli, 12> data) {
+    // Unpack 9 bits per cell; a cell's bits may straddle two 64-bit words
+    for (ui i = 0; i < 81; i++) {
+        ui bit_index = i * 9u;
+        ui bsci = bit_index / 64;
+        ui bsii = bit_index % 64;
+        ulli bits = data[bsci] >> bsii;
+        if (bsii > 64 - 9)
+            bits |= data[bsci + 1] << (64 - bsii);
+        cells[i] = (us)(bits & 0x1FF);
     }
+    placed.fill(0);
+    dirty = { ~0ULL, (1ULL << (81 - 64)) - 1 };
+    dirtyHouses = (1u << 27) - 1;
+    trail = nullptr;
+    backtrackMode = BACKTRACK_TRAIL;
+    ruleTier = RULES_SINGLES;
+    branchStrategy = BRANCH_MRV;
+    randomSeed = 1;
+    table = nullptr;
+    rebuildCounts();
+    rebuildHash();
 }
-SudokuBoard::SudokuBoard(std::array<ulli, 12> data) : bitset(data) {}
 
-// MOVE: Simply steal the bitset contents from other
-SudokuBoard::SudokuBoard(SudokuBoard&& other) noexcept {
-    std::copy(std::begin(other.bitset), std::end(other.bitset), std::begin(this->bitset));
-}
+// MOVE: Simply copy the mask arrays of other (a running search's trail stays with other)
+SudokuBoard::SudokuBoard(SudokuBoard&& other) noexcept
+    : cells(other.cells), placed(other.placed), dirty(other.dirty), dirtyHouses(other.dirtyHouses),
+      trail(nullptr), backtrackMode(other.backtrackMode), ruleTier(other.ruleTier),
+      branchStrategy(other.branchStrategy), randomSeed(other.randomSeed), hash(other.hash), table(other.table),
+      byCount(other.byCount) {}
 SudokuBoard& SudokuBoard::operator=(SudokuBoard&& other) noexcept {
     if (this != &other) {
-        std::copy(std::begin(other.bitset), std::end(other.bitset), std::begin(this->bitset));
+        cells = other.cells;
+        placed = other.placed;
+        dirty = other.dirty;
+        dirtyHouses = other.dirtyHouses;
+        backtrackMode = other.backtrackMode;
+        ruleTier = other.ruleTier;
+        branchStrategy = other.branchStrategy;
+        randomSeed = other.randomSeed;
+        hash = other.hash;
+        table = other.table;
+        byCount = other.byCount;
     }
     return *this;
 }
 
 // ---------------- Candidate management ----------------
 
-void SudokuBoard::makeSureAt(const GPos gpos, const uc value, const bool force) {
-    // To set cell to 'value', eliminate all other candidate bits
-    for (uc v = 1; v <= 9; v++) {
-        if (v == value) {
-            if (force)
-                // If forcing, ensure this bit is turned on even if it was off
-                setPossibleAt(gpos, v, true);
-            // If not forcing, leave the bit as-is (if it was already off, we keep it off)
-        } else {
-            // Eliminate all other values
-            setPossibleAt(gpos, v, false);
-        }
-    }
-}
-
 bool SudokuBoard::isPossibleAt(const GPos gpos, const uc value) const {
     if (!(1 <= value && value <= 9))
         throw std::invalid_argument("SudokuBoard::isPossibleAt: value out of range.");
 
-    // Compute the flat bit index corresponding to (gpos, value)
-    ui base_index = gpos2bitsetIndex(gpos);         // cellIndex * 9
-    ui bit_index = base_index + (value - 1); // 0..728
-
-    // Determine which 64-bit block and bit offset within that block
-    ui bsci = bit_index / 64;
-    ui bsii = bit_index % 64;
     // Return true if that bit is set
-    return (bitset[bsci] & (1ULL << bsii)) != 0ULL;
+    return (cells[gpos2CellIndex(gpos)] & (1u << (value - 1))) != 0;
 }
 
 bool SudokuBoard::setPossibleAt(const GPos gpos, const uc value, const bool isPossible) {
     if (!(1 <= value && value <= 9))
         throw std::invalid_argument("SudokuBoard::setPossibleAt: value out of range.");
 
-    // Compute flat bit index
-    ui base_index = gpos2bitsetIndex(gpos);
-    ui bit_index = base_index + (value - 1);
-    // Locate block and offset
-    ui bsci = bit_index / 64;
-    ui bsii = bit_index % 64;
-    ulli mask = (1ULL << bsii);
+    ui index = gpos2CellIndex(gpos);
+    us bit = (us)(1u << (value - 1));
 
     // Check current bit state
-    bool currently = (bitset[bsci] & mask) != 0ULL;
+    bool currently = (cells[index] & bit) != 0;
     if (currently == isPossible) {
         // No change needed
         return false;
     }
 
     if (isPossible) {
-        // Turn bit on
-        bitset[bsci] |= mask;
+        // Turn bit on; the value may no longer be placed in this cell's houses
+        setCell(index, cells[index] | bit);
+        unplace(index, bit);
     } else {
         // Turn bit off
-        bitset[bsci] &= ~mask;
+        setCell(index, cells[index] & (us)~bit);
     }
 
     return true;
 }
 
 uc SudokuBoard::getCellInfoAt(const GPos gpos, uc& count) const {
-    count = 0;
-    uc onlyValue = 0;
-    // Count how many candidate bits are set, remember last seen value
-    for (uc v = 1; v <= 9; v++) {
-        if (isPossibleAt(gpos, v)) {
-            onlyValue = v;
-            count++;
-            if (count > 1) {
-                // We don't stop early; we want count to reflect >1
-                continue;
-            }
-        }
-    }
+    us mask = cells[gpos2CellIndex(gpos)];
+    count = (uc)std::popcount(mask);
     // If exactly one candidate, return it; otherwise return 0
-    return (count == 1 ? onlyValue : 0);
+    return (count == 1 ? (uc)(std::countr_zero(mask) + 1) : 0);
+}
+
+us SudokuBoard::getCandidateMaskAt(const GPos gpos) const {
+    return cells[gpos2CellIndex(gpos)];
 }
 
 uc SudokuBoard::getOnlyPossibleValue(const GPos gpos) const {
@@ -208,255 +183,171 @@ uc SudokuBoard::getPossiblesCountAt(const GPos gpos) const {
 
 std::vector<uc> SudokuBoard::getCandiatesAt(const GPos gpos) const {
     std::vector<uc> candidates;
-    // Collect all values v where the bit is set
-    for (uc v = 1; v <= 9; v++) {
-        if (this->isPossibleAt(gpos, v)) {
-            candidates.push_back(v);
-        }
+    // Collect all values v where the bit is set, lowest first
+    for (us mask = cells[gpos2CellIndex(gpos)]; mask != 0; mask &= mask - 1) {
+        candidates.push_back((uc)(std::countr_zero(mask) + 1));
     }
     return candidates;
 }
 
-bool SudokuBoard::simplify(ui& eliminations, std::function<void(const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eventListener) {
-    eliminations = 0;
-    // Iterate over every cell in row-major order
-    for (uc y = 0; y < 9; y++) {
-        for (uc x = 0; x < 9; x++) {
-            GPos selfPos(x, y);
-            uc count;
-            uc onlyVal = getCellInfoAt(selfPos, count);
-
-            if (count == 0) {
-                // No candidates => contradiction
-                eventListener(NO_VALUE_POSSIBLE, selfPos, 0, 0);
-                return false;
-            }
-
-            // Compute chunk coordinates
-            uc chunkX = x / 3;
-            uc chunkY = y / 3;
-            uc chunkStartX = chunkX * 3;
-            uc chunkStartY = chunkY * 3;
-
-            if (count == 1) {
-                // Naked Single: eliminate this fixed value from peers
-
-                // Eliminate from row
-                for (uc cx = 0; cx < 9; cx++) {
-                    if (cx == x) continue;
-                    GPos peer(cx, y);
-                    if (isPossibleAt(peer, onlyVal)) {
-                        setPossibleAt(peer, onlyVal, false);
-                        eliminations++;
-                        eventListener(ELIMINATION_BY_ROW, peer, onlyVal, y);
-                    }
-                }
-                // Eliminate from column
-                for (uc cy = 0; cy < 9; cy++) {
-                    if (cy == y) continue;
-                    GPos peer(x, cy);
-                    if (isPossibleAt(peer, onlyVal)) {
-                        setPossibleAt(peer, onlyVal, false);
-                        eliminations++;
-                        eventListener(ELIMINATION_BY_COLUMN, peer, onlyVal, x);
-                    }
-                }
-                // Eliminate from chunk
-                for (uc by = chunkStartY; by < chunkStartY + 3; by++) {
-                    for (uc bx = chunkStartX; bx < chunkStartX + 3; bx++) {
-                        if (bx == x && by == y) continue;
-                        GPos peer(bx, by);
-                        if (isPossibleAt(peer, onlyVal)) {
-                            setPossibleAt(peer, onlyVal, false);
-                            eliminations++;
-                            // Pass chunk index as chunkX + 3*chunkY
-                            eventListener(ELIMINATION_BY_CHUNK, peer, onlyVal, chunkX + 3 * chunkY);
-                        }
-                    }
-                }
-            }
-
-            // Re-evaluate candidate count after naked single elimination
-            onlyVal = getCellInfoAt(selfPos, count);
-            if (count == 0) {
-                eventListener(NO_VALUE_POSSIBLE, selfPos, 0, 0);
-                return false;
-            }
-            if (count == 1)
-                continue; // Already handled as Naked Single
-
-            // Hidden Single checks: for each candidate v,
-            // see if it's unique in row, column, or chunk
-            for (uc v = 1; v <= 9; v++) {
-                if (!isPossibleAt(selfPos, v)) continue;
-                bool success;
-
-                // Check row uniqueness
-                success = true;
-                for (uc cx = 0; cx < 9; cx++) {
-                    if (cx == x) continue;
-                    GPos peer(cx, y);
-                    if (isPossibleAt(peer, v)) {
-                        success = false;
-                    }
-                }
-                if (success) {
-                    eliminations += count - 1;
-                    makeSureAt(selfPos, v, false);
-                    eventListener(VALUE_SURE_BY_ROW, selfPos, v, y);
-                    continue;
-                }
-
-                // Check column uniqueness
-                success = true;
-                for (uc cy = 0; cy < 9; cy++) {
-                    if (cy == y) continue;
-                    GPos peer(x, cy);
-                    if (isPossibleAt(peer, v)) {
-                        success = false;
-                    }
-                }
-                if (success) {
-                    eliminations += count - 1;
-                    makeSureAt(selfPos, v, false);
-                    eventListener(VALUE_SURE_BY_COLUMN, selfPos, v, x);
-                    continue;
-                }
-
-                // Check chunk uniqueness
-                success = true;
-                for (uc by = chunkStartY; by < chunkStartY + 3; by++) {
-                    for (uc bx = chunkStartX; bx < chunkStartX + 3; bx++) {
-                        if (bx == x && by == y) continue;
-                        GPos peer(bx, by);
-                        if (isPossibleAt(peer, v)) {
-                            success = false;
-                            break;
-                        }
-                    }
-                    if (!success) break;
-                }
-                if (success) {
-                    eliminations += count - 1;
-                    makeSureAt(selfPos, v, false);
-                    eventListener(VALUE_SURE_BY_CHUNK, selfPos, v, chunkX + 3 * chunkY);
-                    continue;
-                }
-            }
-        }
-    }
-    return true;
+bool SudokuBoard::hasContradiction() const {
+    // Some cell is in the bucket of cells with no candidate
+    return byCount[0][0] != 0 || byCount[0][1] != 0;
 }
 
-bool SudokuBoard::simplifyToTheEnd(ulli& totalEliminations,
-    std::function<void(const ui& index, const ui& eliminated, const ulli& eliminatedSum)> simplifyListener,
-    std::function<void(const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener) {
-    totalEliminations = 0;
-    ui index = 0;
-
-    // Keep applying simplify() until no more eliminations or contradiction
-    while (true) {
-        ui eliminated;
-        if (!this->simplify(eliminated, eliminateListener)) {
-            // A contradiction occurred in simplify()
-            totalEliminations += eliminated;
-            simplifyListener(index++, eliminated, totalEliminations);
-            return false;
-        }
-        if (eliminated == 0) break; // No further changes
-        totalEliminations += eliminated;
-        simplifyListener(index++, eliminated, totalEliminations);
-    }
-    return true;
+void SudokuBoard::rebuildCounts() {
+    for (std::array<ulli, 2>& set : byCount)
+        set = { 0, 0 };
+    for (ui i = 0; i < 81; i++)
+        byCount[std::popcount(cells[i])][i / 64] |= 1ULL << (i % 64);
 }
 
-bool SudokuBoard::isSolved() const {
-    // Check that every cell has exactly one candidate
-    for (uc y = 0; y < 9; y++) {
-        for (uc x = 0; x < 9; x++) {
-            GPos gp(x, y);
-            uc count;
-            getCellInfoAt(gp, count);
-            if (count != 1) return false;
+/**
+ * @brief Draw the Zobrist keys from a fixed splitmix64 stream, so hashes are the same in every run.
+ * @return Keys of all 81 x 9 candidates.
+ */
+static constexpr std::array<std::array<ulli, 9>, 81> makeZobristKeys() {
+    std::array<std::array<ulli, 9>, 81> keys = {};
+    ulli state = 0x5D0C0B57A7E5EEDULL;
+    for (std::array<ulli, 9>& cell : keys) {
+        for (ulli& key : cell) {
+            ulli z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            key = z ^ (z >> 31);
         }
     }
-    return true;
+    return keys;
 }
 
-bool SudokuBoard::hasContradiction() const {
-    // Check if any cell has zero candidates
-    for (uc y = 0; y < 9; y++) {
-        for (uc x = 0; x < 9; x++) {
-            uc count;
-            getCellInfoAt(GPos(x, y), count);
-            if (count == 0) return true;
-        }
+constinit const std::array<std::array<ulli, 9>, 81> SudokuBoard::ZOBRIST_KEYS = makeZobristKeys();
+
+void SudokuBoard::rebuildHash() {
+    hash = 0;
+    for (ui i = 0; i < 81; i++)
+        rehash(i, 0, cells[i]);
+}
+
+bool SudokuBoard::budgetExpired(SearchControl& control) {
+    const SolveBudget& budget = *control.budget;
+    if (budget.cancel != nullptr && budget.cancel->load(std::memory_order_relaxed))
+        control.stop = SOLVE_CANCELLED;
+    else if (budget.maxMicros != 0 && std::chrono::steady_clock::now() >= control.deadline)
+        control.stop = SOLVE_BUDGET_EXCEEDED;
+    return control.stop != SOLVE_NO_SOLUTION;
+}
+
+std::array<ulli, 12> SudokuBoard::copyData() const {
+    // Pack the cell masks into the 12-word exchange form
+    std::array<ulli, 12> data = {};
+    for (ui i = 0; i < 81; i++) {
+        ui bit_index = i * 9u;
+        ui bsci = bit_index / 64;
+        ui bsii = bit_index % 64;
+        data[bsci] |= (ulli)cells[i] << bsii;
+        if (bsii > 64 - 9)
+            data[bsci + 1] |= (ulli)cells[i] >> (64 - bsii);
     }
-    return false;
+    return data;
 }
 
-std::pair<GPos, uc> SudokuBoard::findMRVCell() const {
-    GPos bestPos(0, 0);
-    uc bestCount = 10; // Anything >9 is effectively "infinite"
-
-    // Iterate all cells to find the one with 2..9 candidates minimum
-    for (uc y = 0; y < 9; y++) {
-        for (uc x = 0; x < 9; x++) {
-            GPos gp(x, y);
-            uc count;
-            getCellInfoAt(gp, count);
-            if (count == 0) {
-                // Contradiction: return immediately with count=0
-                return { gp, 0 };
-            }
-            if (count > 1 && count < bestCount) {
-                bestCount = count;
-                bestPos = gp;
-            }
-        }
+std::array<ulli, 12> SudokuBoard::parseData(const char* cells) {
+    std::array<ulli, 12> data = {};
+    for (ui i = 0; i < 81; i++) {
+        char c = cells[i];
+        // Givens keep a single bit, everything else keeps all 9 candidates
+        ulli mask = (c >= '1' && c <= '9') ? (1ULL << (c - '1')) : 0x1FFULL;
+
+        // Place the 9 cell bits at i*9; they may straddle two 64-bit words
+        ui bit_index = i * 9u;
+        ui bsci = bit_index / 64;
+        ui bsii = bit_index % 64;
+        data[bsci] |= mask << bsii;
+        if (bsii > 64 - 9)
+            data[bsci + 1] |= mask >> (64 - bsii);
     }
-    if (bestCount == 10) {
-        // All cells have exactly 1 candidate: should be solved already
-        throw new std::runtime_error("Unexpected state in findMRVCell");
+    return data;
+}
+
+void SudokuBoard::writeValues(char* out) const {
+    for (ui i = 0; i < 81; i++) {
+        us mask = cells[i];
+        out[i] = std::popcount(mask) == 1 ? char('1' + std::countr_zero(mask)) : '.';
     }
-    return { bestPos, bestCount };
 }
 
-std::array<ulli, 12> SudokuBoard::copyData() const {
-    // Return a copy of the underlying bitset for rollback
-    return this->bitset;
+void SudokuBoard::setBacktrackMode(BacktrackMode mode) {
+    backtrackMode = mode;
 }
 
-bool SudokuBoard::dfsSolve(std::vector<ui>& path, bool assigned[81],
-    std::function<void(const std::vector<ui>& path, const bool assigned[81], const GPos& justAssigned)> assignListener,
-    std::function<void(const std::vector<ui>& path, const ui& index, const ui& eliminated, const ulli& eliminatedSum, const bool isFirstSimplificationGroup, const bool assigned[81])> simplifyListener,
-    std::function<void(const std::vector<ui>& path, const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener) {
-    // Initialize path with a dummy 0 to simplify recursion logic
-    path.clear();
-    path.push_back(0);
-    return dfsSolve(*this, path, assigned, assignListener, simplifyListener, eliminateListener, true);
+BacktrackMode SudokuBoard::getBacktrackMode() const {
+    return backtrackMode;
 }
 
-bool SudokuBoard::dfsSolve(bool assigned[81],
-    std::function<void(const std::vector<ui>& path, const bool assigned[81], const GPos& justAssigned)> assignListener,
-    std::function<void(const std::vector<ui>& path, const ui& index, const ui& eliminated, const ulli& eliminatedSum, const bool isFirstSimplificationGroup, const bool assigned[81])> simplifyListener,
-    std::function<void(const std::vector<ui>& path, const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener) {
-    // Create a local path vector and call the main recursive solver
-    std::vector<ui> path;
-    return dfsSolve(path, assigned, assignListener, simplifyListener, eliminateListener);
+void SudokuBoard::setRuleTier(RuleTier tier) {
+    ruleTier = tier;
 }
 
-bool SudokuBoard::dfsSolve(std::vector<ui>& path, bool assigned[81]) {
-    // Call DFS with empty listeners (no output)
-    return dfsSolve(path, assigned,
-        [](const std::vector<ui>& path, const bool assigned[81], const GPos& justAssigned) {},
-        [](const std::vector<ui>& path, const ui& index, const ui& eliminated, const ulli& eliminatedSum, const bool isFirstSimplificationGroup, const bool assigned[81]) {},
-        [](const std::vector<ui>& path, const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by) {}
-    );
+RuleTier SudokuBoard::getRuleTier() const {
+    return ruleTier;
+}
+
+void SudokuBoard::setBranchStrategy(BranchStrategy strategy) {
+    branchStrategy = strategy;
+}
+
+BranchStrategy SudokuBoard::getBranchStrategy() const {
+    return branchStrategy;
+}
+
+void SudokuBoard::setRandomSeed(ulli seed) {
+    // xorshift64 must not start at 0
+    randomSeed = seed != 0 ? seed : 1;
+}
+
+ulli SudokuBoard::getHash() const {
+    return hash;
+}
+
+void SudokuBoard::setTranspositionTable(TranspositionTable* table) {
+    this->table = table;
+}
+
+/**
+ * @brief Silent DFS behind dfsSolve(), multiversioned (see SUDOKU_MULTIVERSIONED).
+ *
+ * @param board Board to solve.
+ * @param path Path of the search.
+ * @param assigned Cells assigned so far.
+ * @return true if a solution was found.
+ */
+SUDOKU_MULTIVERSIONED static bool silentDfsSolve(SudokuBoard& board, SearchPath& path, bool assigned[81]) {
+    NullSolveListener listener;
+    return board.dfsSolve(path, assigned, listener);
+}
+
+/**
+ * @brief Silent solution count behind countSolutions(), multiversioned like silentDfsSolve().
+ * @param board Board to search.
+ * @param limit Stop after this many solutions.
+ * @return Solutions found.
+ */
+SUDOKU_MULTIVERSIONED static SolutionCount silentCountSolutions(SudokuBoard& board, ulli limit) {
+    NullSolveListener listener;
+    return board.countSolutions(limit, listener);
+}
+
+bool SudokuBoard::dfsSolve(SearchPath& path, bool assigned[81]) {
+    // Call DFS with the listener policy that ignores everything (no output)
+    return silentDfsSolve(*this, path, assigned);
 }
 
 bool SudokuBoard::dfsSolve(bool assigned[81]) {
     // Simplest entry point: create path internally
-    std::vector<ui> path;
-    return dfsSolve(path, assigned);
-}
\ No newline at end of file
+    SearchPath path;
+    return silentDfsSolve(*this, path, assigned);
+}
+
+SolutionCount SudokuBoard::countSolutions(ulli limit) {
+    return silentCountSolutions(*this, limit);
+}
@@ -1,30 +1,76 @@
 #pragma once
 
-#include <functional>
 #include <stdexcept>
 #include <iostream>
 #include <utility>
 #include <vector>
 #include <array>
+#include <bit>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include "BoardGeometry.h"
+#include "SolveStats.h"
+#include "TranspositionTable.h"
 
 typedef unsigned long long int ulli;  /**< 64-bit unsigned integer alias for bit operations */
 typedef unsigned char uc;             /**< 8-bit unsigned integer alias for small values */
 typedef unsigned int ui;              /**< 32-bit unsigned integer alias for indices or counters */
+typedef unsigned short us;            /**< 16-bit unsigned integer alias for per-cell candidate masks */
 
 /**
  * @enum SimplificationCause
  * @brief Causes for candidate elimination or determination during simplification.
  */
 enum SimplificationCause {
+    NO_PLACE_POSSIBLE = -2,        /**< No cell of a house can hold some value, indicates contradiction.
+                                        Reported with the house's first cell and house index 0..26 as "by" */
     NO_VALUE_POSSIBLE = -1,        /**< No candidate possible for a cell, indicates contradiction */
     ELIMINATION_BY_ROW = 1,        /**< Candidate eliminated because same row has a determined value */
     ELIMINATION_BY_COLUMN = 2,     /**< Candidate eliminated because same column has a determined value */
     ELIMINATION_BY_CHUNK = 3,      /**< Candidate eliminated because same 33 chunk has a determined value */
     VALUE_SURE_BY_ROW = 4,         /**< Cell value determined uniquely by row constraint */
     VALUE_SURE_BY_COLUMN = 5,      /**< Cell value determined uniquely by column constraint */
-    VALUE_SURE_BY_CHUNK = 6        /**< Cell value determined uniquely by chunk constraint */
+    VALUE_SURE_BY_CHUNK = 6,       /**< Cell value determined uniquely by chunk constraint */
+    LOCKED_CANDIDATE_BY_ROW = 7,     /**< Candidate eliminated from a chunk because the row's only places for it are
+                                          in that chunk (claiming); "by" is the row */
+    LOCKED_CANDIDATE_BY_COLUMN = 8,  /**< Claiming as above for a column; "by" is the column */
+    LOCKED_CANDIDATE_BY_CHUNK = 9,   /**< Candidate eliminated from a row or column because the chunk's only places
+                                          for it are on that line (pointing); "by" is the chunk */
+    NAKED_PAIR_BY_ROW = 10,        /**< Candidate eliminated because two other cells of the row hold the same two values */
+    NAKED_PAIR_BY_COLUMN = 11,     /**< Naked pair in a column */
+    NAKED_PAIR_BY_CHUNK = 12,      /**< Naked pair in a chunk */
+    HIDDEN_PAIR_BY_ROW = 13,       /**< Candidate eliminated because two values of the row fit only in this cell and one other */
+    HIDDEN_PAIR_BY_COLUMN = 14,    /**< Hidden pair in a column */
+    HIDDEN_PAIR_BY_CHUNK = 15,     /**< Hidden pair in a chunk */
+    NAKED_TRIPLE_BY_ROW = 16,      /**< Candidate eliminated because three other cells of the row hold only three values */
+    NAKED_TRIPLE_BY_COLUMN = 17,   /**< Naked triple in a column */
+    NAKED_TRIPLE_BY_CHUNK = 18,    /**< Naked triple in a chunk */
+    HIDDEN_TRIPLE_BY_ROW = 19,     /**< Candidate eliminated because three values of the row fit only in three cells, this one included */
+    HIDDEN_TRIPLE_BY_COLUMN = 20,  /**< Hidden triple in a column */
+    HIDDEN_TRIPLE_BY_CHUNK = 21    /**< Hidden triple in a chunk */
 };
 
+/**
+ * @brief Check whether a cause reports an assignment (hidden single) rather than an elimination.
+ * @param cause Cause of a simplification event (not a contradiction).
+ * @return true for VALUE_SURE_BY_ROW, VALUE_SURE_BY_COLUMN and VALUE_SURE_BY_CHUNK.
+ */
+inline bool isAssignmentCause(SimplificationCause cause) {
+    return VALUE_SURE_BY_ROW <= cause && cause <= VALUE_SURE_BY_CHUNK;
+}
+
+/** Number of values from NO_PLACE_POSSIBLE to HIDDEN_TRIPLE_BY_CHUNK (0 is no cause). */
+static const ui SIMPLIFICATION_CAUSE_COUNT = HIDDEN_TRIPLE_BY_CHUNK - NO_PLACE_POSSIBLE + 1;
+
+/**
+ * @brief Get the metric name of a cause.
+ * @param cause Simplification cause.
+ * @return Lower-case name such as "elimination_by_row", or nullptr if the value is no cause.
+ */
+const char* simplificationCauseName(SimplificationCause cause);
+
 /**
  * @class Tuple2
  * @brief Simple 2D coordinate pair class.
@@ -78,66 +124,651 @@ public:
     GPos(uc x, uc y);
 };
 
+/**
+ * @class SearchPath
+ * @brief Fixed-capacity stack of DFS branch indices.
+ *
+ * Holds the leading dummy 0 plus one entry per assigned cell, so 82 entries always
+ * suffice and the solver never allocates while descending. Read like the former
+ * std::vector<ui> path: size() and operator[].
+ */
+class SearchPath {
+public:
+    static constexpr ui CAPACITY = 82;  /**< Dummy root entry + one entry per cell */
+
+private:
+    std::array<ui, CAPACITY> entries;  /**< Branch indices, root first */
+    ui length;                         /**< Number of valid entries */
+
+public:
+    /**
+     * @brief Construct an empty path.
+     */
+    SearchPath();
+
+    /**
+     * @brief Get the number of entries.
+     * @return Number of entries, including the dummy root entry once a solve started.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get an entry.
+     * @param i Index (0 = root, must be < size()).
+     * @return Branch index taken at depth i.
+     */
+    ui operator[](size_t i) const;
+
+    /**
+     * @brief Append a branch index.
+     * @param branch Branch index to append; the path must not be full.
+     */
+    void push_back(ui branch);
+
+    /**
+     * @brief Remove the last entry.
+     */
+    void pop_back();
+
+    /**
+     * @brief Remove all entries.
+     */
+    void clear();
+};
+
+/**
+ * @enum BacktrackMode
+ * @brief How dfsSolve() restores the board when a branch fails.
+ */
+enum BacktrackMode {
+    BACKTRACK_SNAPSHOT = 0,  /**< Copy the whole board state before each branch and copy it back */
+    BACKTRACK_TRAIL = 1      /**< Record every changed mask on a SearchTrail and unwind it to a mark */
+};
+
+/**
+ * @enum RuleTier
+ * @brief Strongest inference rules propagate() applies before the search branches.
+ *
+ * Every tier includes the ones below it. A tier only runs once all cheaper tiers have
+ * nothing left to do, and the cheaper ones run again after each of its eliminations.
+ */
+enum RuleTier {
+    RULES_SINGLES = 0,  /**< Naked and hidden singles only */
+    RULES_LOCKED = 1,   /**< Plus locked candidates (pointing and claiming) */
+    RULES_PAIRS = 2,    /**< Plus naked and hidden pairs */
+    RULES_TRIPLES = 3   /**< Plus naked and hidden triples */
+};
+
+/**
+ * @brief Get the command line name of a tier.
+ * @param tier Rule tier.
+ * @return "singles", "locked", "pairs" or "triples".
+ */
+const char* ruleTierName(RuleTier tier);
+
+/**
+ * @brief Parse a tier name as written by ruleTierName().
+ * @param name Name to parse.
+ * @param tier Receives the tier.
+ * @return false if the name is unknown.
+ */
+bool parseRuleTier(const char* name, RuleTier& tier);
+
+/**
+ * @enum BranchStrategy
+ * @brief How dfsSolve() and countSolutions() choose the alternatives to branch on.
+ */
+enum BranchStrategy {
+    BRANCH_MRV = 0,             /**< Candidates of the first cell (row-major) with the fewest candidates */
+    BRANCH_MRV_DEGREE = 1,      /**< Fewest candidates, ties broken by the most unfixed peers */
+    BRANCH_HOUSE_VALUE = 2,     /**< The places of the value with the fewest places in a house, if no
+                                     cell has fewer candidates (e.g. both cells of a hidden pair) */
+    BRANCH_RANDOM_RESTART = 3   /**< Random cell among the fewest candidates, random value order, and a
+                                     restart with a doubled node budget whenever the budget runs out */
+};
+
+/**
+ * @brief Get the command line name of a branching strategy.
+ * @param strategy Branching strategy.
+ * @return "mrv", "degree", "house" or "restarts".
+ */
+const char* branchStrategyName(BranchStrategy strategy);
+
+/**
+ * @brief Parse a branching strategy name as written by branchStrategyName().
+ * @param name Name to parse.
+ * @param strategy Receives the strategy.
+ * @return false if the name is unknown.
+ */
+bool parseBranchStrategy(const char* name, BranchStrategy& strategy);
+
+/**
+ * @enum SolveStatus
+ * @brief Outcome of SudokuBoard::solveWithin().
+ */
+enum SolveStatus {
+    SOLVE_SOLVED = 0,           /**< The board holds the solution */
+    SOLVE_NO_SOLUTION = 1,      /**< The search finished without a solution */
+    SOLVE_BUDGET_EXCEEDED = 2,  /**< The node or time budget ran out first */
+    SOLVE_CANCELLED = 3         /**< The cancellation token was set first */
+};
+
+/**
+ * @struct SolveBudget
+ * @brief Limits of one SudokuBoard::solveWithin() call; zero or nullptr members do not limit.
+ *
+ * The node budget counts search nodes over all restarts, so it stops a given puzzle at the
+ * same node on every machine. The clock and the token are only read every
+ * BUDGET_CHECK_INTERVAL nodes, which keeps the check off the profile of normal solves.
+ */
+struct SolveBudget {
+    ulli maxNodes;                    /**< Search nodes allowed, 0 for no limit */
+    ulli maxMicros;                   /**< Wall-clock microseconds allowed, 0 for no limit */
+    const std::atomic<bool>* cancel;  /**< Stops the search once true (set from any thread), or nullptr */
+};
+
+/** Nodes between two reads of the clock and the cancellation token (a power of two). */
+static const ulli BUDGET_CHECK_INTERVAL = 64;
+
+/**
+ * @class SearchTrail
+ * @brief Fixed-capacity undo stack of the board masks changed during a DFS.
+ *
+ * Each entry holds a mask slot (0..80 cell masks, 81..107 house "placed" masks) and the
+ * value the slot had before the change. Along one search path a cell mask only loses bits
+ * and a placed mask only gains bits, so every slot changes at most 9 times and CAPACITY
+ * entries always suffice.
+ */
+class SearchTrail {
+public:
+    static constexpr ui CAPACITY = (81 + 27) * 9;  /**< Maximum changes along one search path */
+
+    /**
+     * @struct Entry
+     * @brief One recorded change.
+     */
+    struct Entry {
+        us slot;  /**< 0..80: cell mask, 81..107: placed mask of house slot-81 */
+        us old;   /**< Mask before the change */
+    };
+
+private:
+    std::array<Entry, CAPACITY> entries;  /**< Changes, oldest first; not initialized */
+    ui length;                            /**< Number of valid entries */
+
+public:
+    /**
+     * @brief Construct an empty trail.
+     */
+    SearchTrail();
+
+    /**
+     * @brief Get the number of entries.
+     * @return Number of recorded changes.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get an entry.
+     * @param i Index (0 = oldest, must be < size()).
+     * @return The recorded change.
+     */
+    const Entry& operator[](size_t i) const;
+
+    /**
+     * @brief Record a change.
+     * @param slot Mask slot that is about to change.
+     * @param old Its current value.
+     */
+    void push_back(us slot, us old);
+
+    /**
+     * @brief Remove the newest entry.
+     */
+    void pop_back();
+};
+
+/**
+ * @struct SolutionCount
+ * @brief Outcome of SudokuBoard::countSolutions().
+ */
+struct SolutionCount {
+    ulli solutions;                      /**< Number of solutions found, at most the requested limit */
+    std::array<ulli, 12> firstSolution;  /**< Bitset of the first solution in search order (valid if solutions > 0) */
+    bool stopped;                        /**< The budget ran out or its token was set before the count finished */
+};
+
 /**
  * @class SudokuBoard
  * @brief Bitset-based representation of a 99 Sudoku board supporting
  *        candidate elimination, logical simplification, and DFS solving.
  *
- * Each of the 81 cells has 9 candidate bits (1..9), stored in a total of
- * 12 ulli elements (1264 = 768 bits) for 729 used bits.
+ * Each of the 81 cells keeps its 9 candidate bits (1..9) in the low bits of its own
+ * 16-bit mask, so the candidate count is a popcount and the only remaining value is a
+ * count of trailing zeros. Each of the 27 houses (9 rows, 9 columns, 9 chunks) also keeps
+ * a "placed" mask of the values whose naked single has already been eliminated from the
+ * rest of the house, so propagate() does not sweep the same peers again.
+ *
+ * The packed 12-ulli form (1264 = 768 bits, 729 used) is still accepted and returned by
+ * SudokuBoard(std::array<ulli,12>) and copyData() as the exchange format.
  */
 class SudokuBoard {
 private:
-    std::array<ulli, 12> bitset;  /**< Flat bitset array storing candidate bits for all cells */
+    std::array<us, 81> cells;   /**< Candidate mask per cell (row-major), bit v-1 set if v is possible */
+    std::array<us, 27> placed;  /**< Per house: values already eliminated from the house's other cells */
+    std::array<ulli, 2> dirty;  /**< Cells (bit i = cell i) changed since the last propagate() */
+    ui dirtyHouses;             /**< Houses (bit h) to re-check for hidden singles in propagate() */
+    SearchTrail* trail;         /**< Records every mask change while a trail-mode dfsSolve runs, else nullptr */
+    BacktrackMode backtrackMode;  /**< Rollback strategy used by dfsSolve() */
+    RuleTier ruleTier;            /**< Strongest rules used by propagate() */
+    BranchStrategy branchStrategy;  /**< Branching strategy of dfsSolve() and countSolutions() */
+    ulli randomSeed;                /**< Seed of the randomized branching strategy */
+    ulli hash;                      /**< Zobrist hash of the cell masks, kept up to date by every change */
+    TranspositionTable* table;      /**< Explored states shared by dfsSolve() and countSolutions(), or nullptr */
+    std::array<std::array<ulli, 2>, 10> byCount;  /**< Cells (bit i = cell i) by candidate count 0..9, for MRV */
+
+    /** Node budget of the first attempt with BRANCH_RANDOM_RESTART; doubled on every restart. */
+    static constexpr ulli RESTART_NODES = 64;
+
+    /**
+     * @struct Snapshot
+     * @brief Complete board state saved before a DFS branch and restored on backtrack.
+     */
+    struct Snapshot {
+        std::array<us, 81> cells;   /**< Saved candidate masks */
+        std::array<us, 27> placed;  /**< Saved house masks */
+        std::array<ulli, 2> dirty;  /**< Saved pending cells */
+        ui dirtyHouses;             /**< Saved pending houses */
+        std::array<std::array<ulli, 2>, 10> byCount;  /**< Saved candidate count buckets */
+        ulli hash;                  /**< Saved hash */
+    };
+
+    /**
+     * @struct SearchControl
+     * @brief Per-search state shared by all nodes of one dfsSolve() or countSolutions() run.
+     */
+    struct SearchControl {
+        ulli nodes;      /**< Nodes expanded in the current attempt */
+        ulli nodeLimit;  /**< The attempt is aborted once nodes exceeds this */
+        ulli random;     /**< xorshift64 state of the randomized strategy */
+        bool aborted;    /**< Set when the attempt ran out of nodes, time or was cancelled */
+        const SolveBudget* budget = nullptr;  /**< Time and token checked by dfsSolve() and countSolutionsWithin(), or nullptr */
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();  /**< End of the time budget */
+        SolveStatus stop = SOLVE_NO_SOLUTION;  /**< SOLVE_BUDGET_EXCEEDED or SOLVE_CANCELLED once the clock or token stopped the search */
+    };
+
+    /**
+     * @struct BranchChoice
+     * @brief The alternatives of one search node: assign value[i] to cell[i], one branch each.
+     */
+    struct BranchChoice {
+        ui count;      /**< Number of alternatives, 0 at a dead end */
+        uc cell[9];    /**< Row-major cell of each alternative */
+        uc value[9];   /**< Value (1..9) of each alternative */
+    };
+
+    /**
+     * @struct TrailMark
+     * @brief Position on the trail saved before a DFS branch, plus the (small) queue state.
+     */
+    struct TrailMark {
+        size_t length;              /**< Trail size when the mark was taken */
+        std::array<ulli, 2> dirty;  /**< Saved pending cells */
+        ui dirtyHouses;             /**< Saved pending houses */
+    };
 
 private:
     /**
-     * @brief Convert a GPos (x,y) to the starting bit index in the flat bitset.
+     * @brief Convert a GPos (x,y) to its row-major cell index.
      * @param gpos Global position of the cell.
-     * @return Base bit index (0..728) corresponding to candidate '1' of that cell.
+     * @return Cell index (0..80).
+     */
+    static ui gpos2CellIndex(GPos gpos);
+
+    /**
+     * @brief Forget that value was placed in the three houses of a cell.
+     *
+     * Called whenever a candidate bit is turned back on, so the next propagate()
+     * eliminates it again instead of trusting stale house masks.
+     *
+     * @param cellIndex Row-major index of the cell.
+     * @param bit Candidate bit of the value.
+     */
+    void unplace(ui cellIndex, us bit);
+
+    /**
+     * @brief Queue a cell for the next propagate() after its mask changed.
+     * @param cellIndex Row-major index of the cell.
+     */
+    void markDirty(ui cellIndex);
+
+    /**
+     * @brief Change a cell mask, recording the old mask on the trail if one is active.
+     *
+     * Every candidate change goes through here; the cell is queued for propagate().
+     *
+     * @param cellIndex Row-major index of the cell.
+     * @param mask New candidate mask.
+     */
+    void setCell(ui cellIndex, us mask);
+
+    /**
+     * @brief Change a house "placed" mask, recording the old mask on the trail if one is active.
+     * @param house House index (0..26).
+     * @param mask New mask; nothing is done or recorded if it equals the current one.
+     */
+    void setPlaced(ui house, us mask);
+
+    /**
+     * @brief Get the cell index of the k-th cell of a house.
+     * @param house House index: 0..8 rows, 9..17 columns, 18..26 chunks.
+     * @param k Position inside the house (0..8, row-major inside chunks).
+     * @return Row-major cell index.
+     */
+    static ui houseCell(ui house, ui k);
+
+    /**
+     * @brief Save the full board state.
+     * @return Snapshot of cell and house masks.
+     */
+    Snapshot saveSnapshot() const;
+
+    /**
+     * @brief Restore a state saved with saveSnapshot().
+     * @param snapshot State to restore.
+     */
+    void restoreSnapshot(const Snapshot& snapshot);
+
+    /**
+     * @brief Remember the current trail position (trail mode only).
+     * @return Mark to pass to undoTrail().
+     */
+    TrailMark markTrail() const;
+
+    /**
+     * @brief Unwind the trail back to a mark, restoring every mask changed since.
+     * @param mark Mark taken with markTrail().
+     */
+    void undoTrail(const TrailMark& mark);
+
+    /**
+     * @brief Move a cell between the candidate count buckets after its mask changed.
+     * @param cellIndex Row-major cell index.
+     * @param oldMask Previous mask of the cell.
+     * @param newMask New mask of the cell.
+     */
+    void recount(ui cellIndex, us oldMask, us newMask);
+
+    /**
+     * @brief Rebuild the candidate count buckets from the cell masks.
+     */
+    void rebuildCounts();
+
+    /** Zobrist key of each candidate: bit v-1 of cell c contributes ZOBRIST_KEYS[c][v-1]. */
+    static const std::array<std::array<ulli, 9>, 81> ZOBRIST_KEYS;
+
+    /**
+     * @brief Update the hash after a cell mask changed.
+     * @param cellIndex Row-major cell index.
+     * @param oldMask Previous mask of the cell.
+     * @param newMask New mask of the cell.
+     */
+    void rehash(ui cellIndex, us oldMask, us newMask);
+
+    /**
+     * @brief Compute the hash of all cell masks from scratch.
+     */
+    void rebuildHash();
+
+    /**
+     * @brief Choose the alternatives to branch on at a search node, per branchStrategy.
+     *
+     * Must be called on a propagated board that is neither solved nor contradictory.
+     *
+     * @param control Search state (random number source of the randomized strategy).
+     * @return Alternatives in the order they are tried; count 0 if some cell has no candidate.
+     */
+    BranchChoice chooseBranch(SearchControl& control) const;
+
+    /**
+     * @brief Advance a xorshift64 generator.
+     * @param state Generator state, never 0.
+     * @return Next pseudo-random number.
+     */
+    static ulli nextRandom(ulli& state);
+
+    //======== Shared simplification steps ========
+
+    /**
+     * @brief Naked Single: eliminate a fixed cell's value from its 20 peers.
+     *
+     * Reports ELIMINATION_BY_ROW/COLUMN/CHUNK in row, column, chunk order and marks the value
+     * as placed in the three houses. Does nothing if that already happened.
+     *
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param self Row-major index of a cell with exactly one candidate.
+     * @param eliminations Increased by the number of candidate bits cleared.
+     * @param listener Receives the elimination events.
+     */
+    template <class Listener>
+    void eliminateFromPeers(ui self, ui& eliminations, Listener& listener);
+
+    /**
+     * @brief Hidden Single: assign the values with exactly one possible cell in a house.
+     *
+     * A cell that holds several of them gets the lowest one; cells that are already
+     * fixed are left alone.
+     *
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param house House index (0..26).
+     * @param unique Values possible in exactly one cell of the house.
+     * @param eliminations Increased by the number of candidate bits cleared.
+     * @param listener Receives VALUE_SURE_BY_ROW/COLUMN/CHUNK events.
+     */
+    template <class Listener>
+    void assignHiddenSingles(ui house, us unique, ui& eliminations, Listener& listener);
+
+    /**
+     * @brief Report NO_PLACE_POSSIBLE for the lowest value no cell of a house can hold.
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param house House index (0..26).
+     * @param seen OR of the house's cell masks (not 0x1FF).
+     * @param listener Receives the event.
+     */
+    template <class Listener>
+    void reportMissingValue(ui house, us seen, Listener& listener);
+
+    //======== Rule tiers above singles ========
+
+    /**
+     * @brief Next larger integer with the same number of set bits (Gosper's hack).
+     * @param pick Current combination, non-zero.
+     * @return Next combination in increasing order.
+     */
+    static ui nextCombination(ui pick);
+
+    /**
+     * @brief Remove some candidates of a cell, reporting one event per value.
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param cell Row-major cell index.
+     * @param values Values to remove; those the cell does not have are ignored.
+     * @param cause Rule that found the eliminations.
+     * @param by House index (0..8) of the rule's house.
+     * @param eliminations Increased by the number of candidate bits cleared.
+     * @param listener Receives the elimination events.
+     */
+    template <class Listener>
+    void eliminateCandidates(ui cell, us values, SimplificationCause cause, uc by, ui& eliminations, Listener& listener);
+
+    /**
+     * @brief Locked candidates: pointing (chunk to line) and claiming (line to chunk).
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param eliminations Increased by the number of candidate bits cleared.
+     * @param listener Receives LOCKED_CANDIDATE_BY_* events.
+     */
+    template <class Listener>
+    void eliminateLockedCandidates(ui& eliminations, Listener& listener);
+
+    /**
+     * @brief Naked subsets: size unfixed cells of a house holding only size values between
+     *        them remove those values from the house's other cells.
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param size 2 (pairs) or 3 (triples).
+     * @param eliminations Increased by the number of candidate bits cleared.
+     * @param listener Receives NAKED_PAIR_BY_* or NAKED_TRIPLE_BY_* events.
+     */
+    template <class Listener>
+    void eliminateNakedSubsets(ui size, ui& eliminations, Listener& listener);
+
+    /**
+     * @brief Hidden subsets: size values of a house that fit only in the same size cells
+     *        remove every other candidate from those cells.
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param size 2 (pairs) or 3 (triples).
+     * @param eliminations Increased by the number of candidate bits cleared.
+     * @param listener Receives HIDDEN_PAIR_BY_* or HIDDEN_TRIPLE_BY_* events.
+     */
+    template <class Listener>
+    void eliminateHiddenSubsets(ui size, ui& eliminations, Listener& listener);
+
+    /**
+     * @brief Run the rule tiers above singles, cheapest first, up to ruleTier.
+     *
+     * Stops after the first tier that eliminates anything, so that the singles (and the
+     * cheaper tiers) get to use its result before a more expensive tier runs.
+     *
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param eliminations Set to the number of candidate bits cleared.
+     * @param listener Receives the elimination events.
      */
-    static ui gpos2bitsetIndex(GPos gpos);
+    template <class Listener>
+    void applyRuleTiers(ui& eliminations, Listener& listener);
 
     //======== Internal DFS helper ========
 
     /**
-     * @brief Internal recursive DFS solver with listeners for tracking steps.
+     * @struct NodeListener
+     * @brief Adapts a dfsSolve listener policy to the board-level events of propagate().
+     *
+     * Adds the current path and assignment array to every event; the first simplification
+     * group is the one at the root, where the path holds only the dummy entry.
+     */
+    template <class Listener>
+    struct NodeListener {
+        Listener& listener;      /**< Search listener receiving the events */
+        const SearchPath& path;  /**< Branch indices of the current node */
+        const bool* assigned;    /**< Cells assigned by the search so far */
+
+        void onSimplify(ui index, ui eliminated, ulli eliminatedSum) {
+            listener.onSimplify(path, index, eliminated, eliminatedSum, path.size() == 1, assigned);
+        }
+        void onEliminate(SimplificationCause cause, const GPos& cell, uc value, uc by) {
+            listener.onEliminate(path, cause, cell, value, by);
+        }
+    };
+
+    /**
+     * @struct SearchFrame
+     * @brief One branch level of dfsSolve() or countSolutions(): the alternatives of a node and the state they start from.
+     */
+    struct SearchFrame {
+        BranchChoice choice;  /**< Alternatives of the node */
+        ui next;              /**< Index of the next alternative to take; the one before is being searched */
+        ulli key;             /**< Hash of the node's state after propagation */
+        ulli before;          /**< Solutions counted before the node, in countSolutions() */
+        TrailMark mark;       /**< State before the alternatives, in trail mode */
+        Snapshot history;     /**< State before the alternatives, in snapshot mode */
+    };
+
+    /**
+     * @brief Internal DFS solver with listeners for tracking steps.
+     *
+     * Each node applies logical simplification (propagate()), checks for solution, lets
+     * chooseBranch() pick the alternatives, and branches on each of them, depth first. On
+     * failure, the board state is rolled back by unwinding the trail if one is active, or
+     * from a Snapshot otherwise.
+     *
+     * The search is a loop over an explicit stack of SearchFrame levels instead of a
+     * recursion, with the same nodes and events in the same order. Nothing is allocated per
+     * node: the frames live in a fixed array and the path is a fixed SearchPath. Listener
+     * calls are resolved at compile time.
+     *
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param board The current board state (passed by reference).
+     * @param path Branch indices taken so far (for tracing).
+     * @param assigned Boolean array of size 81 indicating which cells are assigned.
+     * @param listener Receives assignment, simplification and elimination events.
+     * @param control Search state; the search gives up (returns false) once it is aborted.
+     * @return true if a valid solution is found, false on contradiction, dead end or abort.
+     */
+    template <class Listener>
+    bool dfsSolve(SudokuBoard& board, SearchPath& path, bool assigned[81], Listener& listener, SearchControl& control);
+
+    /**
+     * @brief Internal solution counter.
      *
-     * This function applies logical simplification, checks for solution,
-     * chooses the next cell by MRV, and branches on each candidate. On failure,
-     * the board state is rolled back via copy/assignment.
+     * Same node steps and SearchFrame stack as dfsSolve(), but a solved board is counted (and
+     * stored if it is the first) and the search goes on with the next branch until limit
+     * solutions are found. Every branch is rolled back, solved or not.
      *
+     * @tparam Listener Listener policy (see NullSolveListener).
      * @param board The current board state (passed by reference).
-     * @param path Vector of branch indices taken so far (for tracing).
+     * @param path Branch indices taken so far (for tracing).
      * @param assigned Boolean array of size 81 indicating which cells are assigned.
-     * @param assignListener Callback invoked when a value is assigned to a cell.
-     * @param 
-     Listener Callback invoked after each simplification step.
-     * @param eliminateListener Callback invoked on each candidate elimination.
-     * @param isFirst Flag indicating whether this is the first simplification group.
-     * @return true if a valid solution is found, false on contradiction or dead end.
-     */
-    bool dfsSolve(
-        SudokuBoard& board,
-        std::vector<ui>& path,
-        bool assigned[81],
-        std::function<void(const std::vector<ui>& path, const bool assigned[81], const GPos& justAssigned)> assignListener,
-        std::function<void(const std::vector<ui>& path, const ui& index, const ui& eliminated, const ulli& eliminatedSum, const bool isFirstSimplificationGroup, const bool assigned[81])> simplifyListener,
-        std::function<void(const std::vector<ui>& path, const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener,
-        bool isFirst
-    );
+     * @param limit Number of solutions to stop at (at least 1).
+     * @param result Solution count and first solution, updated in place.
+     * @param listener Receives assignment, simplification and elimination events.
+     * @param control Search state; with a budget, stop is set when the clock, the token or
+     *                the node limit ends the count early.
+     * @return true once result.solutions reached limit or the count was stopped, false to keep searching.
+     */
+    template <class Listener>
+    bool countSolutions(SudokuBoard& board, SearchPath& path, bool assigned[81], ulli limit, SolutionCount& result, Listener& listener, SearchControl& control);
+
+    /**
+     * @brief Check the clock and the cancellation token of a budgeted search.
+     * @param control Search state with a budget; stop is set if the search must end.
+     * @return true if the search must end.
+     */
+    static bool budgetExpired(SearchControl& control);
+
+    /**
+     * @brief Run dfsSolve() from the board, restarting as the branching strategy asks.
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param path Receives the branch decisions.
+     * @param assigned Boolean array (size 81) indicating which cells have been assigned.
+     * @param listener Receives assignment, simplification and elimination events.
+     * @param budget Limits of the search, or nullptr for none.
+     * @return Outcome of the search.
+     */
+    template <class Listener>
+    SolveStatus runSearch(SearchPath& path, bool assigned[81], Listener& listener, const SolveBudget* budget);
+
+    /**
+     * @brief Run countSolutions() from the board and roll the board back afterwards.
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param limit Maximum number of solutions to find (0 is treated as 1).
+     * @param listener Receives assignment, simplification and elimination events.
+     * @param budget Limits of the count, or nullptr for none.
+     * @return Number of solutions (at most limit) and the first one found.
+     */
+    template <class Listener>
+    SolutionCount runCount(ulli limit, Listener& listener, const SolveBudget* budget);
 
 public:
     //======== Constructors & Assignment ========
 
     /**
-     * @brief Default constructor. Initializes all 729 bits to 1 (all candidates possible).
+     * @brief Default constructor. Initializes all 729 candidate bits to 1 (all candidates possible).
      */
     SudokuBoard();
 
     /**
      * @brief Construct board from existing bitset data.
-     * @param data Array of 12 ulli containing candidate bits.
+     *
+     * Bits are unpacked into per-cell masks; no value is considered placed yet.
+     *
+     * @param data Array of 12 ulli containing candidate bits (9 per cell, cell-major).
      */
     SudokuBoard(std::array<ulli, 12> data);
 
@@ -152,13 +783,13 @@ public:
     SudokuBoard& operator=(const SudokuBoard& other) = delete;
 
     /**
-     * @brief Move constructor; steals bitset data from other.
+     * @brief Move constructor; copies the cell and house masks of other.
      * @param other Source board to move from.
      */
     SudokuBoard(SudokuBoard&& other) noexcept;
 
     /**
-     * @brief Move assignment operator; steals bitset data from other.
+     * @brief Move assignment operator; copies the cell and house masks of other.
      * @param other Source board to move from.
      * @return Reference to this board.
      */
@@ -214,9 +845,8 @@ public:
     /**
      * @brief Get the only possible candidate and update count reference.
      *
-     * Iterates through all 9 candidates, increments count for each set bit,
-     * and records the last seen candidate. If exactly one bit is set, returns
-     * that candidate value; otherwise returns 0.
+     * Counts the set bits of the cell mask (popcount). If exactly one bit is set,
+     * returns that candidate value (from the trailing zero count); otherwise returns 0.
      *
      * @param gpos Global position of the cell.
      * @param count Reference to uc that will be set to the number of candidates.
@@ -224,6 +854,13 @@ public:
      */
     uc getCellInfoAt(const GPos gpos, uc& count) const;
 
+    /**
+     * @brief Get the raw candidate mask of a cell.
+     * @param gpos Global position of the cell.
+     * @return Mask with bit v-1 set for every possible value v.
+     */
+    us getCandidateMaskAt(const GPos gpos) const;
+
     /**
      * @brief Get a vector of all possible candidate values at a cell.
      * @param gpos Global position of the cell.
@@ -234,39 +871,28 @@ public:
     //======== Simplification ========
 
     /**
-     * @brief Perform a single pass of logical simplification on the board.
+     * @brief Apply naked and hidden singles until the board is stable, driven by a work queue.
      *
-     * Applies Naked Single and Hidden Single rules across all cells:
-     *   1. If a cell has exactly one candidate, eliminate that value from peers in row, column, chunk.
-     *   2. For each remaining candidate in a multi-candidate cell, if no other cell in the same
-     *      house (row/column/chunk) can hold that candidate, assign it to this cell.
+     * Only cells whose mask changed since the last call (through makeSureAt, setPossibleAt
+     * or construction) are visited. A newly fixed cell eliminates its value from its
+     * 20 peers, and every changed cell queues its 3 houses for a hidden single check; cells
+     * changed by those steps are queued in turn until nothing is left. A cell with no
+     * candidate or a value with no cell left in a house is a contradiction. The work is
+     * proportional to what changed rather than O(8127) per pass.
      *
-     * @param eliminations Reference to ui. Number of candidate bits cleared during this pass.
-     * @param eliminateListener Callback invoked for each elimination or assignment event. Arguments:
-     *        (cause, cellPosition, value, houseIndexOrPeerIndex)
-     * @return false if a contradiction (cell with zero candidates) is found; true otherwise.
-     */
-    bool simplify(
-        ui& eliminations,
-        std::function<void(const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener
-    );
-
-    /**
-     * @brief Repeatedly apply simplify() until no further eliminations occur or contradiction appears.
+     * Once the queue is empty, the rule tiers above singles enabled by setRuleTier() run, and
+     * the cells they changed are queued again.
      *
-     * Invokes simplifyListener after each pass with (iterationIndex, eliminatedThisPass, totalEliminatedSoFar).
-     * Invokes eliminateListener for each individual elimination or assignment inside simplify().
+     * listener.onSimplify is invoked after each round (all queued cells, then all queued houses,
+     * or one rule tier pass) with (roundIndex, eliminatedThisRound, totalEliminatedSoFar).
      *
+     * @tparam Listener Listener policy (see NullSolveListener).
      * @param totalEliminations Reference to ulli that accumulates total number of eliminated bits.
-     * @param simplifyListener Callback invoked after each simplification iteration.
-     * @param eliminateListener Callback invoked for each elimination/assignment inside simplify().
-     * @return false if a contradiction occurred during any pass; true if board is stable (no more eliminations).
+     * @param listener Receives the round and elimination events.
+     * @return false on a contradiction; true once the queue is empty.
      */
-    bool simplifyToTheEnd(
-        ulli& totalEliminations,
-        std::function<void(const ui& index, const ui& eliminated, const ulli& eliminatedSum)> simplifyListener,
-        std::function<void(const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener
-    );
+    template <class Listener>
+    bool propagate(ulli& totalEliminations, Listener& listener);
 
     //======== Status Checks ========
 
@@ -287,8 +913,10 @@ public:
     /**
      * @brief Find the cell with Minimum Remaining Values (MRV) heuristic.
      *
-     * Scans all cells, tracks the minimum candidate count (>1). If any cell has 0 candidates,
-     * immediately returns that cell with count = 0 to indicate contradiction.
+     * Returns the first cell (row-major) with the minimum candidate count (>1), read from
+     * the candidate count buckets kept up to date by every mask change, so no scan of the
+     * 81 cells is needed. If any cell has 0 candidates, returns that cell with count = 0 to
+     * indicate contradiction.
      *
      * @return Pair of (GPos, uc) where uc is candidate count. If count is 0, contradiction.
      * @throw std::runtime_error if no multi-candidate cell is found (unexpected).
@@ -299,68 +927,1154 @@ public:
 
     /**
      * @brief Copy raw bitset data for rollback or inspection.
+     *
+     * The per-cell masks are packed into the 12-ulli form accepted by
+     * SudokuBoard(std::array<ulli,12>).
+     *
      * @return std::array<ulli,12> containing current bitset state.
      */
     std::array<ulli, 12> copyData() const;
 
+    //======== Text Conversion ========
+
+    /**
+     * @brief Build raw bitset data directly from an 81-character puzzle row.
+     *
+     * Characters '1'..'9' become givens with a single candidate; any other character
+     * is an empty cell with all 9 candidates. The 9 bits of each cell are written
+     * word-wise, without going through GPos or per-bit calls, so the result can be
+     * fed straight into SudokuBoard(std::array<ulli,12>) when loading many puzzles.
+     *
+     * @param cells Pointer to at least 81 characters in row-major order.
+     * @return std::array<ulli,12> containing the candidate bits of the puzzle.
+     */
+    static std::array<ulli, 12> parseData(const char* cells);
+
+    /**
+     * @brief Write the board as 81 characters in row-major order.
+     *
+     * Cells with exactly one candidate are written as '1'..'9', all others as '.'.
+     *
+     * @param out Pointer to a buffer of at least 81 characters (no terminator is written).
+     */
+    void writeValues(char* out) const;
+
     //======== Public DFS Overloads ========
 
+    /**
+     * @brief Choose how dfsSolve() rolls back failed branches (BACKTRACK_TRAIL by default).
+     * @param mode BACKTRACK_TRAIL or BACKTRACK_SNAPSHOT.
+     */
+    void setBacktrackMode(BacktrackMode mode);
+
+    /**
+     * @brief Get the rollback strategy of dfsSolve().
+     * @return Current mode.
+     */
+    BacktrackMode getBacktrackMode() const;
+
+    /**
+     * @brief Choose the strongest rules propagate() applies (RULES_SINGLES by default).
+     * @param tier Rule tier.
+     */
+    void setRuleTier(RuleTier tier);
+
+    /**
+     * @brief Get the strongest rules propagate() applies.
+     * @return Current tier.
+     */
+    RuleTier getRuleTier() const;
+
+    /**
+     * @brief Choose the branching strategy of dfsSolve() and countSolutions() (BRANCH_MRV by default).
+     * @param strategy Branching strategy.
+     */
+    void setBranchStrategy(BranchStrategy strategy);
+
+    /**
+     * @brief Get the branching strategy of dfsSolve() and countSolutions().
+     * @return Current strategy.
+     */
+    BranchStrategy getBranchStrategy() const;
+
+    /**
+     * @brief Seed the randomized branching strategy (1 by default); equal seeds give equal searches.
+     * @param seed Any value.
+     */
+    void setRandomSeed(ulli seed);
+
+    /**
+     * @brief Get the Zobrist hash of the candidate state.
+     *
+     * The XOR of ZOBRIST_KEYS over every candidate still possible. It is updated with each
+     * changed mask, so boards with the same candidates have the same hash, however they
+     * were reached.
+     *
+     * @return Hash of the cell masks.
+     */
+    ulli getHash() const;
+
+    /**
+     * @brief Share explored states with other searches (none by default).
+     *
+     * With a table, dfsSolve() records every state whose subtree holds no solution and skips
+     * such states when it meets them again; countSolutions() also records the number of
+     * solutions of every subtree it counted completely. The results are those of a search
+     * without the table; only the skipped subtrees' events are missing. Probes are reported
+     * to the listener (see NullSolveListener).
+     *
+     * @param table Table to use, or nullptr; must outlive the searches using it.
+     */
+    void setTranspositionTable(TranspositionTable* table);
+
     /**
      * @brief Public DFS solver entry point with full tracking.
      *
      * Clears path and initializes first branch index to 0, then calls internal dfsSolve.
      *
-     * @param path Vector to record branch decisions.
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param path Receives the branch decisions.
      * @param assigned Boolean array (size 81) indicating which cells have been assigned.
-     * @param assignListener Callback invoked when a candidate is assigned to a cell.
-     * @param simplifyListener Callback invoked after each simplifyToTheEnd iteration.
-     * @param eliminateListener Callback invoked on each elimination or assignment inside simplify().
+     * @param listener Receives assignment, simplification and elimination events.
      * @return true if a solution is found; false otherwise.
      */
-    bool dfsSolve(
-        std::vector<ui>& path,
-        bool assigned[81],
-        std::function<void(const std::vector<ui>& path, const bool assigned[81], const GPos& justAssigned)> assignListener,
-        std::function<void(const std::vector<ui>& path, const ui& index, const ui& eliminated, const ulli& eliminatedSum, const bool isFirstSimplificationGroup, const bool assigned[81])> simplifyListener,
-        std::function<void(const std::vector<ui>& path, const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener
-    );
+    template <class Listener>
+    bool dfsSolve(SearchPath& path, bool assigned[81], Listener& listener);
 
     /**
-     * @brief Public DFS solver entry point without branch path tracking.
+     * @brief Public DFS solver entry point without branch path output.
      *
-     * Initializes a local path vector and calls the full-tracking dfsSolve.
+     * Uses a local SearchPath and calls the full-tracking dfsSolve.
      *
+     * @tparam Listener Listener policy (see NullSolveListener).
      * @param assigned Boolean array (size 81) indicating which cells have been assigned.
-     * @param assignListener Callback invoked when a candidate is assigned.
-     * @param simplifyListener Callback invoked after each simplifyToTheEnd iteration.
-     * @param eliminateListener Callback invoked on each elimination or assignment inside simplify().
+     * @param listener Receives assignment, simplification and elimination events.
      * @return true if a solution is found; false otherwise.
      */
-    bool dfsSolve(
-        bool assigned[81],
-        std::function<void(const std::vector<ui>& path, const bool assigned[81], const GPos& justAssigned)> assignListener,
-        std::function<void(const std::vector<ui>& path, const ui& index, const ui& eliminated, const ulli& eliminatedSum, const bool isFirstSimplificationGroup, const bool assigned[81])> simplifyListener,
-        std::function<void(const std::vector<ui>& path, const SimplificationCause& cause, const GPos& cell, const uc& value, const uc& by)> eliminateListener
-    );
+    template <class Listener>
+    bool dfsSolve(bool assigned[81], Listener& listener);
 
     /**
      * @brief Simplified DFS solver entry point with no listeners.
      *
-     * Calls dfsSolve(path, assigned, emptyListeners).
+     * Calls dfsSolve(path, assigned, listener) with a NullSolveListener.
      *
-     * @param path Vector to record branch decisions.
+     * @param path Receives the branch decisions.
      * @param assigned Boolean array (size 81) indicating which cells have been assigned.
      * @return true if solved; false otherwise.
      */
-    bool dfsSolve(std::vector<ui>& path, bool assigned[81]);
+    bool dfsSolve(SearchPath& path, bool assigned[81]);
 
     /**
      * @brief Simplest DFS solver entry point with no listeners and no path output.
      *
-     * Initializes path vector internally and calls dfsSolve(path, assigned).
+     * Uses a local SearchPath and calls dfsSolve(path, assigned).
      *
      * @param assigned Boolean array (size 81) indicating which cells have been assigned.
      * @return true if solved; false otherwise.
      */
     bool dfsSolve(bool assigned[81]);
+
+    /**
+     * @brief DFS solver entry point that gives up once a budget runs out.
+     *
+     * Searches exactly like dfsSolve(path, assigned, listener), so a puzzle solved within the
+     * budget gets the same solution and the same events. When the budget runs out or the
+     * token is set, the board goes back to the state it had before the call and the listener
+     * keeps the events of the partial search (e.g. the StatsListener counts of the nodes
+     * visited), for the caller to retry the puzzle elsewhere.
+     *
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param path Receives the branch decisions.
+     * @param budget Node, time and cancellation limits.
+     * @param assigned Boolean array (size 81) indicating which cells have been assigned.
+     * @param listener Receives assignment, simplification and elimination events.
+     * @return SOLVE_SOLVED, SOLVE_NO_SOLUTION, SOLVE_BUDGET_EXCEEDED or SOLVE_CANCELLED.
+     */
+    template <class Listener>
+    SolveStatus solveWithin(SearchPath& path, const SolveBudget& budget, bool assigned[81], Listener& listener);
+
+    /**
+     * @brief Budgeted DFS solver entry point without branch path output.
+     *
+     * Uses a local SearchPath and calls solveWithin(path, budget, assigned, listener).
+     *
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param budget Node, time and cancellation limits.
+     * @param assigned Boolean array (size 81) indicating which cells have been assigned.
+     * @param listener Receives assignment, simplification and elimination events.
+     * @return SOLVE_SOLVED, SOLVE_NO_SOLUTION, SOLVE_BUDGET_EXCEEDED or SOLVE_CANCELLED.
+     */
+    template <class Listener>
+    SolveStatus solveWithin(const SolveBudget& budget, bool assigned[81], Listener& listener);
+
+    //======== Solution Counting ========
+
+    /**
+     * @brief Count the solutions of the board, stopping early once limit are found.
+     *
+     * Runs the dfsSolve() search (propagate, then the chooseBranch() alternatives) but keeps
+     * going after a solution, so limit = 2 answers whether the puzzle is unique.
+     * BRANCH_RANDOM_RESTART only randomizes the order here; the tree is never restarted.
+     * The board is left exactly as it was before the call.
+     *
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param limit Maximum number of solutions to find (0 is treated as 1).
+     * @param listener Receives assignment, simplification and elimination events.
+     * @return Number of solutions (at most limit) and the first one found.
+     */
+    template <class Listener>
+    SolutionCount countSolutions(ulli limit, Listener& listener);
+
+    /**
+     * @brief Count the solutions of the board within a budget.
+     *
+     * Counts like countSolutions(limit, listener), but stops once the node or time budget
+     * runs out or the token is set, with the solutions found so far and stopped set. The
+     * clock and the token are read every BUDGET_CHECK_INTERVAL nodes. A stopped count
+     * stores nothing in the transposition table.
+     *
+     * @tparam Listener Listener policy (see NullSolveListener).
+     * @param limit Maximum number of solutions to find (0 is treated as 1).
+     * @param budget Node, time and cancellation limits.
+     * @param listener Receives assignment, simplification and elimination events.
+     * @return Number of solutions (at most limit), the first one found and whether it stopped early.
+     */
+    template <class Listener>
+    SolutionCount countSolutionsWithin(ulli limit, const SolveBudget& budget, Listener& listener);
+
+    /**
+     * @brief Count the solutions of the board with no listener.
+     *
+     * Calls countSolutions(limit, listener) with a NullSolveListener.
+     *
+     * @param limit Maximum number of solutions to find (0 is treated as 1).
+     * @return Number of solutions (at most limit) and the first one found.
+     */
+    SolutionCount countSolutions(ulli limit);
+};
+
+/**
+ * @struct NullSolveListener
+ * @brief Listener policy that ignores every event.
+ *
+ * Listener policies are plain classes passed by reference to the templated solver
+ * functions. propagate() calls
+ *   - onEliminate(cause, cell, value, by) for each elimination or assignment,
+ *   - onSimplify(index, eliminated, eliminatedSum) after each pass or round;
+ * dfsSolve() calls the same events with the search state attached:
+ *   - onAssign(path, assigned, justAssigned),
+ *   - onSimplify(path, index, eliminated, eliminatedSum, isFirstSimplificationGroup, assigned),
+ *   - onEliminate(path, cause, cell, value, by),
+ * and for profiling, around its own steps:
+ *   - onNode(path) on entering a search node,
+ *   - onPropagateBegin(path) and onPropagateEnd(path, consistent) around its propagation,
+ *   - onBacktrack(path) after a failed branch was rolled back,
+ *   - onTableProbe(hit) for each transposition table lookup (see setTranspositionTable()).
+ * The calls are bound at compile time, so empty inline hooks like these compile away
+ * completely, argument computation included.
+ */
+struct NullSolveListener {
+    void onNode(const SearchPath& path) {}
+    void onPropagateBegin(const SearchPath& path) {}
+    void onPropagateEnd(const SearchPath& path, bool consistent) {}
+    void onBacktrack(const SearchPath& path) {}
+    void onTableProbe(bool hit) {}
+    void onAssign(const SearchPath& path, const bool assigned[81], const GPos& justAssigned) {}
+    void onSimplify(const SearchPath& path, ui index, ui eliminated, ulli eliminatedSum, bool isFirstSimplificationGroup, const bool assigned[81]) {}
+    void onEliminate(const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by) {}
+    void onSimplify(ui index, ui eliminated, ulli eliminatedSum) {}
+    void onEliminate(SimplificationCause cause, const GPos& cell, uc value, uc by) {}
+};
+
+/**
+ * @struct StatsListener
+ * @brief Listener policy that counts assignments, simplification rounds and table probes into a SolveStats.
+ */
+struct StatsListener : NullSolveListener {
+    SolveStats& stats;  /**< Receives the assignments and simplifications counts */
+
+    /**
+     * @brief Constructor.
+     * @param stats Record to count into.
+     */
+    explicit StatsListener(SolveStats& stats) : stats(stats) {}
+
+    void onAssign(const SearchPath& path, const bool assigned[81], const GPos& justAssigned) {
+        stats.assignments++;
+    }
+    void onSimplify(const SearchPath& path, ui index, ui eliminated, ulli eliminatedSum, bool isFirstSimplificationGroup, const bool assigned[81]) {
+        stats.simplifications++;
+    }
+    void onSimplify(ui index, ui eliminated, ulli eliminatedSum) {
+        stats.simplifications++;
+    }
+    void onTableProbe(bool hit) {
+        stats.tableProbes++;
+        stats.tableHits += hit;
+    }
 };
+
+//======== Inline and template definitions ========
+
+inline Tuple2::Tuple2(uc x_val, uc y_val)
+    : x(x_val), y(y_val) {}
+inline uc Tuple2::getX() const {
+    return x;
+}
+inline uc Tuple2::getY() const {
+    return y;
+}
+
+inline GPos::GPos() : Tuple2(0, 0) {}
+inline GPos::GPos(uc x, uc y) : Tuple2(x, y) {}
+
+inline SearchPath::SearchPath() : entries(), length(0) {}
+inline size_t SearchPath::size() const {
+    return length;
+}
+inline ui SearchPath::operator[](size_t i) const {
+    return entries[i];
+}
+inline void SearchPath::push_back(ui branch) {
+    entries[length++] = branch;
+}
+inline void SearchPath::pop_back() {
+    length--;
+}
+inline void SearchPath::clear() {
+    length = 0;
+}
+
+inline SearchTrail::SearchTrail() : length(0) {}
+inline size_t SearchTrail::size() const {
+    return length;
+}
+inline const SearchTrail::Entry& SearchTrail::operator[](size_t i) const {
+    return entries[i];
+}
+inline void SearchTrail::push_back(us slot, us old) {
+    entries[length++] = { slot, old };
+}
+inline void SearchTrail::pop_back() {
+    length--;
+}
+
+inline void SudokuBoard::markDirty(ui cellIndex) {
+    dirty[cellIndex >> 6] |= 1ULL << (cellIndex & 63);
+}
+inline void SudokuBoard::setCell(ui cellIndex, us mask) {
+    if (trail != nullptr)
+        trail->push_back((us)cellIndex, cells[cellIndex]);
+    recount(cellIndex, cells[cellIndex], mask);
+    rehash(cellIndex, cells[cellIndex], mask);
+    cells[cellIndex] = mask;
+    markDirty(cellIndex);
+}
+inline void SudokuBoard::recount(ui cellIndex, us oldMask, us newMask) {
+    int before = std::popcount(oldMask), after = std::popcount(newMask);
+    if (before == after)
+        return;
+    ulli bit = 1ULL << (cellIndex % 64);
+    byCount[before][cellIndex / 64] &= ~bit;
+    byCount[after][cellIndex / 64] |= bit;
+}
+inline void SudokuBoard::rehash(ui cellIndex, us oldMask, us newMask) {
+    for (us changed = oldMask ^ newMask; changed != 0; changed &= changed - 1)
+        hash ^= ZOBRIST_KEYS[cellIndex][std::countr_zero(changed)];
+}
+inline void SudokuBoard::setPlaced(ui house, us mask) {
+    if (placed[house] == mask)
+        return;
+    if (trail != nullptr)
+        trail->push_back((us)(81 + house), placed[house]);
+    placed[house] = mask;
+}
+inline ui SudokuBoard::houseCell(ui house, ui k) {
+    return boardGeometry<3>.houseCells[house][k];
+}
+inline SudokuBoard::Snapshot SudokuBoard::saveSnapshot() const {
+    return { cells, placed, dirty, dirtyHouses, byCount, hash };
+}
+inline void SudokuBoard::restoreSnapshot(const Snapshot& snapshot) {
+    cells = snapshot.cells;
+    placed = snapshot.placed;
+    dirty = snapshot.dirty;
+    dirtyHouses = snapshot.dirtyHouses;
+    byCount = snapshot.byCount;
+    hash = snapshot.hash;
+}
+inline SudokuBoard::TrailMark SudokuBoard::markTrail() const {
+    return { trail->size(), dirty, dirtyHouses };
+}
+inline void SudokuBoard::undoTrail(const TrailMark& mark) {
+    // Newest change first, so a slot changed several times ends at its oldest value
+    while (trail->size() > mark.length) {
+        const SearchTrail::Entry& entry = (*trail)[trail->size() - 1];
+        if (entry.slot < 81) {
+            recount(entry.slot, cells[entry.slot], entry.old);
+            rehash(entry.slot, cells[entry.slot], entry.old);
+            cells[entry.slot] = entry.old;
+        } else
+            placed[entry.slot - 81] = entry.old;
+        trail->pop_back();
+    }
+    dirty = mark.dirty;
+    dirtyHouses = mark.dirtyHouses;
+}
+
+inline ui SudokuBoard::gpos2CellIndex(GPos gpos) {
+    // Row-major cell index from (x,y)
+    return (ui)gpos.getX() + (ui)gpos.getY() * 9u;
+}
+
+inline void SudokuBoard::unplace(ui cellIndex, us bit) {
+    // Row, column and chunk house of the cell
+    for (uc house : boardGeometry<3>.cellHouses[cellIndex])
+        setPlaced(house, placed[house] & (us)~bit);
+}
+inline void SudokuBoard::makeSureAt(const GPos gpos, const uc value, const bool force) {
+    // To set cell to 'value', eliminate all other candidate bits
+    // (a value outside 1..9 keeps no bit at all, as before)
+    ui index = gpos2CellIndex(gpos);
+    us bit = (1 <= value && value <= 9) ? (us)(1u << (value - 1)) : 0;
+    us before = cells[index];
+    if (force && bit != 0 && !(before & bit)) {
+        // If forcing, ensure this bit is turned on even if it was off
+        unplace(index, bit);
+        setCell(index, bit);
+    } else if ((before & bit) != before) {
+        // If not forcing, leave the bit as-is (if it was already off, we keep it off)
+        setCell(index, before & bit);
+    }
+}
+inline bool SudokuBoard::isSolved() const {
+    // Every cell is in the bucket of cells with exactly one candidate
+    return byCount[1][0] == ~0ULL && byCount[1][1] == (1ULL << (81 - 64)) - 1;
+}
+inline std::pair<GPos, uc> SudokuBoard::findMRVCell() const {
+    // The lowest non-empty bucket, first cell in row-major order
+    for (ui count = 0; count <= 9; count++) {
+        if (count == 1)
+            continue;
+        const std::array<ulli, 2>& set = byCount[count];
+        if (set[0] == 0 && set[1] == 0)
+            continue;
+        ui i = set[0] != 0 ? (ui)std::countr_zero(set[0]) : 64 + (ui)std::countr_zero(set[1]);
+        return { GPos((uc)(i % 9), (uc)(i / 9)), (uc)count };
+    }
+    // All cells have exactly 1 candidate: should be solved already
+    throw new std::runtime_error("Unexpected state in findMRVCell");
+}
+inline ulli SudokuBoard::nextRandom(ulli& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+inline SudokuBoard::BranchChoice SudokuBoard::chooseBranch(SearchControl& control) const {
+    BranchChoice choice = BranchChoice();
+    auto [pos, count] = findMRVCell();
+    if (count == 0)
+        return choice;
+    ui best = gpos2CellIndex(pos);
+    const std::array<ulli, 2>& tied = byCount[count];
+
+    if (branchStrategy == BRANCH_MRV_DEGREE) {
+        // Among the cells with the fewest candidates, the one constraining most unfixed cells
+        std::array<ulli, 2> unfixed = { ~byCount[1][0], ~byCount[1][1] & ((1ULL << (81 - 64)) - 1) };
+        int bestDegree = -1;
+        for (ui word = 0; word < 2; word++) {
+            for (ulli bits = tied[word]; bits != 0; bits &= bits - 1) {
+                ui i = (ui)std::countr_zero(bits) + 64 * word;
+                const std::array<ulli, 2>& peers = boardGeometry<3>.peerBits[i];
+                int degree = std::popcount(peers[0] & unfixed[0]) + std::popcount(peers[1] & unfixed[1]);
+                if (degree > bestDegree) {
+                    bestDegree = degree;
+                    best = i;
+                }
+            }
+        }
+    } else if (branchStrategy == BRANCH_RANDOM_RESTART) {
+        // A uniformly random cell among the ties
+        int ties = std::popcount(tied[0]) + std::popcount(tied[1]);
+        int pick = (int)(nextRandom(control.random) % (ulli)ties);
+        ui word = pick < std::popcount(tied[0]) ? 0 : 1;
+        ulli bits = tied[word];
+        for (int skip = word == 0 ? pick : pick - std::popcount(tied[0]); skip > 0; skip--)
+            bits &= bits - 1;
+        best = (ui)std::countr_zero(bits) + 64 * word;
+    } else if (branchStrategy == BRANCH_HOUSE_VALUE) {
+        // The value with the fewest places in some house wins if it has no more places than
+        // the MRV cell has candidates; its places become the alternatives
+        ui bestHouse = 0, bestPlaces = count + 1;
+        uc bestValue = 0;
+        for (ui house = 0; house < 27 && bestPlaces > 2; house++) {
+            uc places[9] = {};
+            for (ui k = 0; k < 9; k++) {
+                for (us mask = cells[houseCell(house, k)]; mask != 0; mask &= mask - 1)
+                    places[std::countr_zero(mask)]++;
+            }
+            for (ui v = 0; v < 9; v++) {
+                if (places[v] >= 2 && places[v] < bestPlaces) {
+                    bestPlaces = places[v];
+                    bestHouse = house;
+                    bestValue = (uc)v;
+                }
+            }
+        }
+        if (bestPlaces <= count) {
+            for (ui k = 0; k < 9; k++) {
+                ui cell = houseCell(bestHouse, k);
+                if (cells[cell] & (1u << bestValue)) {
+                    choice.cell[choice.count] = (uc)cell;
+                    choice.value[choice.count++] = (uc)(bestValue + 1);
+                }
+            }
+            return choice;
+        }
+    }
+
+    // Branch on the candidates of one cell, lowest first
+    for (us mask = cells[best]; mask != 0; mask &= mask - 1) {
+        choice.cell[choice.count] = (uc)best;
+        choice.value[choice.count++] = (uc)(std::countr_zero(mask) + 1);
+    }
+    if (branchStrategy == BRANCH_RANDOM_RESTART) {
+        // ... or in random order
+        for (ui i = choice.count - 1; i > 0; i--) {
+            ui j = (ui)(nextRandom(control.random) % (i + 1));
+            uc value = choice.value[i];
+            choice.value[i] = choice.value[j];
+            choice.value[j] = value;
+        }
+    }
+    return choice;
+}
+
+template <class Listener>
+void SudokuBoard::eliminateFromPeers(ui self, ui& eliminations, Listener& listener) {
+    typedef BoardGeometry<3> Geometry;
+    const std::array<uc, 3>& houses = boardGeometry<3>.cellHouses[self];
+    us bit = cells[self];
+    if (placed[houses[0]] & placed[houses[1]] & placed[houses[2]] & bit)
+        return;
+
+    // The 20 peers come row first, then column, then the rest of the chunk
+    uc onlyVal = (uc)(std::countr_zero(bit) + 1);
+    const std::array<us, Geometry::PEERS>& peers = boardGeometry<3>.peers[self];
+    for (ui k = 0; k < Geometry::PEERS; k++) {
+        ui peer = peers[k];
+        if (cells[peer] & bit) {
+            setCell(peer, cells[peer] & (us)~bit);
+            eliminations++;
+            ui unit = k < Geometry::ROW_PEERS ? 0 : k < Geometry::LINE_PEERS ? 1 : 2;
+            listener.onEliminate((SimplificationCause)(ELIMINATION_BY_ROW + unit), GPos((uc)(peer % 9), (uc)(peer / 9)),
+                                 onlyVal, (uc)(houses[unit] % 9));
+        }
+    }
+
+    // The value is now absent from every other cell of the three houses
+    for (uc house : houses)
+        setPlaced(house, placed[house] | bit);
+}
+
+template <class Listener>
+void SudokuBoard::assignHiddenSingles(ui house, us unique, ui& eliminations, Listener& listener) {
+    SimplificationCause cause = house < 9 ? VALUE_SURE_BY_ROW : house < 18 ? VALUE_SURE_BY_COLUMN : VALUE_SURE_BY_CHUNK;
+    for (ui k = 0; k < 9; k++) {
+        ui cell = houseCell(house, k);
+        us bit = cells[cell] & unique;
+        uc count = (uc)std::popcount(cells[cell]);
+        if (bit == 0 || count == 1)
+            continue;
+        // The lowest unique value wins if there are several
+        bit &= (us)(-bit);
+        eliminations += count - 1;
+        setCell(cell, bit);
+        listener.onEliminate(cause, GPos((uc)(cell % 9), (uc)(cell / 9)), (uc)(std::countr_zero(bit) + 1), (uc)(house % 9));
+    }
+}
+
+template <class Listener>
+void SudokuBoard::reportMissingValue(ui house, us seen, Listener& listener) {
+    ui first = houseCell(house, 0);
+    uc missing = (uc)(std::countr_zero((us)(~seen & 0x1FF)) + 1);
+    listener.onEliminate(NO_PLACE_POSSIBLE, GPos((uc)(first % 9), (uc)(first / 9)), missing, (uc)house);
+}
+
+inline ui SudokuBoard::nextCombination(ui pick) {
+    ui low = pick & (0u - pick);
+    ui ripple = pick + low;
+    return ripple | (((pick ^ ripple) >> 2) / low);
+}
+
+template <class Listener>
+void SudokuBoard::eliminateCandidates(ui cell, us values, SimplificationCause cause, uc by, ui& eliminations, Listener& listener) {
+    us removed = cells[cell] & values;
+    if (removed == 0)
+        return;
+    setCell(cell, cells[cell] & (us)~removed);
+    GPos pos((uc)(cell % 9), (uc)(cell / 9));
+    for (us mask = removed; mask != 0; mask &= mask - 1) {
+        eliminations++;
+        listener.onEliminate(cause, pos, (uc)(std::countr_zero(mask) + 1), by);
+    }
+}
+
+template <class Listener>
+void SudokuBoard::eliminateLockedCandidates(ui& eliminations, Listener& listener) {
+    // The values of three adjacent cells of a row (a row segment) or of a column
+    auto rowSegment = [this](ui y, ui left) -> us {
+        return cells[9 * y + left] | cells[9 * y + left + 1] | cells[9 * y + left + 2];
+    };
+    auto columnSegment = [this](ui x, ui top) -> us {
+        return cells[9 * top + x] | cells[9 * (top + 1) + x] | cells[9 * (top + 2) + x];
+    };
+
+    for (ui chunk = 0; chunk < 9; chunk++) {
+        ui top = chunk / 3 * 3, left = chunk % 3 * 3;
+        for (ui i = 0; i < 3; i++) {
+            // Pointing: values of the chunk confined to one of its rows leave the rest of that row
+            ui y = top + i;
+            us locked = rowSegment(y, left) & (us)~(rowSegment(top + (i + 1) % 3, left) | rowSegment(top + (i + 2) % 3, left));
+            if (locked != 0) {
+                for (ui x = 0; x < 9; x++) {
+                    if (x / 3 != chunk % 3)
+                        eliminateCandidates(9 * y + x, locked, LOCKED_CANDIDATE_BY_CHUNK, (uc)chunk, eliminations, listener);
+                }
+            }
+            // ... and the same for its columns
+            ui x = left + i;
+            locked = columnSegment(x, top) & (us)~(columnSegment(left + (i + 1) % 3, top) | columnSegment(left + (i + 2) % 3, top));
+            if (locked != 0) {
+                for (ui y = 0; y < 9; y++) {
+                    if (y / 3 != chunk / 3)
+                        eliminateCandidates(9 * y + x, locked, LOCKED_CANDIDATE_BY_CHUNK, (uc)chunk, eliminations, listener);
+                }
+            }
+        }
+    }
+
+    for (ui line = 0; line < 9; line++) {
+        for (ui b = 0; b < 3; b++) {
+            // Claiming: values of a row confined to one chunk leave the chunk's other rows
+            us locked = rowSegment(line, 3 * b) & (us)~(rowSegment(line, 3 * ((b + 1) % 3)) | rowSegment(line, 3 * ((b + 2) % 3)));
+            if (locked != 0) {
+                ui top = line / 3 * 3;
+                for (ui k = 0; k < 9; k++) {
+                    ui y = top + k / 3, x = 3 * b + k % 3;
+                    if (y != line)
+                        eliminateCandidates(9 * y + x, locked, LOCKED_CANDIDATE_BY_ROW, (uc)line, eliminations, listener);
+                }
+            }
+            // ... and the same for columns
+            locked = columnSegment(line, 3 * b) & (us)~(columnSegment(line, 3 * ((b + 1) % 3)) | columnSegment(line, 3 * ((b + 2) % 3)));
+            if (locked != 0) {
+                ui left = line / 3 * 3;
+                for (ui k = 0; k < 9; k++) {
+                    ui y = 3 * b + k / 3, x = left + k % 3;
+                    if (x != line)
+                        eliminateCandidates(9 * y + x, locked, LOCKED_CANDIDATE_BY_COLUMN, (uc)line, eliminations, listener);
+                }
+            }
+        }
+    }
+}
+
+template <class Listener>
+void SudokuBoard::eliminateNakedSubsets(ui size, ui& eliminations, Listener& listener) {
+    int base = size == 2 ? NAKED_PAIR_BY_ROW : NAKED_TRIPLE_BY_ROW;
+    for (ui house = 0; house < 27; house++) {
+        SimplificationCause cause = (SimplificationCause)(base + (int)(house / 9));
+
+        // Unfixed cells with at most size candidates are the possible subset members
+        ui member[9];
+        us mask[9];
+        ui count = 0;
+        for (ui k = 0; k < 9; k++) {
+            int n = std::popcount(cells[houseCell(house, k)]);
+            if (n >= 2 && n <= (int)size) {
+                member[count] = k;
+                mask[count++] = cells[houseCell(house, k)];
+            }
+        }
+
+        if (count < size)
+            continue;
+        for (ui pick = (1u << size) - 1; pick < (1u << count); pick = nextCombination(pick)) {
+            us values = 0;
+            ui subset = 0;
+            for (ui bits = pick; bits != 0; bits &= bits - 1) {
+                values |= mask[std::countr_zero(bits)];
+                subset |= 1u << member[std::countr_zero(bits)];
+            }
+            if ((ui)std::popcount(values) != size)
+                continue;
+            for (ui k = 0; k < 9; k++) {
+                if (!(subset & (1u << k)))
+                    eliminateCandidates(houseCell(house, k), values, cause, (uc)(house % 9), eliminations, listener);
+            }
+        }
+    }
+}
+
+template <class Listener>
+void SudokuBoard::eliminateHiddenSubsets(ui size, ui& eliminations, Listener& listener) {
+    int base = size == 2 ? HIDDEN_PAIR_BY_ROW : HIDDEN_TRIPLE_BY_ROW;
+    for (ui house = 0; house < 27; house++) {
+        SimplificationCause cause = (SimplificationCause)(base + (int)(house / 9));
+
+        // Places (bit k = k-th cell of the house) of every value with 2..size of them
+        us value[9];
+        ui where[9];
+        ui count = 0;
+        for (ui v = 0; v < 9; v++) {
+            ui places = 0;
+            for (ui k = 0; k < 9; k++) {
+                if (cells[houseCell(house, k)] & (1u << v))
+                    places |= 1u << k;
+            }
+            int n = std::popcount(places);
+            if (n >= 2 && n <= (int)size) {
+                value[count] = (us)(1u << v);
+                where[count++] = places;
+            }
+        }
+
+        if (count < size)
+            continue;
+        for (ui pick = (1u << size) - 1; pick < (1u << count); pick = nextCombination(pick)) {
+            us keep = 0;
+            ui places = 0;
+            for (ui bits = pick; bits != 0; bits &= bits - 1) {
+                keep |= value[std::countr_zero(bits)];
+                places |= where[std::countr_zero(bits)];
+            }
+            if ((ui)std::popcount(places) != size)
+                continue;
+            for (ui k = 0; k < 9; k++) {
+                if (places & (1u << k))
+                    eliminateCandidates(houseCell(house, k), (us)(0x1FF & ~keep), cause, (uc)(house % 9), eliminations, listener);
+            }
+        }
+    }
+}
+
+template <class Listener>
+void SudokuBoard::applyRuleTiers(ui& eliminations, Listener& listener) {
+    eliminations = 0;
+    if (ruleTier >= RULES_LOCKED) {
+        eliminateLockedCandidates(eliminations, listener);
+        if (eliminations != 0)
+            return;
+    }
+    if (ruleTier >= RULES_PAIRS) {
+        eliminateNakedSubsets(2, eliminations, listener);
+        eliminateHiddenSubsets(2, eliminations, listener);
+        if (eliminations != 0)
+            return;
+    }
+    if (ruleTier >= RULES_TRIPLES) {
+        eliminateNakedSubsets(3, eliminations, listener);
+        eliminateHiddenSubsets(3, eliminations, listener);
+    }
+}
+
+template <class Listener>
+bool SudokuBoard::propagate(ulli& totalEliminations, Listener& listener) {
+    totalEliminations = 0;
+    ui round = 0;
+
+    while (true) {
+        while (dirty[0] != 0 || dirty[1] != 0 || dirtyHouses != 0) {
+            ui eliminated = 0;
+
+            // Changed cells: empty => contradiction, newly fixed => clear value from peers
+            while (dirty[0] != 0 || dirty[1] != 0) {
+                ui word = dirty[0] != 0 ? 0 : 1;
+                ui self = (ui)std::countr_zero(dirty[word]) + 64 * word;
+                dirty[word] &= dirty[word] - 1;
+
+                us bit = cells[self];
+                if (bit == 0) {
+                    listener.onEliminate(NO_VALUE_POSSIBLE, GPos((uc)(self % 9), (uc)(self / 9)), 0, 0);
+                    totalEliminations += eliminated;
+                    listener.onSimplify(round, eliminated, totalEliminations);
+                    return false;
+                }
+
+                // The cell lost candidates, so its houses may now have a hidden single
+                const std::array<uc, 3>& houses = boardGeometry<3>.cellHouses[self];
+                dirtyHouses |= (1u << houses[0]) | (1u << houses[1]) | (1u << houses[2]);
+
+                // Naked Single: eliminate from row, column and chunk
+                if (std::popcount(bit) == 1)
+                    eliminateFromPeers(self, eliminated, listener);
+            }
+
+            // Queued houses: a value possible in exactly one cell of the house goes there
+            while (dirtyHouses != 0) {
+                ui house = (ui)std::countr_zero(dirtyHouses);
+                dirtyHouses &= dirtyHouses - 1;
+
+                us once = 0, twice = 0;
+                for (ui k = 0; k < 9; k++) {
+                    us mask = cells[houseCell(house, k)];
+                    twice |= once & mask;
+                    once |= mask;
+                }
+                if (once != 0x1FF) {
+                    // Some value has no cell left in this house
+                    reportMissingValue(house, once, listener);
+                    totalEliminations += eliminated;
+                    listener.onSimplify(round, eliminated, totalEliminations);
+                    return false;
+                }
+                us unique = once & (us)~twice;
+                if (unique != 0)
+                    assignHiddenSingles(house, unique, eliminated, listener);
+            }
+
+            if (eliminated == 0)
+                break;
+            totalEliminations += eliminated;
+            listener.onSimplify(round++, eliminated, totalEliminations);
+        }
+
+        // Singles stalled: try the stronger rules, cheapest first, and queue what they changed
+        ui eliminated = 0;
+        applyRuleTiers(eliminated, listener);
+        if (eliminated == 0)
+            break;
+        totalEliminations += eliminated;
+        listener.onSimplify(round++, eliminated, totalEliminations);
+    }
+    return true;
+}
+
+template <class Listener>
+bool SudokuBoard::dfsSolve(SudokuBoard& board, SearchPath& path, bool assigned[81], Listener& listener, SearchControl& control) {
+    // One frame per branch level; every level fixes an unfixed cell, so 81 always suffice
+    std::array<SearchFrame, 81> frames;
+    ui depth = 0;
+    while (true) {
+        // Expand the node at the end of path; a failed node leaves dead set
+        bool dead = true;
+        if (++control.nodes > control.nodeLimit) {
+            // Out of budget: give up this attempt (the caller restarts)
+            control.aborted = true;
+        } else if (control.budget != nullptr && (control.nodes & (BUDGET_CHECK_INTERVAL - 1)) == 0 && budgetExpired(control)) {
+            // Out of time or cancelled: rarely enough that the clock stays out of the profile
+            control.aborted = true;
+        } else {
+            listener.onNode(path);
+
+            // First, propagate the logical rules from whatever changed since the last node
+            // (the events get the current path attached on the way to the listener)
+            ulli totalEliminations;
+            NodeListener<Listener> nodeListener = { listener, path, assigned };
+            listener.onPropagateBegin(path);
+            bool consistent = board.propagate(totalEliminations, nodeListener);
+            listener.onPropagateEnd(path, consistent);
+
+            // If all cells now have exactly one candidate, puzzle is solved
+            if (consistent && board.isSolved())
+                return true;
+
+            // A state met before (in another order or attempt) is as dead as it was then
+            ulli key = board.hash;
+            if (consistent && board.table != nullptr) {
+                ulli known;
+                bool hit = board.table->probe(key, known) && known == 0;
+                listener.onTableProbe(hit);
+                consistent = !hit;
+            }
+
+            // Let the branching strategy choose the alternatives (MRV: the candidates of one cell);
+            // none left for some cell is a dead end
+            if (consistent) {
+                SearchFrame& frame = frames[depth];
+                frame.choice = board.chooseBranch(control);
+                if (frame.choice.count != 0) {
+                    // Every alternative starts from this state, so it is saved once for all of them
+                    frame.next = 0;
+                    frame.key = key;
+                    if (board.trail != nullptr)
+                        frame.mark = board.markTrail();
+                    else
+                        frame.history = board.saveSnapshot();
+                    depth++;
+                    dead = false;
+                }
+            }
+        }
+
+        // Back up: roll back the branch that led here, and further up while a level has no
+        // alternative left (or the attempt is aborted, which unwinds every level)
+        while (dead) {
+            if (depth == 0)
+                return false;
+            SearchFrame& frame = frames[depth - 1];
+            path.pop_back();
+            assigned[frame.choice.cell[frame.next - 1]] = false;
+            if (board.trail != nullptr)
+                board.undoTrail(frame.mark);
+            else
+                board.restoreSnapshot(frame.history);
+            listener.onBacktrack(path);
+            if (!control.aborted && frame.next < frame.choice.count)
+                break;
+            // Every alternative failed: the node's state has no solution
+            if (board.table != nullptr && !control.aborted)
+                board.table->store(frame.key, 0);
+            depth--;
+        }
+
+        // Take the next alternative of the innermost level: force the cell to the value
+        // (eliminate other bits), mark it as assigned and record the branch taken
+        SearchFrame& frame = frames[depth - 1];
+        ui branchIndex = frame.next++;
+        ui self = frame.choice.cell[branchIndex];
+        GPos pos((uc)(self % 9), (uc)(self / 9));
+        board.makeSureAt(pos, frame.choice.value[branchIndex], false);
+        assigned[self] = true;
+        path.push_back(branchIndex);
+        listener.onAssign(path, assigned, pos);
+    }
+}
+
+template <class Listener>
+SolveStatus SudokuBoard::runSearch(SearchPath& path, bool assigned[81], Listener& listener, const SolveBudget* budget) {
+    // Initialize path with a dummy 0: every branch level pushes its index after it
+    path.clear();
+    path.push_back(0);
+    bool restarts = branchStrategy == BRANCH_RANDOM_RESTART;
+    ulli attemptNodes = restarts ? RESTART_NODES : ~0ULL;
+    // Nodes still allowed by the budget, over all attempts
+    ulli budgetNodes = budget != nullptr && budget->maxNodes != 0 ? budget->maxNodes : ~0ULL;
+    SearchControl control = { 0, std::min(attemptNodes, budgetNodes), randomSeed, false };
+    if (budget != nullptr) {
+        if (budget->cancel != nullptr && budget->cancel->load(std::memory_order_relaxed))
+            return SOLVE_CANCELLED;
+        control.budget = budget;
+        if (budget->maxMicros != 0)
+            control.deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget->maxMicros);
+    }
+
+    // An aborted attempt goes back to the initial state and tries again with twice the
+    // nodes, unless the caller's budget is what ran out: then the search ends there
+    SolveStatus status = SOLVE_NO_SOLUTION;
+    auto restart = [&]() {
+        if (!control.aborted)
+            return false;
+        status = control.stop;
+        if (status != SOLVE_NO_SOLUTION)
+            return true;
+        if (budgetNodes != ~0ULL)
+            budgetNodes -= control.nodeLimit;
+        if (budgetNodes == 0) {
+            status = SOLVE_BUDGET_EXCEEDED;
+            return true;
+        }
+        attemptNodes *= 2;
+        control = { 0, std::min(attemptNodes, budgetNodes), control.random, false, control.budget, control.deadline };
+        return true;
+    };
+    if (backtrackMode == BACKTRACK_SNAPSHOT) {
+        Snapshot initial = saveSnapshot();
+        while (!dfsSolve(*this, path, assigned, listener, control)) {
+            if (!restart())
+                return SOLVE_NO_SOLUTION;
+            restoreSnapshot(initial);
+            if (status != SOLVE_NO_SOLUTION)
+                return status;
+        }
+        return SOLVE_SOLVED;
+    }
+
+    // Record every change on a local trail while the search runs
+    SearchTrail searchTrail;
+    struct TrailScope {
+        SearchTrail*& trail;
+        ~TrailScope() { trail = nullptr; }
+    } scope = { trail };
+    trail = &searchTrail;
+    TrailMark initial = markTrail();
+    while (!dfsSolve(*this, path, assigned, listener, control)) {
+        if (!restart())
+            return SOLVE_NO_SOLUTION;
+        undoTrail(initial);
+        if (status != SOLVE_NO_SOLUTION)
+            return status;
+    }
+    return SOLVE_SOLVED;
+}
+
+template <class Listener>
+bool SudokuBoard::dfsSolve(SearchPath& path, bool assigned[81], Listener& listener) {
+    return runSearch(path, assigned, listener, nullptr) == SOLVE_SOLVED;
+}
+
+template <class Listener>
+SolveStatus SudokuBoard::solveWithin(SearchPath& path, const SolveBudget& budget, bool assigned[81], Listener& listener) {
+    return runSearch(path, assigned, listener, &budget);
+}
+
+template <class Listener>
+SolveStatus SudokuBoard::solveWithin(const SolveBudget& budget, bool assigned[81], Listener& listener) {
+    SearchPath path;
+    return solveWithin(path, budget, assigned, listener);
+}
+
+template <class Listener>
+bool SudokuBoard::dfsSolve(bool assigned[81], Listener& listener) {
+    // Create a local path and call the main solver
+    SearchPath path;
+    return dfsSolve(path, assigned, listener);
+}
+
+template <class Listener>
+bool SudokuBoard::countSolutions(SudokuBoard& board, SearchPath& path, bool assigned[81], ulli limit, SolutionCount& result, Listener& listener, SearchControl& control) {
+    // Same frame stack as dfsSolve(); done ends the count and unwinds every level
+    std::array<SearchFrame, 81> frames;
+    ui depth = 0;
+    bool done = false;
+    while (true) {
+        // Expand the node at the end of path; a node with no alternatives to count leaves expanded unset
+        bool expanded = false;
+        if (control.budget != nullptr && (++control.nodes > control.nodeLimit
+                || ((control.nodes & (BUDGET_CHECK_INTERVAL - 1)) == 0 && budgetExpired(control)))) {
+            // Ending the count like a reached limit unwinds it without storing partial counts
+            if (control.stop == SOLVE_NO_SOLUTION)
+                control.stop = SOLVE_BUDGET_EXCEEDED;
+            done = true;
+        } else {
+            listener.onNode(path);
+            ulli totalEliminations;
+            NodeListener<Listener> nodeListener = { listener, path, assigned };
+            listener.onPropagateBegin(path);
+            bool consistent = board.propagate(totalEliminations, nodeListener);
+            listener.onPropagateEnd(path, consistent);
+
+            if (consistent && board.isSolved()) {
+                if (result.solutions++ == 0)
+                    result.firstSolution = board.copyData();
+                done = result.solutions >= limit;
+            } else if (consistent) {
+                // A state counted before adds its solutions, unless the first one is still needed
+                ulli key = board.hash;
+                ulli before = result.solutions;
+                bool hit = false;
+                if (board.table != nullptr) {
+                    ulli known;
+                    hit = board.table->probe(key, known) && (known == 0 || before > 0);
+                    listener.onTableProbe(hit);
+                    if (hit) {
+                        result.solutions = std::min(limit, before + known);
+                        done = result.solutions >= limit;
+                    }
+                }
+
+                if (!hit) {
+                    SearchFrame& frame = frames[depth];
+                    frame.choice = board.chooseBranch(control);
+                    if (frame.choice.count != 0) {
+                        frame.next = 0;
+                        frame.key = key;
+                        frame.before = before;
+                        if (board.trail != nullptr)
+                            frame.mark = board.markTrail();
+                        else
+                            frame.history = board.saveSnapshot();
+                        depth++;
+                        expanded = true;
+                    }
+                }
+            }
+        }
+
+        // Roll back even after a solution: the count goes on with the next alternative, and
+        // further up while a level has none left (or the count is done, which unwinds every level)
+        while (!expanded) {
+            if (depth == 0)
+                return done;
+            SearchFrame& frame = frames[depth - 1];
+            path.pop_back();
+            assigned[frame.choice.cell[frame.next - 1]] = false;
+            if (board.trail != nullptr)
+                board.undoTrail(frame.mark);
+            else
+                board.restoreSnapshot(frame.history);
+            listener.onBacktrack(path);
+            if (!done && frame.next < frame.choice.count)
+                break;
+            // Stopping at the limit leaves the subtree partly counted
+            if (board.table != nullptr && !done)
+                board.table->store(frame.key, result.solutions - frame.before);
+            depth--;
+        }
+
+        SearchFrame& frame = frames[depth - 1];
+        ui branchIndex = frame.next++;
+        ui self = frame.choice.cell[branchIndex];
+        GPos pos((uc)(self % 9), (uc)(self / 9));
+        board.makeSureAt(pos, frame.choice.value[branchIndex], false);
+        assigned[self] = true;
+        path.push_back(branchIndex);
+        listener.onAssign(path, assigned, pos);
+    }
+}
+
+template <class Listener>
+SolutionCount SudokuBoard::countSolutions(ulli limit, Listener& listener) {
+    return runCount(limit, listener, nullptr);
+}
+
+template <class Listener>
+SolutionCount SudokuBoard::countSolutionsWithin(ulli limit, const SolveBudget& budget, Listener& listener) {
+    return runCount(limit, listener, &budget);
+}
+
+template <class Listener>
+SolutionCount SudokuBoard::runCount(ulli limit, Listener& listener, const SolveBudget* budget) {
+    SolutionCount result = { 0, {}, false };
+    SearchPath path;
+    path.push_back(0);
+    bool assigned[81] = {};
+    if (limit == 0)
+        limit = 1;
+    SearchControl control = { 0, ~0ULL, randomSeed, false };
+    if (budget != nullptr) {
+        if (budget->cancel != nullptr && budget->cancel->load(std::memory_order_relaxed)) {
+            result.stopped = true;
+            return result;
+        }
+        control.budget = budget;
+        if (budget->maxNodes != 0)
+            control.nodeLimit = budget->maxNodes;
+        if (budget->maxMicros != 0)
+            control.deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget->maxMicros);
+    }
+
+    if (backtrackMode == BACKTRACK_SNAPSHOT) {
+        Snapshot initial = saveSnapshot();
+        countSolutions(*this, path, assigned, limit, result, listener, control);
+        restoreSnapshot(initial);
+        result.stopped = control.stop != SOLVE_NO_SOLUTION;
+        return result;
+    }
+
+    // Record every change on a local trail and unwind it completely at the end
+    SearchTrail searchTrail;
+    struct TrailScope {
+        SearchTrail*& trail;
+        ~TrailScope() { trail = nullptr; }
+    } scope = { trail };
+    trail = &searchTrail;
+    TrailMark initial = markTrail();
+    countSolutions(*this, path, assigned, limit, result, listener, control);
+    undoTrail(initial);
+    result.stopped = control.stop != SOLVE_NO_SOLUTION;
+    return result;
+}
@@ -0,0 +1,394 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "BoardGeometry.h"
+#include "SolveStats.h"
+
+#include <vector>
+#include <array>
+#include <bit>
+
+/**
+ * @file
+ * @brief Generic board for Sudoku of any box size: 16x16 (BOX 4), 25x25 (BOX 5), ...
+ *
+ * SudokuBoard stays the 9x9 engine, with its SIMD kernels, rule tiers and branching
+ * strategies. SudokuBoardN<BOX> is the same design reduced to what larger boards need:
+ * per-cell candidate masks of the smallest fitting type, per-house "placed" masks,
+ * queue-driven naked and hidden singles between search steps, first-found MRV branching and
+ * trail-based undo. All geometry (house cells, the houses of a cell, the peers of a cell)
+ * comes from the compile-time tables of BoardGeometry.h.
+ *
+ * In text form a cell holds '1'..'9' and then 'A'.. ('a'.. also accepted) for the values
+ * 1..BOX^2, e.g. '1'..'G' for 16x16 and '1'..'P' for 25x25; any other character is empty.
+ */
+
+/**
+ * @class SudokuBoardN
+ * @brief Candidate masks, single propagation and DFS for a BOX^2 x BOX^2 Sudoku.
+ * @tparam BOX Chunk side length, 2..5 (the mask type is at most 32 bits).
+ */
+template <ui BOX>
+class SudokuBoardN {
+public:
+    typedef BoardGeometry<BOX> Geometry;
+    typedef typename Geometry::Mask Mask;
+
+    static constexpr ui SIZE = Geometry::SIZE;      /**< Values, and cells per house */
+    static constexpr ui CELLS = Geometry::CELLS;    /**< Cells of the board */
+    static constexpr ui HOUSES = Geometry::HOUSES;  /**< Houses of the board */
+    static constexpr Mask ALL = Geometry::ALL;      /**< Mask with every value possible */
+
+    static_assert(BOX >= 2 && BOX <= 5, "SudokuBoardN supports chunk sizes 2..5");
+
+private:
+    static constexpr ui CELL_WORDS = Geometry::CELL_WORDS; /**< 64-bit words of a cell bitset */
+    static constexpr ui HOUSE_WORDS = (HOUSES + 63) / 64; /**< 64-bit words of a house bitset */
+
+    /**
+     * @struct Change
+     * @brief One trail entry: a cell (slot < CELLS) or "placed" mask (CELLS + house) and its old value.
+     */
+    struct Change {
+        us slot;   /**< What changed */
+        Mask old;  /**< Value before the change */
+    };
+
+    std::array<Mask, CELLS> cells;                /**< Candidate mask per cell (row-major) */
+    std::array<Mask, HOUSES> placed;              /**< Per house: values already eliminated from its other cells */
+    std::array<ulli, CELL_WORDS> dirty;           /**< Cells changed since the last propagate() */
+    std::array<ulli, HOUSE_WORDS> dirtyHouses;    /**< Houses to re-check for hidden singles */
+    std::vector<Change> trail;                    /**< Every change made while dfsSolve() runs */
+    bool recording;                               /**< true while dfsSolve() records on the trail */
+
+    /**
+     * @brief Change a cell mask, recording the old mask while searching, and queue the cell.
+     * @param cell Row-major cell index.
+     * @param mask New candidate mask.
+     */
+    void setCell(ui cell, Mask mask) {
+        if (recording)
+            trail.push_back({ (us)cell, cells[cell] });
+        cells[cell] = mask;
+        dirty[cell / 64] |= 1ULL << (cell % 64);
+    }
+
+    /**
+     * @brief Change a house "placed" mask, recording the old mask while searching.
+     * @param house House index.
+     * @param mask New mask.
+     */
+    void setPlaced(ui house, Mask mask) {
+        if (recording)
+            trail.push_back({ (us)(CELLS + house), placed[house] });
+        placed[house] = mask;
+    }
+
+    /**
+     * @brief Unwind the trail back to an earlier length.
+     * @param length Trail size to return to.
+     */
+    void undoTrail(size_t length) {
+        while (trail.size() > length) {
+            const Change& change = trail.back();
+            if (change.slot < CELLS)
+                cells[change.slot] = change.old;
+            else
+                placed[change.slot - CELLS] = change.old;
+            trail.pop_back();
+        }
+    }
+
+    /**
+     * @brief Naked Single: eliminate a fixed cell's value from its peers, once per value and house.
+     * @param self Row-major index of a cell with exactly one candidate.
+     * @param eliminations Increased by the number of candidate bits cleared.
+     */
+    void eliminateFromPeers(ui self, ui& eliminations);
+
+    /**
+     * @brief Hidden Single: fix every cell of a house holding one of the given values.
+     * @param house House index.
+     * @param unique Values with exactly one possible cell in the house.
+     * @param eliminations Increased by the number of candidate bits cleared.
+     */
+    void assignHiddenSingles(ui house, Mask unique, ui& eliminations);
+
+    /**
+     * @brief Recursive DFS on a freshly changed board (see dfsSolve(SolveStats&)).
+     * @param stats Receives the assignments and simplification rounds.
+     * @return true if solved; the board then holds the solution.
+     */
+    bool search(SolveStats& stats);
+
+public:
+    /**
+     * @brief Constructor. Creates an empty board with all candidates possible.
+     */
+    SudokuBoardN();
+
+    /**
+     * @brief Constructor. Reads a puzzle in text form.
+     * @param text CELLS characters, row-major (see symbolValue()).
+     */
+    explicit SudokuBoardN(const char* text);
+
+    /**
+     * @brief Get the value of a text cell.
+     * @param c Character of the cell.
+     * @return Value 1..SIZE, or 0 for an empty cell.
+     */
+    static ui symbolValue(char c);
+
+    /**
+     * @brief Get the text character of a value.
+     * @param value Value 1..SIZE.
+     * @return '1'..'9', then 'A'...
+     */
+    static char valueSymbol(ui value);
+
+    /**
+     * @brief Get the candidates of a cell.
+     * @param cell Row-major cell index.
+     * @return Candidate mask, bit v-1 set if v is possible.
+     */
+    Mask getCandidateMask(ui cell) const;
+
+    /**
+     * @brief Fix a cell to one value.
+     * @param cell Row-major cell index.
+     * @param value Value 1..SIZE.
+     */
+    void assign(ui cell, ui value);
+
+    /**
+     * @brief Apply naked and hidden singles to every changed cell and house until nothing changes.
+     * @param stats Its simplifications counter is increased once per round that changed something.
+     * @return false if a contradiction was found (a cell or a value in a house without options).
+     */
+    bool propagate(SolveStats& stats);
+
+    /**
+     * @brief Check if every cell has exactly one candidate.
+     * @return true if solved (after propagate(), the values are consistent).
+     */
+    bool isSolved() const;
+
+    /**
+     * @brief Solve the board by propagation and DFS over the cell with the fewest candidates.
+     * @param stats Receives the tentative assignments and simplification rounds.
+     * @return true if a solution was found; the board then holds it. Otherwise it is unchanged.
+     */
+    bool dfsSolve(SolveStats& stats);
+
+    /**
+     * @brief Write the board in text form.
+     * @param out Receives CELLS characters: the value of each fixed cell, '.' for the others.
+     */
+    void writeValues(char* out) const;
+};
+
+template <ui BOX>
+SudokuBoardN<BOX>::SudokuBoardN() : placed(), dirtyHouses(), recording(false) {
+    cells.fill(ALL);
+    dirty.fill(0);
+}
+
+template <ui BOX>
+SudokuBoardN<BOX>::SudokuBoardN(const char* text) : SudokuBoardN() {
+    for (ui cell = 0; cell < CELLS; cell++) {
+        ui value = symbolValue(text[cell]);
+        if (value != 0)
+            assign(cell, value);
+    }
+}
+
+template <ui BOX>
+ui SudokuBoardN<BOX>::symbolValue(char c) {
+    ui value = 0;
+    if (c >= '1' && c <= '9')
+        value = (ui)(c - '0');
+    else if (c >= 'A' && c <= 'Z')
+        value = (ui)(c - 'A') + 10;
+    else if (c >= 'a' && c <= 'z')
+        value = (ui)(c - 'a') + 10;
+    return value <= SIZE ? value : 0;
+}
+
+template <ui BOX>
+char SudokuBoardN<BOX>::valueSymbol(ui value) {
+    return value <= 9 ? (char)('0' + value) : (char)('A' + value - 10);
+}
+
+template <ui BOX>
+typename SudokuBoardN<BOX>::Mask SudokuBoardN<BOX>::getCandidateMask(ui cell) const {
+    return cells[cell];
+}
+
+template <ui BOX>
+void SudokuBoardN<BOX>::assign(ui cell, ui value) {
+    setCell(cell, (Mask)(1u << (value - 1)));
+}
+
+template <ui BOX>
+void SudokuBoardN<BOX>::eliminateFromPeers(ui self, ui& eliminations) {
+    constexpr const BoardGeometry<BOX>& g = boardGeometry<BOX>;
+    const auto& houses = g.cellHouses[self];
+    Mask bit = cells[self];
+    if (placed[houses[0]] & placed[houses[1]] & placed[houses[2]] & bit)
+        return;
+
+    for (us peer : g.peers[self]) {
+        if (cells[peer] & bit) {
+            setCell(peer, cells[peer] & (Mask)~bit);
+            eliminations++;
+        }
+    }
+    for (uc house : houses)
+        setPlaced(house, placed[house] | bit);
+}
+
+template <ui BOX>
+void SudokuBoardN<BOX>::assignHiddenSingles(ui house, Mask unique, ui& eliminations) {
+    for (us cell : boardGeometry<BOX>.houseCells[house]) {
+        Mask bit = cells[cell] & unique;
+        int count = std::popcount(cells[cell]);
+        if (bit == 0 || count == 1)
+            continue;
+        // The lowest unique value wins if there are several
+        bit &= (Mask)(0u - bit);
+        eliminations += count - 1;
+        setCell(cell, bit);
+    }
+}
+
+template <ui BOX>
+bool SudokuBoardN<BOX>::propagate(SolveStats& stats) {
+    constexpr const BoardGeometry<BOX>& g = boardGeometry<BOX>;
+    auto anyDirty = [](const auto& words) {
+        for (ulli word : words) {
+            if (word != 0)
+                return true;
+        }
+        return false;
+    };
+
+    while (anyDirty(dirty) || anyDirty(dirtyHouses)) {
+        ui eliminated = 0;
+
+        // Changed cells: empty => contradiction, newly fixed => clear value from peers
+        while (true) {
+            ui word = 0;
+            while (word < CELL_WORDS && dirty[word] == 0)
+                word++;
+            if (word == CELL_WORDS)
+                break;
+            ui self = (ui)std::countr_zero(dirty[word]) + 64 * word;
+            dirty[word] &= dirty[word] - 1;
+
+            Mask bit = cells[self];
+            if (bit == 0) {
+                stats.simplifications++;
+                return false;
+            }
+            // The cell lost candidates, so its houses may now have a hidden single
+            for (uc house : g.cellHouses[self])
+                dirtyHouses[house / 64] |= 1ULL << (house % 64);
+            if (std::popcount(bit) == 1)
+                eliminateFromPeers(self, eliminated);
+        }
+
+        // Queued houses: a value possible in exactly one cell of the house goes there
+        for (ui word = 0; word < HOUSE_WORDS; word++) {
+            while (dirtyHouses[word] != 0) {
+                ui house = (ui)std::countr_zero(dirtyHouses[word]) + 64 * word;
+                dirtyHouses[word] &= dirtyHouses[word] - 1;
+                Mask once = 0, twice = 0;
+                for (us cell : g.houseCells[house]) {
+                    twice |= once & cells[cell];
+                    once |= cells[cell];
+                }
+                if (once != ALL) {
+                    stats.simplifications++;
+                    return false;
+                }
+                Mask unique = once & (Mask)~twice;
+                if (unique != 0)
+                    assignHiddenSingles(house, unique, eliminated);
+            }
+        }
+
+        if (eliminated == 0)
+            break;
+        stats.simplifications++;
+    }
+    return true;
+}
+
+template <ui BOX>
+bool SudokuBoardN<BOX>::isSolved() const {
+    for (Mask mask : cells) {
+        if (std::popcount(mask) != 1)
+            return false;
+    }
+    return true;
+}
+
+template <ui BOX>
+bool SudokuBoardN<BOX>::search(SolveStats& stats) {
+    if (!propagate(stats))
+        return false;
+
+    // MRV: the first cell with the fewest candidates (2 cannot be beaten)
+    ui best = CELLS;
+    int bestCount = (int)SIZE + 1;
+    for (ui cell = 0; cell < CELLS && bestCount > 2; cell++) {
+        int count = std::popcount(cells[cell]);
+        if (count > 1 && count < bestCount) {
+            best = cell;
+            bestCount = count;
+        }
+    }
+    if (best == CELLS)
+        return true;
+
+    // propagate() left no queued cell or house, so the trail length is the whole state
+    Mask options = cells[best];
+    size_t mark = trail.size();
+    for (Mask rest = options; rest != 0; rest &= rest - 1) {
+        setCell(best, rest & (Mask)(0u - rest));
+        stats.assignments++;
+        if (search(stats))
+            return true;
+        undoTrail(mark);
+        dirty.fill(0);
+        dirtyHouses.fill(0);
+    }
+    return false;
+}
+
+template <ui BOX>
+bool SudokuBoardN<BOX>::dfsSolve(SolveStats& stats) {
+    trail.clear();
+    recording = true;
+    // Undoing everything also restores the queues, so a failed search leaves the board as it was
+    std::array<ulli, CELL_WORDS> initialDirty = dirty;
+    std::array<ulli, HOUSE_WORDS> initialHouses = dirtyHouses;
+    bool solved = search(stats);
+    if (!solved) {
+        undoTrail(0);
+        dirty = initialDirty;
+        dirtyHouses = initialHouses;
+    }
+    recording = false;
+    trail.clear();
+    return solved;
+}
+
+template <ui BOX>
+void SudokuBoardN<BOX>::writeValues(char* out) const {
+    for (ui cell = 0; cell < CELLS; cell++) {
+        Mask mask = cells[cell];
+        out[cell] = std::popcount(mask) == 1 ? valueSymbol((ui)std::countr_zero(mask) + 1) : '.';
+    }
+}
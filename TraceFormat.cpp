@@ -0,0 +1,186 @@
+#include "TraceFormat.h"
+#include "ConsoleColors.h"
+
+#include <bit>
+
+bool printTraceBoard(std::ostream& out, const SudokuBoard& board, size_t spaces, const bool highlights[81], const char* highlightColor) {
+    bool hasContradiction = false;
+
+    for (ui y = 0; y < 9; y++) {
+        // Print horizontal separator every 3 rows
+        if (y % 3 == 0) {
+            for (size_t i = 0; i < spaces; i++) out << ' ';
+            out << ANSI_ESCAPE_GRAY << "+-------+-------+-------+" << ANSI_ESCAPE_RESET << '\n';
+        }
+        // Indent
+        for (size_t i = 0; i < spaces; i++) out << ' ';
+
+        for (ui x = 0; x < 9; x++) {
+            // Print vertical separator every 3 columns
+            if (x % 3 == 0) out << ANSI_ESCAPE_GRAY << "| " << ANSI_ESCAPE_RESET;
+
+            uc count;
+            uc val = board.getCellInfoAt(GPos(x, y), count);
+            if (val == 0) {
+                // If no single value assigned
+                if (count == 0) {
+                    // Contradiction: no candidates remain
+                    hasContradiction = true;
+                    out << ANSI_ESCAPE_RED << "! " << ANSI_ESCAPE_RESET;
+                    continue;
+                }
+                // Multiple candidates remain: print placeholder '-'
+                out << ANSI_ESCAPE_GRAY << '-' << ANSI_ESCAPE_RESET << ' ';
+            } else {
+                // Single value assigned
+                bool highlight = highlights[x + 9 * y];
+                if (highlight) out << highlightColor;
+                out << char('0' + val) << ' ';
+                if (highlight) out << ANSI_ESCAPE_RESET;
+            }
+        }
+        // Close row
+        out << ANSI_ESCAPE_GRAY << "|" << '\n';
+    }
+    // Print final horizontal separator
+    for (ui i = 0; i < spaces; i++) out << ' ';
+    out << ANSI_ESCAPE_GRAY << "+-------+-------+-------+" << ANSI_ESCAPE_RESET << '\n';
+
+    return hasContradiction;
+}
+
+void printAssignStep(std::ostream& out, const SudokuBoard& board, const SearchPath& path, const bool assigned[81], const GPos& justAssigned) {
+    // Indentation proportional to recursion depth
+    size_t spaces = (path.size() - 1) * 2;
+    for (size_t i = 0; i < spaces; i++) out << ' ';
+
+    // Print path of branch decisions (1-based for display)
+    for (size_t i = 1; i < path.size(); i++) {
+        if (i != 0) out << '.';
+        out << (path[i] + 1);
+    }
+
+    out << ANSI_ESCAPE_GRAY << "(T): " << ANSI_ESCAPE_RESET
+        << ANSI_ESCAPE_MAGENTA << "ASSIGN" << ANSI_ESCAPE_RESET
+        << ": (" << (int)(justAssigned.getX() + 1)
+        << ',' << (int)(justAssigned.getY() + 1) << ") = "
+        << ANSI_ESCAPE_MAGENTA
+        << ((int)board.getOnlyPossibleValue(justAssigned))
+        << ANSI_ESCAPE_RESET << '\n';
+
+    // Print board state after assignment
+    printTraceBoard(out, board, spaces, assigned, ANSI_ESCAPE_MAGENTA);
+
+    out << '\n'; // v1.1.4
+}
+
+void printSimplifyStep(std::ostream& out, const SudokuBoard& board, const SearchPath& path, ui index, ui eliminated, ulli eliminatedSum, const bool assigned[81]) {
+    // Indentation proportional to recursion depth
+    size_t spaces = (path.size()) * 2;
+    if (spaces >= 2) {
+        for (size_t i = 0; i < spaces - 2; i++) out << ' ';
+        out << ANSI_ESCAPE_GRAY << "> " << ANSI_ESCAPE_RESET;
+    }
+
+    // Print branch path
+    for (size_t i = 1; i < path.size(); i++) {
+        if (i != 0) out << '.';
+        out << (path[i] + 1);
+    }
+
+    out << ANSI_ESCAPE_GRAY << "(S." << (index + 1) << "): " << ANSI_ESCAPE_RESET
+        << ANSI_ESCAPE_GREEN << "SIMPLIFY" << ANSI_ESCAPE_RESET
+        << ": ELIMINATED = " << eliminated
+        << ANSI_ESCAPE_GRAY << "(sum = " << eliminatedSum << ")" << ANSI_ESCAPE_RESET
+        << '\n';
+
+    // Print board state after simplification
+    printTraceBoard(out, board, spaces, assigned, ANSI_ESCAPE_MAGENTA);
+
+    out << '\n'; // v1.1.3
+}
+
+void printEliminateStep(std::ostream& out, const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by, us candidates) {
+    // Indentation proportional to recursion depth
+    size_t spaces = (path.size()) * 2;
+    for (size_t i = 0; i < spaces; i++) out << ' ';
+
+    bool isElimination = !isAssignmentCause(cause);
+
+    out << ANSI_ESCAPE_GRAY << "-> ";
+    if (cause == NO_VALUE_POSSIBLE || cause == NO_PLACE_POSSIBLE) {
+        // Contradiction detected
+        out << ANSI_ESCAPE_MAGENTA << "IMPOSSIBLE" << ANSI_ESCAPE_RESET;
+    } else if (isElimination) {
+        // Candidate eliminated
+        out << ANSI_ESCAPE_RED << "ELIMINATED" << ANSI_ESCAPE_RESET;
+    } else {
+        // Hidden single assignment
+        out << ANSI_ESCAPE_GREEN << "BE DECIDED" << ANSI_ESCAPE_RESET;
+    }
+
+    if (cause == NO_PLACE_POSSIBLE) {
+        // A value has no cell left in a house: 'by' is the house index 0..26
+        const char* houseNames[3] = { "row", "column", "chunk" };
+        out << ": " << (int)value << " fits nowhere in " << houseNames[by / 9] << ' ' << (by % 9 + 1)
+            << ANSI_ESCAPE_RESET << '\n';
+        return;
+    }
+
+    // Print cell coordinates (1-based for display)
+    out << ": (" << ((int)cell.getX() + 1) << ", " << ((int)cell.getY() + 1) << ")";
+
+    if (cause == NO_VALUE_POSSIBLE) {
+        // Only print "IMPOSSIBLE", no further details
+        out << ANSI_ESCAPE_RESET << '\n';
+        return;
+    }
+
+    // Print the value eliminated or determined
+    out << ' ' << (isElimination ? '!' : '=') << "= " << (int)value;
+
+    // Print which house (row/column/chunk) caused this event
+    out << " by ";
+    if (cause >= LOCKED_CANDIDATE_BY_ROW) {
+        // Rule tiers above singles: name the rule, then its house
+        const char* ruleNames[5] = { "locked candidates", "naked pair", "hidden pair", "naked triple", "hidden triple" };
+        out << ruleNames[(cause - LOCKED_CANDIDATE_BY_ROW) / 3] << " in ";
+    }
+    int classification = (cause - 1) % 3;
+    if (classification == 0) {
+        out << "row";
+    } else if (classification == 1) {
+        out << "column";
+    } else if (classification == 2) {
+        out << "chunk";
+    }
+    out << ' ' << ((int)by + 1);
+    if (classification == 2) {
+        // For chunk, also display 3x3 coordinates (1-based)
+        out << '(' << (int)(by % 3 + 1) << ", " << ((int)(by / 3) + 1) << ')';
+    }
+
+    // Print remaining candidates for that cell in gray
+    out << ANSI_ESCAPE_GRAY << " {";
+    bool isFirst = true;
+    for (uc v = 1; v <= 9; v++) {
+        if ((candidates >> (v - 1) & 1) == 0) continue;
+        if (!isFirst) out << ", ";
+        out << (int)v;
+        isFirst = false;
+    }
+    out << "}(" << std::popcount(candidates) << ")" << ANSI_ESCAPE_RESET;
+
+    // If exactly one candidate remains after elimination, mark it
+    if (std::has_single_bit(candidates))
+        out << ANSI_ESCAPE_GREEN << " (!)" << ANSI_ESCAPE_RESET;
+
+    out << ANSI_ESCAPE_RESET << '\n';
+}
+
+void printSolveSummary(std::ostream& out, const SolveStats& stats, double seconds) {
+    out << ANSI_ESCAPE_GRAY << '>' << ANSI_ESCAPE_RESET << " Solved in "
+        << ANSI_ESCAPE_YELLOW << stats.assignments     << ANSI_ESCAPE_RESET << " Tentative Assignments, "
+        << ANSI_ESCAPE_YELLOW << stats.simplifications << ANSI_ESCAPE_RESET << " Simplifications, "
+        << ANSI_ESCAPE_GREEN  << seconds               << ANSI_ESCAPE_RESET << " seconds." << '\n';
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "SolveStats.h"
+
+#include <ostream>
+
+/**
+ * @file
+ * @brief Human-readable trace of the descriptive mode.
+ *
+ * Shared by the live "--describe" output of the solver and by SudokuTraceRender, which
+ * prints a binary trace recorded by a TraceSink in the same format. The functions write
+ * to a stream and never flush it.
+ */
+
+/**
+ * @brief Print a board, optionally highlighting certain cells.
+ *
+ * Cells with a single candidate are printed as digits; cells with several candidates are
+ * shown as '-' and cells with none as '!'. Highlighted determined cells are printed in
+ * highlightColor.
+ *
+ * @param out Stream to print to.
+ * @param board Board to print.
+ * @param spaces Number of leading spaces to indent each printed line (to indicate recursion depth).
+ * @param highlights Boolean array of length 81, where true indicates the cell should be highlighted.
+ * @param highlightColor Escape sequence of highlighted cells.
+ * @return true if any cell has zero candidates (contradiction), false otherwise.
+ */
+bool printTraceBoard(std::ostream& out, const SudokuBoard& board, size_t spaces, const bool highlights[81], const char* highlightColor);
+
+/**
+ * @brief Print a tentative value assigned to a cell during DFS, and the board after it.
+ * @param out Stream to print to.
+ * @param board Board right after the assignment.
+ * @param path Branch indices taken so far.
+ * @param assigned Boolean array of length 81 indicating which cells are currently assigned.
+ * @param justAssigned Cell that was just assigned a definite value.
+ */
+void printAssignStep(std::ostream& out, const SudokuBoard& board, const SearchPath& path, const bool assigned[81], const GPos& justAssigned);
+
+/**
+ * @brief Print a simplification pass, and the board after it.
+ * @param out Stream to print to.
+ * @param board Board right after the pass.
+ * @param path Branch indices taken so far.
+ * @param index Index of the simplification iteration (0-based).
+ * @param eliminated Number of candidate bits eliminated in this pass.
+ * @param eliminatedSum Accumulated total elimination count so far.
+ * @param assigned Boolean array of length 81 indicating which cells are assigned.
+ */
+void printSimplifyStep(std::ostream& out, const SudokuBoard& board, const SearchPath& path, ui index, ui eliminated, ulli eliminatedSum, const bool assigned[81]);
+
+/**
+ * @brief Print a single candidate elimination or determination.
+ *
+ * Tells whether the cause was an elimination, a determination or a contradiction, which
+ * cell and value were affected, by which house (row/column/chunk) and rule, and the
+ * candidates left in the cell.
+ *
+ * @param out Stream to print to.
+ * @param path Branch indices taken so far.
+ * @param cause Type of elimination or assignment.
+ * @param cell Cell where the elimination/assignment occurred.
+ * @param value The candidate value (1..9) that was eliminated or determined.
+ * @param by Index (0-based) of the row/column/chunk responsible, or the house 0..26 for NO_PLACE_POSSIBLE.
+ * @param candidates Candidate mask of the cell right after the event (bit v-1 = value v).
+ */
+void printEliminateStep(std::ostream& out, const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by, us candidates);
+
+/**
+ * @brief Print the summary line below a solved board.
+ * @param out Stream to print to.
+ * @param stats Counters of the solve.
+ * @param seconds Solve time.
+ */
+void printSolveSummary(std::ostream& out, const SolveStats& stats, double seconds);
@@ -0,0 +1,81 @@
+#include "TraceSink.h"
+#include "TraceFormat.h"
+#include "ConsoleColors.h"
+
+#include <iostream>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @file
+ * @brief Offline renderer of binary traces: prints a file recorded with "SudokuSolver --trace"
+ * in the human-readable format of "SudokuSolver --describe".
+ *
+ * Every solve of the file is printed as the descriptive mode prints it: the starting board,
+ * each assignment, simplification pass and elimination with the board after it, and the
+ * answer with its summary line. The interactive prompts are not part of the trace.
+ *
+ * Usage: SudokuTraceRender [file|-]
+ * Without a file or with "-", the trace is read from stdin.
+ */
+
+/**
+ * @brief Print every record of a trace.
+ * @param reader Source of records.
+ * @param out Stream to print to.
+ */
+static void renderTrace(TraceReader& reader, std::ostream& out) {
+    TraceRecord record;
+    bool decidedAtStart[81] = {};
+    static const bool noHighlights[81] = {};
+    while (reader.next(record)) {
+        SudokuBoard board(record.board);
+        if (record.type == TRACE_BEGIN) {
+            for (ui i = 0; i < 81; i++)
+                decidedAtStart[i] = board.getOnlyPossibleValue(GPos((uc)(i % 9), (uc)(i / 9))) != 0;
+            out << '\n';
+            printTraceBoard(out, board, 0, noHighlights, nullptr);
+        } else if (record.type == TRACE_ASSIGN) {
+            printAssignStep(out, board, record.path, record.assigned, GPos((uc)(record.cell % 9), (uc)(record.cell / 9)));
+        } else if (record.type == TRACE_SIMPLIFY) {
+            printSimplifyStep(out, board, record.path, record.index, record.eliminated, record.eliminatedSum, record.assigned);
+        } else if (record.type == TRACE_ELIMINATE) {
+            printEliminateStep(out, record.path, record.cause, GPos((uc)(record.cell % 9), (uc)(record.cell / 9)),
+                record.value, record.by, record.candidates);
+        } else {
+            out << '\n' << ">======== ANSWER ========" << '\n';
+            if (!record.solved) {
+                out << "> No solution found." << '\n';
+                continue;
+            }
+            printTraceBoard(out, board, 0, decidedAtStart, ANSI_ESCAPE_GRAY);
+            printSolveSummary(out, record.stats, record.stats.micros / 1'000'000.0);
+        }
+    }
+}
+
+/**
+ * @brief Entry point.
+ * @param argc Argument count.
+ * @param argv Arguments; an optional trace file ("-" or none for stdin).
+ * @return 0 on success, 1 if the file cannot be read or is malformed.
+ */
+int main(int argc, char* argv[]) {
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-' && argv[1][1] != '\0')) {
+        std::cerr << "usage: SudokuTraceRender [file|-]" << std::endl;
+        return 1;
+    }
+    const char* path = argc == 2 && std::strcmp(argv[1], "-") != 0 ? argv[1] : nullptr;
+
+    std::ios::sync_with_stdio(false);
+    try {
+        TraceReader reader(path);
+        renderTrace(reader, std::cout);
+    } catch (const std::runtime_error& e) {
+        std::cout.flush();
+        std::cerr << ANSI_ESCAPE_RED << "{error} " << e.what() << ANSI_ESCAPE_RESET << std::endl;
+        return 1;
+    }
+    std::cout.flush();
+    return 0;
+}
@@ -0,0 +1,358 @@
+#include "TraceSink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/** Bytes the writer waits for before writing, unless the trace goes quiet or is closed. */
+static const size_t WRITE_SIZE = 64 * 1024;
+
+/** Longest time recorded bytes wait in the ring before they are written. */
+static const std::chrono::milliseconds WRITE_DELAY(100);
+
+//======== Encoding helpers ========
+
+static unsigned char* putU16(unsigned char* out, us value) {
+    out[0] = (unsigned char)value;
+    out[1] = (unsigned char)(value >> 8);
+    return out + 2;
+}
+
+static unsigned char* putU32(unsigned char* out, ui value) {
+    for (ui i = 0; i < 4; i++)
+        out[i] = (unsigned char)(value >> (8 * i));
+    return out + 4;
+}
+
+static unsigned char* putU64(unsigned char* out, ulli value) {
+    for (ui i = 0; i < 8; i++)
+        out[i] = (unsigned char)(value >> (8 * i));
+    return out + 8;
+}
+
+static unsigned char* putBoard(unsigned char* out, const SudokuBoard& board) {
+    std::array<ulli, 12> data = board.copyData();
+    for (ulli word : data)
+        out = putU64(out, word);
+    return out;
+}
+
+static unsigned char* putAssigned(unsigned char* out, const bool assigned[81]) {
+    std::memset(out, 0, 11);
+    for (ui i = 0; i < 81; i++)
+        out[i / 8] |= (unsigned char)((assigned[i] ? 1 : 0) << (i % 8));
+    return out + 11;
+}
+
+//======== TraceSink ========
+
+TraceSink::TraceSink(const char* path, size_t ringSize)
+    : file(nullptr), ring(), ringMask(0), head(0), tail(0), waitingForSpace(false), closing(false), failed(false),
+      mutex(), dataReady(), spaceReady(), writer(), lastPath(), lastDepth(0) {
+    size_t size = MAX_RECORD_SIZE;
+    while (size < ringSize)
+        size *= 2;
+    ring.reset(new unsigned char[size]);
+    ringMask = size - 1;
+
+    file = std::fopen(path, "wb");
+    if (file == nullptr)
+        throw std::runtime_error(std::string("cannot create trace file ") + path);
+    unsigned char header[12];
+    std::memcpy(header, MAGIC, 8);
+    putU32(header + 8, VERSION);
+    if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        std::fclose(file);
+        throw std::runtime_error(std::string("cannot write trace file ") + path);
+    }
+    writer = std::thread(&TraceSink::drain, this);
+}
+
+TraceSink::~TraceSink() {
+    try {
+        close();
+    } catch (const std::runtime_error&) {
+    }
+}
+
+void TraceSink::drain() {
+    size_t ringSize = ringMask + 1;
+    size_t writeSize = std::min(WRITE_SIZE, ringSize / 4);
+    size_t start = tail.load(std::memory_order_relaxed);
+    while (true) {
+        // Read closing before head, so that once it is set the last record is visible
+        bool last = closing.load();
+        size_t end = head.load();
+        if (end - start < writeSize && !last) {
+            // Quiet: hand what was written so far to the OS
+            if (end == start && std::fflush(file) != 0)
+                failed.store(true);
+            std::unique_lock<std::mutex> lock(mutex);
+            dataReady.wait_for(lock, WRITE_DELAY, [&] { return closing.load() || head.load() - start >= writeSize; });
+            last = closing.load();
+            end = head.load();
+        }
+        if (end == start) {
+            if (last)
+                return;
+            continue;
+        }
+
+        // Write the pending bytes, in two pieces if they wrap around
+        while (start != end) {
+            size_t offset = start & ringMask;
+            size_t piece = std::min(end - start, ringSize - offset);
+            if (!failed.load() && std::fwrite(ring.get() + offset, 1, piece, file) != piece)
+                failed.store(true);
+            start += piece;
+        }
+        tail.store(start);
+        if (waitingForSpace.load()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            spaceReady.notify_one();
+        }
+    }
+}
+
+void TraceSink::put(const unsigned char* bytes, size_t size) {
+    size_t ringSize = ringMask + 1;
+    size_t writeSize = std::min(WRITE_SIZE, ringSize / 4);
+    size_t start = head.load(std::memory_order_relaxed);
+    if (start + size - tail.load() > ringSize) {
+        // Ring full: wait for the writer (the flag pairs with its check after moving tail)
+        waitingForSpace.store(true);
+        std::unique_lock<std::mutex> lock(mutex);
+        dataReady.notify_one();
+        spaceReady.wait(lock, [&] { return start + size - tail.load() <= ringSize; });
+        waitingForSpace.store(false);
+    }
+
+    size_t offset = start & ringMask;
+    size_t first = std::min(size, ringSize - offset);
+    std::memcpy(ring.get() + offset, bytes, first);
+    std::memcpy(ring.get(), bytes + first, size - first);
+    head.store(start + size);
+
+    // Wake the writer once per writeSize bytes
+    if ((start + size) / writeSize != start / writeSize) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dataReady.notify_one();
+    }
+}
+
+size_t TraceSink::encodePath(const SearchPath& path, unsigned char* out) {
+    size_t depth = path.size();
+    size_t keep = 0;
+    while (keep < depth && keep < lastDepth && lastPath[keep] == path[keep])
+        keep++;
+    out[0] = (unsigned char)depth;
+    out[1] = (unsigned char)keep;
+    for (size_t i = keep; i < depth; i++) {
+        lastPath[i] = (uc)path[i];
+        out[2 + i - keep] = (unsigned char)path[i];
+    }
+    lastDepth = depth;
+    return 2 + depth - keep;
+}
+
+void TraceSink::begin(const SudokuBoard& board) {
+    unsigned char record[MAX_RECORD_SIZE];
+    record[0] = TRACE_BEGIN;
+    unsigned char* out = putBoard(record + 1, board);
+    lastDepth = 0;
+    put(record, out - record);
+}
+
+void TraceSink::assign(const SudokuBoard& board, const SearchPath& path, const bool assigned[81], const GPos& justAssigned) {
+    unsigned char record[MAX_RECORD_SIZE];
+    record[0] = TRACE_ASSIGN;
+    unsigned char* out = record + 1 + encodePath(path, record + 1);
+    *out++ = (unsigned char)(justAssigned.getX() + 9 * justAssigned.getY());
+    out = putBoard(out, board);
+    out = putAssigned(out, assigned);
+    put(record, out - record);
+}
+
+void TraceSink::simplify(const SudokuBoard& board, const SearchPath& path, ui index, ui eliminated, ulli eliminatedSum, const bool assigned[81]) {
+    unsigned char record[MAX_RECORD_SIZE];
+    record[0] = TRACE_SIMPLIFY;
+    unsigned char* out = record + 1 + encodePath(path, record + 1);
+    out = putU32(out, index);
+    out = putU32(out, eliminated);
+    out = putU64(out, eliminatedSum);
+    out = putBoard(out, board);
+    out = putAssigned(out, assigned);
+    put(record, out - record);
+}
+
+void TraceSink::eliminate(const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by, us candidates) {
+    unsigned char record[MAX_RECORD_SIZE];
+    record[0] = TRACE_ELIMINATE;
+    unsigned char* out = record + 1 + encodePath(path, record + 1);
+    *out++ = (unsigned char)(signed char)cause;
+    *out++ = (unsigned char)(cell.getX() + 9 * cell.getY());
+    *out++ = value;
+    *out++ = by;
+    out = putU16(out, candidates);
+    put(record, out - record);
+}
+
+void TraceSink::end(const SudokuBoard& board, bool solved, const SolveStats& stats) {
+    unsigned char record[MAX_RECORD_SIZE];
+    record[0] = TRACE_END;
+    record[1] = solved ? 1 : 0;
+    unsigned char* out = putU64(record + 2, stats.assignments);
+    out = putU64(out, stats.simplifications);
+    out = putU64(out, stats.micros);
+    out = putBoard(out, board);
+    put(record, out - record);
+}
+
+void TraceSink::close() {
+    if (!writer.joinable())
+        return;
+    closing.store(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        dataReady.notify_one();
+    }
+    writer.join();
+    if (std::fclose(file) != 0)
+        failed.store(true);
+    file = nullptr;
+    if (failed.load())
+        throw std::runtime_error("cannot write trace file");
+}
+
+//======== TraceReader ========
+
+static us getU16(const unsigned char* in) {
+    return (us)(in[0] | in[1] << 8);
+}
+
+static ui getU32(const unsigned char* in) {
+    ui value = 0;
+    for (ui i = 0; i < 4; i++)
+        value |= (ui)in[i] << (8 * i);
+    return value;
+}
+
+static ulli getU64(const unsigned char* in) {
+    ulli value = 0;
+    for (ui i = 0; i < 8; i++)
+        value |= (ulli)in[i] << (8 * i);
+    return value;
+}
+
+TraceReader::TraceReader(const char* path) : file(stdin), ownsFile(false), offset(0) {
+    if (path != nullptr) {
+        file = std::fopen(path, "rb");
+        if (file == nullptr)
+            throw std::runtime_error(std::string("cannot open trace file ") + path);
+        ownsFile = true;
+    }
+    unsigned char header[12];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)
+        || std::memcmp(header, TraceSink::MAGIC, 8) != 0) {
+        if (ownsFile)
+            std::fclose(file);
+        throw std::runtime_error("not a trace file");
+    }
+    if (getU32(header + 8) != TraceSink::VERSION) {
+        if (ownsFile)
+            std::fclose(file);
+        throw std::runtime_error("unsupported trace version " + std::to_string(getU32(header + 8)));
+    }
+    offset = sizeof(header);
+}
+
+TraceReader::~TraceReader() {
+    if (ownsFile)
+        std::fclose(file);
+}
+
+void TraceReader::read(void* out, size_t size) {
+    if (std::fread(out, 1, size, file) != size)
+        throw std::runtime_error("truncated trace record at byte " + std::to_string(offset));
+    offset += size;
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    int type = std::fgetc(file);
+    if (type == EOF)
+        return false;
+    ulli start = offset++;
+    record.type = (TraceRecordType)type;
+
+    unsigned char bytes[TraceSink::MAX_RECORD_SIZE];
+    if (type == TRACE_ASSIGN || type == TRACE_SIMPLIFY || type == TRACE_ELIMINATE) {
+        // Keep the shared prefix of the previous path, then append the new entries
+        unsigned char depthKeep[2];
+        read(depthKeep, 2);
+        size_t depth = depthKeep[0], keep = depthKeep[1];
+        if (depth > SearchPath::CAPACITY || keep > depth || keep > record.path.size())
+            throw std::runtime_error("malformed trace path at byte " + std::to_string(start));
+        while (record.path.size() > keep)
+            record.path.pop_back();
+        read(bytes, depth - keep);
+        for (size_t i = 0; i < depth - keep; i++)
+            record.path.push_back(bytes[i]);
+    }
+
+    auto readBoard = [&](const unsigned char* in) {
+        for (ui i = 0; i < 12; i++)
+            record.board[i] = getU64(in + 8 * i);
+    };
+    auto readAssigned = [&](const unsigned char* in) {
+        for (ui i = 0; i < 81; i++)
+            record.assigned[i] = (in[i / 8] >> (i % 8) & 1) != 0;
+    };
+
+    switch (type) {
+    case TRACE_BEGIN:
+        read(bytes, 96);
+        readBoard(bytes);
+        record.path.clear();
+        break;
+    case TRACE_ASSIGN:
+        read(bytes, 1 + 96 + 11);
+        record.cell = bytes[0];
+        readBoard(bytes + 1);
+        readAssigned(bytes + 97);
+        break;
+    case TRACE_SIMPLIFY:
+        read(bytes, 16 + 96 + 11);
+        record.index = getU32(bytes);
+        record.eliminated = getU32(bytes + 4);
+        record.eliminatedSum = getU64(bytes + 8);
+        readBoard(bytes + 16);
+        readAssigned(bytes + 112);
+        break;
+    case TRACE_ELIMINATE:
+        read(bytes, 6);
+        record.cause = (SimplificationCause)(signed char)bytes[0];
+        record.cell = bytes[1];
+        record.value = bytes[2];
+        record.by = bytes[3];
+        record.candidates = getU16(bytes + 4);
+        if (simplificationCauseName(record.cause) == nullptr)
+            throw std::runtime_error("malformed trace cause at byte " + std::to_string(start));
+        break;
+    case TRACE_END:
+        read(bytes, 1 + 24 + 96);
+        record.solved = bytes[0] != 0;
+        record.stats = SolveStats();
+        record.stats.assignments = getU64(bytes + 1);
+        record.stats.simplifications = getU64(bytes + 9);
+        record.stats.micros = getU64(bytes + 17);
+        readBoard(bytes + 25);
+        break;
+    default:
+        throw std::runtime_error("unknown trace record type " + std::to_string(type) + " at byte " + std::to_string(start));
+    }
+    if ((type == TRACE_ASSIGN || type == TRACE_ELIMINATE) && record.cell >= 81)
+        throw std::runtime_error("malformed trace cell at byte " + std::to_string(start));
+    return true;
+}
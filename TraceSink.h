@@ -0,0 +1,237 @@
+#pragma once
+
+#include "SudokuBoard.h"
+#include "SolveStats.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @file
+ * @brief Binary trace of the descriptive mode: TraceSink records it, TraceReader reads it back.
+ *
+ * A trace file starts with the 8 bytes "SDKTRACE" and a 32-bit format version, followed by
+ * records. Integers are little-endian. Every record starts with its TraceRecordType byte;
+ * records of search events then carry their path as a depth byte (path.size()), the number
+ * of leading entries shared with the path of the previous record, and one byte per
+ * remaining entry. The rest depends on the type:
+ *   - TRACE_BEGIN: the 96-byte board (12 words) the solve starts from.
+ *   - TRACE_ASSIGN: the cell (0..80), the board after the assignment and the 11-byte set of
+ *     assigned cells (bit i = cell i).
+ *   - TRACE_SIMPLIFY: the 32-bit pass index and eliminations, the 64-bit elimination sum,
+ *     the board after the pass and the assigned cells.
+ *   - TRACE_ELIMINATE: cause (signed), cell, value and house bytes, then the 16-bit candidate mask
+ *     of the cell after the event.
+ *   - TRACE_END: a solved byte, the 64-bit assignments, simplifications and microseconds,
+ *     and the final board.
+ * The path encoding keeps consecutive records of one node a few bytes long.
+ */
+
+/** Types of trace records. */
+enum TraceRecordType : uc {
+    TRACE_BEGIN = 1,
+    TRACE_ASSIGN,
+    TRACE_SIMPLIFY,
+    TRACE_ELIMINATE,
+    TRACE_END
+};
+
+/**
+ * @struct TraceRecord
+ * @brief One decoded trace record; only the fields of its type are meaningful.
+ */
+struct TraceRecord {
+    TraceRecordType type;         /**< Kind of record */
+    SearchPath path;              /**< Branch indices of the event (search events only) */
+    std::array<ulli, 12> board;   /**< Board snapshot (BEGIN, ASSIGN, SIMPLIFY, END) */
+    bool assigned[81];            /**< Assigned cells (ASSIGN, SIMPLIFY) */
+    uc cell;                      /**< Row-major cell (ASSIGN, ELIMINATE) */
+    SimplificationCause cause;    /**< Cause of the event (ELIMINATE) */
+    uc value;                     /**< Value eliminated or decided (ELIMINATE) */
+    uc by;                        /**< House responsible (ELIMINATE) */
+    us candidates;                /**< Candidates of the cell after the event (ELIMINATE) */
+    ui index;                     /**< Pass index (SIMPLIFY) */
+    ui eliminated;                /**< Eliminations of the pass (SIMPLIFY) */
+    ulli eliminatedSum;           /**< Eliminations so far (SIMPLIFY) */
+    bool solved;                  /**< Whether a solution was found (END) */
+    SolveStats stats;             /**< Assignments, simplifications and micros of the solve (END) */
+};
+
+/**
+ * @class TraceSink
+ * @brief Records trace events into a ring buffer that a background thread writes to a file.
+ *
+ * The solving thread only encodes each event into a few bytes of the ring and never waits
+ * on the file; the writer thread drains the ring in large chunks. If the disk falls so far
+ * behind that the ring fills up, the solving thread waits for space, so no event is lost.
+ * A TraceSink is fed by a single thread.
+ */
+class TraceSink {
+public:
+    /** Default bytes of the ring buffer. */
+    static const size_t RING_SIZE = 1 << 22;
+
+    /** Magic bytes starting a trace file. */
+    static constexpr char MAGIC[8] = { 'S', 'D', 'K', 'T', 'R', 'A', 'C', 'E' };
+
+    /** Format version written after the magic bytes. */
+    static const ui VERSION = 1;
+
+    /** Largest encoded record. */
+    static const size_t MAX_RECORD_SIZE = 256;
+
+private:
+    std::FILE* file;                          /**< Output file */
+    std::unique_ptr<unsigned char[]> ring;    /**< Ring buffer */
+    size_t ringMask;                          /**< Ring size minus one (a power of two) */
+    std::atomic<size_t> head;                 /**< Bytes produced so far */
+    std::atomic<size_t> tail;                 /**< Bytes written to the file so far */
+    std::atomic<bool> waitingForSpace;        /**< The producer waits for the writer */
+    std::atomic<bool> closing;                /**< close() was called */
+    std::atomic<bool> failed;                 /**< A write to the file failed */
+    std::mutex mutex;                         /**< Guards the waits */
+    std::condition_variable dataReady;        /**< Wakes the writer */
+    std::condition_variable spaceReady;       /**< Wakes the producer */
+    std::thread writer;                       /**< Background writer thread */
+    std::array<uc, SearchPath::CAPACITY> lastPath;  /**< Path of the previous search record */
+    size_t lastDepth;                         /**< Entries of lastPath */
+
+    /**
+     * @brief Body of the writer thread: write the ring to the file until closed.
+     */
+    void drain();
+
+    /**
+     * @brief Append an encoded record to the ring, waiting for space if it is full.
+     * @param bytes Record.
+     * @param size Bytes of the record, at most MAX_RECORD_SIZE.
+     */
+    void put(const unsigned char* bytes, size_t size);
+
+    /**
+     * @brief Encode a path relative to the path of the previous record.
+     * @param path Path of the record.
+     * @param out Receives the encoding.
+     * @return Bytes written.
+     */
+    size_t encodePath(const SearchPath& path, unsigned char* out);
+
+public:
+    /**
+     * @brief Create the trace file and start the writer thread.
+     * @param path File to write.
+     * @param ringSize Bytes of the ring buffer, rounded up to a power of two.
+     * @throws std::runtime_error if the file cannot be created.
+     */
+    explicit TraceSink(const char* path, size_t ringSize = RING_SIZE);
+
+    /**
+     * @brief Destructor; closes the sink, ignoring write errors.
+     */
+    ~TraceSink();
+
+    TraceSink(const TraceSink& other) = delete;
+    TraceSink& operator=(const TraceSink& other) = delete;
+
+    /**
+     * @brief Record the start of a solve.
+     * @param board Board the solve starts from.
+     */
+    void begin(const SudokuBoard& board);
+
+    /**
+     * @brief Record a tentative assignment.
+     * @param board Board right after the assignment.
+     * @param path Branch indices taken so far.
+     * @param assigned Cells currently assigned.
+     * @param justAssigned Cell that was assigned.
+     */
+    void assign(const SudokuBoard& board, const SearchPath& path, const bool assigned[81], const GPos& justAssigned);
+
+    /**
+     * @brief Record a simplification pass.
+     * @param board Board right after the pass.
+     * @param path Branch indices taken so far.
+     * @param index Index of the pass.
+     * @param eliminated Eliminations of the pass.
+     * @param eliminatedSum Eliminations so far.
+     * @param assigned Cells currently assigned.
+     */
+    void simplify(const SudokuBoard& board, const SearchPath& path, ui index, ui eliminated, ulli eliminatedSum, const bool assigned[81]);
+
+    /**
+     * @brief Record a single elimination, determination or contradiction.
+     * @param path Branch indices taken so far.
+     * @param cause Cause of the event.
+     * @param cell Cell of the event.
+     * @param value Value of the event.
+     * @param by House responsible.
+     * @param candidates Candidate mask of the cell right after the event.
+     */
+    void eliminate(const SearchPath& path, SimplificationCause cause, const GPos& cell, uc value, uc by, us candidates);
+
+    /**
+     * @brief Record the end of a solve.
+     * @param board Final board.
+     * @param solved Whether a solution was found.
+     * @param stats Counters of the solve (assignments, simplifications, micros).
+     */
+    void end(const SudokuBoard& board, bool solved, const SolveStats& stats);
+
+    /**
+     * @brief Write everything recorded, stop the writer thread and close the file.
+     *
+     * Further calls do nothing.
+     *
+     * @throws std::runtime_error if writing the file failed.
+     */
+    void close();
+};
+
+/**
+ * @class TraceReader
+ * @brief Reads the records of a trace file written by TraceSink.
+ */
+class TraceReader {
+private:
+    std::FILE* file;   /**< Input file */
+    bool ownsFile;     /**< Whether the file is closed by the destructor */
+    ulli offset;       /**< Bytes read so far, for error messages */
+
+    /**
+     * @brief Read bytes that must be present.
+     * @param out Receives the bytes.
+     * @param size Number of bytes.
+     * @throws std::runtime_error at the end of the file.
+     */
+    void read(void* out, size_t size);
+
+public:
+    /**
+     * @brief Open a trace file and check its header.
+     * @param path File to read, or nullptr for stdin.
+     * @throws std::runtime_error if the file cannot be opened or is not a trace of this version.
+     */
+    explicit TraceReader(const char* path);
+
+    /**
+     * @brief Destructor; closes the file unless it is stdin.
+     */
+    ~TraceReader();
+
+    TraceReader(const TraceReader& other) = delete;
+    TraceReader& operator=(const TraceReader& other) = delete;
+
+    /**
+     * @brief Read the next record.
+     * @param record Receives the record; its path is updated from the previous record's.
+     * @return true if a record was read, false at the end of the file.
+     * @throws std::runtime_error if the file is truncated or malformed.
+     */
+    bool next(TraceRecord& record);
+};
@@ -0,0 +1,20 @@
+#include "TranspositionTable.h"
+
+#include <bit>
+
+TranspositionTable::TranspositionTable(size_t capacity)
+    : slots(new Slot[std::bit_ceil(capacity < 1 ? (size_t)1 : capacity)]),
+      mask(std::bit_ceil(capacity < 1 ? (size_t)1 : capacity) - 1) {
+    clear();
+}
+
+size_t TranspositionTable::capacity() const {
+    return mask + 1;
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= mask; i++) {
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+
+/**
+ * @class TranspositionTable
+ * @brief Bounded lock-free table of search states whose subtree has been fully explored.
+ *
+ * Keys are the Zobrist hashes of board states entered by the search (see
+ * SudokuBoard::getHash()); the value is the number of solutions below the state, 0 for a
+ * state known to be a contradiction. The number of solutions of a candidate state does not
+ * depend on the puzzle it came from, the rules or the branching order, so one table may be
+ * shared by all searches and all threads of a run.
+ *
+ * Each key maps to a single slot; a store always replaces what the slot held. A slot holds
+ * the value and the key XORed with it in two relaxed atomics, so a slot half overwritten by
+ * another thread fails the key check and reads as a miss instead of a wrong value. Nothing
+ * is locked or allocated after construction.
+ */
+class TranspositionTable {
+private:
+    /**
+     * @struct Slot
+     * @brief One entry: value + 1 (0 for an empty slot), and the key XORed with it.
+     */
+    struct Slot {
+        std::atomic<unsigned long long> check;  /**< key ^ data */
+        std::atomic<unsigned long long> data;   /**< Solutions below the state, plus 1 */
+    };
+
+    std::unique_ptr<Slot[]> slots;  /**< All slots, zero-initialized */
+    size_t mask;                    /**< Slot count - 1 (the count is a power of two) */
+
+public:
+    /**
+     * @brief Constructor; allocates all slots.
+     * @param capacity Number of slots, rounded up to a power of two (at least 1).
+     */
+    explicit TranspositionTable(size_t capacity);
+
+    TranspositionTable(const TranspositionTable& other) = delete;
+    TranspositionTable& operator=(const TranspositionTable& other) = delete;
+
+    /**
+     * @brief Look a state up.
+     * @param key Hash of the state.
+     * @param solutions Receives the solutions below the state on a hit.
+     * @return true if the state is in the table.
+     */
+    bool probe(unsigned long long key, unsigned long long& solutions) const {
+        const Slot& slot = slots[key & mask];
+        unsigned long long data = slot.data.load(std::memory_order_relaxed);
+        unsigned long long check = slot.check.load(std::memory_order_relaxed);
+        if (data == 0 || (check ^ data) != key)
+            return false;
+        solutions = data - 1;
+        return true;
+    }
+
+    /**
+     * @brief Record that a state's subtree has been fully explored.
+     * @param key Hash of the state.
+     * @param solutions Number of solutions below the state.
+     */
+    void store(unsigned long long key, unsigned long long solutions) {
+        Slot& slot = slots[key & mask];
+        unsigned long long data = solutions + 1;
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Number of slots.
+     * @return Capacity after rounding.
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Empty every slot; not safe while searches use the table.
+     */
+    void clear();
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+ * @file
+ * @brief Program version shared by the solver, the benchmark and their outputs.
+ */
+
+#define PROGRAM_VERSION "SudokuSolver v1.1.4"
@@ -0,0 +1,151 @@
+#include "WorkStealingPool.h"
+
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <mutex>
+
+/** Pool whose worker is running on this thread, or nullptr for other threads. */
+static thread_local WorkStealingPool* currentPool = nullptr;
+/** Index of the worker running on this thread (valid when currentPool is set). */
+static thread_local ui currentWorker = 0;
+
+/** Initial capacity of a task ring. */
+static const size_t INITIAL_RING_SIZE = 64;
+
+WorkStealingPool::TaskRing::TaskRing() : slots(INITIAL_RING_SIZE), head(0), count(0) {}
+
+bool WorkStealingPool::TaskRing::empty() const {
+    return count == 0;
+}
+
+void WorkStealingPool::TaskRing::pushBack(Task&& task) {
+    if (count == slots.size()) {
+        // Full: unroll into twice the space
+        std::vector<Task> grown(slots.size() * 2);
+        for (size_t i = 0; i < count; i++)
+            grown[i] = std::move(slots[(head + i) & (slots.size() - 1)]);
+        slots.swap(grown);
+        head = 0;
+    }
+    slots[(head + count) & (slots.size() - 1)] = std::move(task);
+    count++;
+}
+
+WorkStealingPool::Task WorkStealingPool::TaskRing::popBack() {
+    count--;
+    return std::move(slots[(head + count) & (slots.size() - 1)]);
+}
+
+WorkStealingPool::Task WorkStealingPool::TaskRing::popFront() {
+    Task task = std::move(slots[head]);
+    head = (head + 1) & (slots.size() - 1);
+    count--;
+    return task;
+}
+
+WorkStealingPool::WorkStealingPool(ui threadCount)
+    : queued(0), pending(0), nextWorker(0), stopping(false) {
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (ui i = 0; i < threadCount; i++)
+        workers.push_back(std::make_unique<Worker>());
+    for (ui i = 0; i < threadCount; i++)
+        threads.emplace_back(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        stopping = true;
+    }
+    workCv.notify_all();
+    for (std::thread& t : threads)
+        t.join();
+}
+
+ui WorkStealingPool::getThreadCount() const {
+    return (ui)workers.size();
+}
+
+void WorkStealingPool::submit(Task task) {
+    ui target = currentPool == this
+        ? currentWorker
+        : nextWorker.fetch_add(1, std::memory_order_relaxed) % (ui)workers.size();
+
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        // Count it under idleMutex so a worker about to sleep cannot miss it.
+        // Counting before the push keeps queued from ever dropping below zero.
+        std::lock_guard<std::mutex> lock(idleMutex);
+        queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mutex);
+        workers[target]->tasks.pushBack(std::move(task));
+    }
+    workCv.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(idleMutex);
+    doneCv.wait(lock, [this] { return pending.load() == 0; });
+}
+
+bool WorkStealingPool::take(ui self, Task& task) {
+    // Own deque first, newest task
+    {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.popBack();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // Then steal the oldest task of the other workers, starting after ourselves
+    ui count = (ui)workers.size();
+    for (ui i = 1; i < count; i++) {
+        Worker& victim = *workers[(self + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.popFront();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(ui self) {
+    currentPool = this;
+    currentWorker = self;
+
+    Task task;
+    while (true) {
+        if (take(self, task)) {
+            task(self);
+            task = nullptr;
+            if (pending.fetch_sub(1) == 1) {
+                // Last outstanding task: wake up wait()
+                std::lock_guard<std::mutex> lock(idleMutex);
+                doneCv.notify_all();
+            }
+            continue;
+        }
+
+        // Nothing to run anywhere: sleep until something is queued
+        std::unique_lock<std::mutex> lock(idleMutex);
+        workCv.wait(lock, [this] { return stopping || queued.load() != 0; });
+        if (stopping && queued.load() == 0)
+            return;
+    }
+}
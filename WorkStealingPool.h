@@ -0,0 +1,125 @@
+#pragma once
+
+#include "SudokuBoard.h"
+
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+/**
+ * @class WorkStealingPool
+ * @brief Fixed-size thread pool with one task deque per worker and work stealing.
+ *
+ * A worker pops its own newest task first (LIFO, good locality for tasks it spawned
+ * itself) and, when its deque is empty, steals the oldest task of another worker (FIFO),
+ * so a worker stuck on a long task does not keep the queued work behind it waiting.
+ * Tasks may submit further tasks; those go to the submitting worker's own deque.
+ * The deques are ring buffers that only ever grow, so once they have held their peak
+ * number of tasks, queueing a task whose closure fits std::function's inline storage
+ * does not allocate.
+ */
+class WorkStealingPool {
+public:
+    /** Task type; receives the index (0..threadCount-1) of the worker running it. */
+    typedef std::function<void(ui worker)> Task;
+
+private:
+    /**
+     * @struct TaskRing
+     * @brief Double-ended queue of tasks in a power-of-two ring buffer that never shrinks.
+     */
+    struct TaskRing {
+        std::vector<Task> slots;  /**< Ring storage; its size is the capacity */
+        size_t head;              /**< Slot of the front task */
+        size_t count;             /**< Tasks queued */
+
+        TaskRing();
+        bool empty() const;
+        void pushBack(Task&& task);
+        Task popBack();
+        Task popFront();
+    };
+
+    /**
+     * @struct Worker
+     * @brief Per-thread deque, padded to its own cache line to avoid false sharing.
+     */
+    struct alignas(64) Worker {
+        std::mutex mutex;  /**< Guards tasks */
+        TaskRing tasks;    /**< Owner uses the back, thieves use the front */
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;  /**< One deque per thread */
+    std::vector<std::thread> threads;              /**< Worker threads */
+
+    std::mutex idleMutex;                /**< Guards sleeping and the two condition variables */
+    std::condition_variable workCv;      /**< Signalled when a task is queued or on shutdown */
+    std::condition_variable doneCv;      /**< Signalled when the pending count drops to 0 */
+    std::atomic<ulli> queued;            /**< Tasks sitting in some deque */
+    std::atomic<ulli> pending;           /**< Tasks submitted but not yet finished */
+    std::atomic<ui> nextWorker;          /**< Round-robin target for external submissions */
+    bool stopping;                       /**< Set by the destructor, guarded by idleMutex */
+
+    /**
+     * @brief Take a task from the worker's own deque, or steal one from another deque.
+     * @param self Index of the calling worker.
+     * @param task Receives the task.
+     * @return true if a task was obtained.
+     */
+    bool take(ui self, Task& task);
+
+    /**
+     * @brief Main loop of a worker thread.
+     * @param self Index of the worker.
+     */
+    void run(ui self);
+
+public:
+    /**
+     * @brief Start the worker threads.
+     * @param threadCount Number of workers; 0 uses std::thread::hardware_concurrency().
+     */
+    explicit WorkStealingPool(ui threadCount);
+
+    /**
+     * @brief Wait for all queued tasks, then stop and join the workers.
+     */
+    ~WorkStealingPool();
+
+    /**
+     * @brief Delete copy constructor; the pool owns its threads.
+     */
+    WorkStealingPool(const WorkStealingPool& other) = delete;
+
+    /**
+     * @brief Delete copy assignment operator; the pool owns its threads.
+     */
+    WorkStealingPool& operator=(const WorkStealingPool& other) = delete;
+
+    /**
+     * @brief Get the number of worker threads.
+     * @return Thread count (at least 1).
+     */
+    ui getThreadCount() const;
+
+    /**
+     * @brief Queue a task.
+     *
+     * Called from one of this pool's workers, the task goes to that worker's deque;
+     * otherwise deques are filled round-robin.
+     *
+     * @param task Task to run.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Block until every submitted task, including tasks submitted by tasks, has finished.
+     *
+     * Must not be called from a worker thread of this pool.
+     */
+    void wait();
+};